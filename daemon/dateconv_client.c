@@ -0,0 +1,157 @@
+/*
+              Client library of the dateconvd conversion daemon
+
+                 This library is in the public domain.
+*/
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "dateconv_client.h"
+
+int dcc_connect(const char *path)
+{
+    struct sockaddr_un addr;
+    int fd;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(strlen(path) >= sizeof(addr.sun_path))
+        return -1;
+    strcpy(addr.sun_path, path);
+
+    if((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+        return -1;
+    if(connect(fd, (struct sockaddr *)&addr, sizeof(addr)))
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+void dcc_close(int fd)
+{
+    close(fd);
+}
+
+// Transfer a whole scatter/gather list, resuming after short transfers
+
+static int transfer_all(int fd, struct iovec *iov, int iovcnt, int sending)
+{
+    ssize_t n;
+
+    for(;;)
+    {
+        while(iovcnt && !iov->iov_len)
+        {
+            iov++;
+            iovcnt--;
+        }
+        if(!iovcnt)
+            break;
+
+        n = sending ? writev(fd, iov, iovcnt) : readv(fd, iov, iovcnt);
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n <= 0)
+            return -1;
+
+        while(iovcnt && (size_t)n >= iov->iov_len)
+        {
+            n -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if(iovcnt)
+        {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+
+    return 0;
+}
+
+/* DCC_CALL  --  Send one request of columns in[] and receive its
+                 response into columns out[] and the validity bitmap,
+                 all without copying. */
+
+static int dcc_call(int fd, uint16_t op, dc_calendar_t from, dc_calendar_t to, uint32_t count,
+                    const int32_t *in[3], int32_t *out[3], uint8_t *validity)
+{
+    static uint32_t next_id;
+    dcp_request_t req;
+    dcp_response_t res;
+    struct iovec iov[5];
+    int in_cols = (op == DCP_OP_FROM_JDN) ? 1 : 3, out_cols = (op == DCP_OP_TO_JDN) ? 1 : 3, i;
+
+    if(count > DCP_MAX_ROWS)
+        return DCP_TOO_MANY_ROWS;
+
+    req.magic = DCP_MAGIC;
+    req.op = op;
+    req.from = (uint8_t)from;
+    req.to = (uint8_t)to;
+    req.id = __atomic_add_fetch(&next_id, 1, __ATOMIC_RELAXED);
+    req.count = count;
+
+    iov[0].iov_base = &req;
+    iov[0].iov_len = sizeof(req);
+    for(i = 0; i < in_cols; i++)
+    {
+        iov[i + 1].iov_base = (void *)in[i];
+        iov[i + 1].iov_len = count * sizeof(int32_t);
+    }
+    if(transfer_all(fd, iov, in_cols + 1, 1))
+        return -1;
+
+    iov[0].iov_base = &res;
+    iov[0].iov_len = sizeof(res);
+    if(transfer_all(fd, iov, 1, 0) || res.magic != DCP_MAGIC || res.id != req.id)
+        return -1;
+    if(res.status != DCP_OK)
+        return res.status;
+    if(res.count != count)
+        return -1;
+
+    for(i = 0; i < out_cols; i++)
+    {
+        iov[i].iov_base = out[i];
+        iov[i].iov_len = count * sizeof(int32_t);
+    }
+    iov[out_cols].iov_base = validity;
+    iov[out_cols].iov_len = (count + 31) / 32 * 4;
+
+    return transfer_all(fd, iov, out_cols + 1, 0);
+}
+
+int dcc_convert(int fd, dc_calendar_t from, dc_calendar_t to, uint32_t count,
+                const int32_t *year, const int32_t *month, const int32_t *day,
+                int32_t *out_year, int32_t *out_month, int32_t *out_day, uint8_t *validity)
+{
+    const int32_t *in[3] = {year, month, day};
+    int32_t *out[3] = {out_year, out_month, out_day};
+    return dcc_call(fd, DCP_OP_CONVERT, from, to, count, in, out, validity);
+}
+
+int dcc_to_jdn(int fd, dc_calendar_t from, uint32_t count,
+               const int32_t *year, const int32_t *month, const int32_t *day, int32_t *jdn, uint8_t *validity)
+{
+    const int32_t *in[3] = {year, month, day};
+    int32_t *out[3] = {jdn, NULL, NULL};
+    return dcc_call(fd, DCP_OP_TO_JDN, from, from, count, in, out, validity);
+}
+
+int dcc_from_jdn(int fd, dc_calendar_t to, uint32_t count,
+                 const int32_t *jdn, int32_t *year, int32_t *month, int32_t *day, uint8_t *validity)
+{
+    const int32_t *in[3] = {jdn, NULL, NULL};
+    int32_t *out[3] = {year, month, day};
+    return dcc_call(fd, DCP_OP_FROM_JDN, to, to, count, in, out, validity);
+}
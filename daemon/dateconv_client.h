@@ -0,0 +1,41 @@
+/*
+              Client library of the dateconvd conversion daemon
+
+   Blocking calls over one connection; a connection must not be used
+   by two threads at once.  Each call sends one request of up to
+   DCP_MAX_ROWS rows and returns 0, -1 on an I/O error, or the
+   DCP_* status the daemon answered with.  validity receives one bit
+   per row, least significant bit first, set for a converted row, and
+   must hold (count + 31) / 32 * 4 bytes.
+
+                 This library is in the public domain.
+*/
+
+#ifndef DATECONV_CLIENT_H
+#define DATECONV_CLIENT_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif  // __cplusplus
+
+#include <stdint.h>
+#include "date_converter.h"
+#include "dateconv_proto.h"
+
+int dcc_connect(const char *path);
+void dcc_close(int fd);
+
+int dcc_convert(int fd, dc_calendar_t from, dc_calendar_t to, uint32_t count,
+                const int32_t *year, const int32_t *month, const int32_t *day,
+                int32_t *out_year, int32_t *out_month, int32_t *out_day, uint8_t *validity);
+int dcc_to_jdn(int fd, dc_calendar_t from, uint32_t count,
+               const int32_t *year, const int32_t *month, const int32_t *day, int32_t *jdn, uint8_t *validity);
+int dcc_from_jdn(int fd, dc_calendar_t to, uint32_t count,
+                 const int32_t *jdn, int32_t *year, int32_t *month, int32_t *day, uint8_t *validity);
+
+#ifdef __cplusplus
+}
+#endif  // __cplusplus
+
+#endif  // DATECONV_CLIENT_H
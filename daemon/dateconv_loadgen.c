@@ -0,0 +1,152 @@
+/*
+              dateconv_loadgen  --  Load generator for dateconvd
+
+   Runs client threads that each send a number of batched requests
+   over their own connection and reports the request latency (p50,
+   p99, max) and the throughput.
+
+   Usage: dateconv_loadgen [-s socket_path] [-c clients] [-n requests]
+                           [-b batch_rows] [-f from_calendar] [-t to_calendar]
+
+                 This library is in the public domain.
+*/
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "dateconv_client.h"
+
+typedef struct Client
+{
+    pthread_t thread;
+    int index;
+    double *latency;  // Seconds per request
+    int failed;
+} client_t;
+
+static const char *path = DCP_DEFAULT_PATH;
+static int requests = 10000, batch = 256;
+static dc_calendar_t from = DC_GRE, to = DC_PER;
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void *run_client(void *arg)
+{
+    client_t *c = (client_t *)arg;
+    int32_t *in, *out;
+    uint8_t *validity;
+    unsigned seed = 12345u + c->index;
+    double t0;
+    int fd, i, r;
+
+    in = (int32_t *)malloc(3 * batch * sizeof(int32_t));
+    out = (int32_t *)malloc(3 * batch * sizeof(int32_t));
+    validity = (uint8_t *)malloc((batch + 31) / 32 * 4);
+
+    // Dates of the source calendar from one day per row of recent years
+    for(i = 0; i < batch; i++)
+        jd_to_ymd(2451544.5 + rand_r(&seed) % 18000, from, &in[i], &in[batch + i], &in[2 * batch + i]);
+
+    if((fd = dcc_connect(path)) < 0)
+    {
+        perror("dateconv_loadgen: connect");
+        c->failed = requests;
+        return NULL;
+    }
+
+    for(r = 0; r < requests; r++)
+    {
+        t0 = now();
+        if(dcc_convert(fd, from, to, batch, in, in + batch, in + 2 * batch, out, out + batch, out + 2 * batch, validity))
+        {
+            c->failed++;
+            break;
+        }
+        c->latency[r] = now() - t0;
+    }
+
+    dcc_close(fd);
+    free(in);
+    free(out);
+    free(validity);
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    client_t *clients;
+    double *all, start, elapsed;
+    int clients_n = 4, opt, i, total;
+
+    while((opt = getopt(argc, argv, "s:c:n:b:f:t:")) != -1)
+    {
+        switch(opt)
+        {
+            case 's': path = optarg; break;
+            case 'c': clients_n = atoi(optarg); break;
+            case 'n': requests = atoi(optarg); break;
+            case 'b': batch = atoi(optarg); break;
+            case 'f': from = (dc_calendar_t)atoi(optarg); break;
+            case 't': to = (dc_calendar_t)atoi(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-s socket_path] [-c clients] [-n requests] [-b batch_rows] "
+                                "[-f from_calendar] [-t to_calendar]\n", argv[0]);
+                return 2;
+        }
+    }
+    if(clients_n < 1 || requests < 1 || batch < 1 || batch > DCP_MAX_ROWS)
+    {
+        fprintf(stderr, "dateconv_loadgen: invalid arguments\n");
+        return 2;
+    }
+
+    clients = (client_t *)calloc(clients_n, sizeof(client_t));
+    all = (double *)malloc((size_t)clients_n * requests * sizeof(double));
+
+    start = now();
+    for(i = 0; i < clients_n; i++)
+    {
+        clients[i].index = i;
+        clients[i].latency = all + (size_t)i * requests;
+        pthread_create(&clients[i].thread, NULL, run_client, &clients[i]);
+    }
+    for(i = 0; i < clients_n; i++)
+        pthread_join(clients[i].thread, NULL);
+    elapsed = now() - start;
+
+    for(i = 0; i < clients_n; i++)
+    {
+        if(clients[i].failed)
+        {
+            fprintf(stderr, "dateconv_loadgen: client %d failed\n", i);
+            return 1;
+        }
+    }
+
+    total = clients_n * requests;
+    qsort(all, total, sizeof(double), cmp_double);
+    printf("clients %d, requests %d, rows per request %d\n", clients_n, total, batch);
+    printf("latency  p50 %.1f us  p99 %.1f us  max %.1f us\n",
+           all[total / 2] * 1e6, all[(int)(total * 0.99)] * 1e6, all[total - 1] * 1e6);
+    printf("throughput  %.0f requests/s  %.0f rows/s\n", total / elapsed, (double)total * batch / elapsed);
+
+    free(all);
+    free(clients);
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*
+              Wire protocol of the dateconvd conversion daemon
+
+   Every message is a fixed header followed by a payload of columns,
+   all in the host's byte order (the socket never leaves the machine).
+   A request carries count rows; its response carries the same number
+   of rows plus a validity bitmap with one bit per row, least
+   significant bit first, set where the row converted successfully.
+
+   Op                   Request payload          Response payload
+   DCP_OP_CONVERT       year, month, day         year, month, day, validity
+   DCP_OP_TO_JDN        year, month, day         jdn, validity
+   DCP_OP_FROM_JDN      jdn                      year, month, day, validity
+
+   Each column is count int32 values; the validity bitmap is padded
+   to a multiple of four bytes so that messages sent back to back stay
+   aligned.  Dates are read in calendar `from' and written in calendar
+   `to' (a dc_calendar_t); DCP_OP_TO_JDN ignores `to' and
+   DCP_OP_FROM_JDN ignores `from'.
+
+                 This library is in the public domain.
+*/
+
+#ifndef DATECONV_PROTO_H
+#define DATECONV_PROTO_H
+
+#include <stdint.h>
+
+#define DCP_MAGIC         0x31564344u  // "DCV1"
+#define DCP_MAX_ROWS      65536        // Rows in one request
+#define DCP_DEFAULT_PATH  "/tmp/dateconvd.sock"
+
+enum {DCP_OP_CONVERT = 1, DCP_OP_TO_JDN = 2, DCP_OP_FROM_JDN = 3};
+enum {DCP_OK = 0, DCP_BAD_MAGIC = 1, DCP_BAD_OP = 2, DCP_BAD_CALENDAR = 3, DCP_TOO_MANY_ROWS = 4};
+
+typedef struct DCP_Request
+{
+    uint32_t magic;
+    uint16_t op;
+    uint8_t from;
+    uint8_t to;
+    uint32_t id;      // Echoed in the response
+    uint32_t count;
+} dcp_request_t;
+
+typedef struct DCP_Response
+{
+    uint32_t magic;
+    uint16_t status;  // DCP_OK, or an error with no payload
+    uint16_t reserved;
+    uint32_t id;
+    uint32_t count;
+} dcp_response_t;
+
+// Payload sizes of a message of count rows
+
+static inline uint32_t dcp_request_payload(uint16_t op, uint32_t count)
+{
+    return ((op == DCP_OP_FROM_JDN) ? 1 : 3) * 4 * count;
+}
+
+static inline uint32_t dcp_response_payload(uint16_t op, uint32_t count)
+{
+    return ((op == DCP_OP_TO_JDN) ? 1 : 3) * 4 * count + (count + 31) / 32 * 4;
+}
+
+#endif  // DATECONV_PROTO_H
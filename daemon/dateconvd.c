@@ -0,0 +1,476 @@
+/*
+                  dateconvd  --  Date conversion daemon
+
+   Serves batched conversions over a Unix domain socket (see
+   dateconv_proto.h) so that services in any language share one set
+   of warm caches.  One thread runs an epoll loop that accepts
+   connections and hands every readable connection to a pool of worker
+   threads; a connection is armed with EPOLLONESHOT, so exactly one
+   worker owns it until it is re-armed.  Linux only.
+
+   Usage: dateconvd [-s socket_path] [-t worker_threads]
+
+                 This library is in the public domain.
+*/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "date_converter.h"
+#include "dateconv_proto.h"
+
+#define DCD_QUEUE_SIZE 1024   // Connections waiting for a worker
+#define DCD_MAX_EVENTS 64
+#define DCD_READ_SIZE 65536   // Growth of a connection's input buffer
+#define DCD_MAX_FRAME (sizeof(dcp_request_t) + 3 * 4 * DCP_MAX_ROWS)  // Largest valid request
+
+typedef struct DCD_Conn
+{
+    int fd;
+    char *in;             // Bytes received and not yet processed
+    size_t in_len;
+    size_t in_cap;        // At most DCD_MAX_FRAME
+} dcd_conn_t;
+
+// Scratch space of a worker, grown to the largest request seen
+
+typedef struct DCD_Scratch
+{
+    char *out;
+    size_t out_cap;
+    int32_t *days;
+    uint8_t *valid;
+    size_t rows;
+} dcd_scratch_t;
+
+static int epoll_fd;
+static volatile sig_atomic_t stopping;
+
+static dcd_conn_t *queue[DCD_QUEUE_SIZE];
+static int queue_head, queue_len;
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_ready = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t queue_space = PTHREAD_COND_INITIALIZER;
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    stopping = 1;
+}
+
+// Hand a connection to the workers; blocks while the queue is full
+
+static void queue_push(dcd_conn_t *conn)
+{
+    pthread_mutex_lock(&queue_lock);
+    while(queue_len == DCD_QUEUE_SIZE)
+        pthread_cond_wait(&queue_space, &queue_lock);
+    queue[(queue_head + queue_len++) % DCD_QUEUE_SIZE] = conn;
+    pthread_cond_signal(&queue_ready);
+    pthread_mutex_unlock(&queue_lock);
+}
+
+static dcd_conn_t *queue_pop(void)
+{
+    dcd_conn_t *conn;
+
+    pthread_mutex_lock(&queue_lock);
+    while(!queue_len)
+        pthread_cond_wait(&queue_ready, &queue_lock);
+    conn = queue[queue_head];
+    queue_head = (queue_head + 1) % DCD_QUEUE_SIZE;
+    queue_len--;
+    pthread_cond_signal(&queue_space);
+    pthread_mutex_unlock(&queue_lock);
+
+    return conn;
+}
+
+static void conn_close(dcd_conn_t *conn)
+{
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    free(conn->in);
+    free(conn);
+}
+
+static int conn_arm(dcd_conn_t *conn, int op)
+{
+    struct epoll_event ev;
+
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    ev.data.ptr = conn;
+    return epoll_ctl(epoll_fd, op, conn->fd, &ev);
+}
+
+// Write all of a buffer to a non-blocking socket, waiting while it is full
+
+static int write_all(int fd, const char *buf, size_t len)
+{
+    struct pollfd pfd;
+    ssize_t n;
+
+    while(len)
+    {
+        if((n = send(fd, buf, len, MSG_NOSIGNAL)) > 0)
+        {
+            buf += n;
+            len -= (size_t)n;
+            continue;
+        }
+        if(n < 0 && errno == EINTR)
+            continue;
+        if(n < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            return -1;
+
+        pfd.fd = fd;
+        pfd.events = POLLOUT;
+        if(poll(&pfd, 1, -1) < 0 && errno != EINTR)
+            return -1;
+    }
+
+    return 0;
+}
+
+static int scratch_reserve(dcd_scratch_t *s, size_t out_len, size_t rows)
+{
+    char *out;
+    int32_t *days;
+    uint8_t *valid;
+
+    if(out_len > s->out_cap)
+    {
+        if(!(out = (char *)realloc(s->out, out_len)))
+            return -1;
+        s->out = out;
+        s->out_cap = out_len;
+    }
+    if(rows > s->rows)
+    {
+        if(!(days = (int32_t *)realloc(s->days, rows * sizeof(int32_t))))
+            return -1;
+        s->days = days;
+        if(!(valid = (uint8_t *)realloc(s->valid, (rows + 31) / 32 * 4)))
+            return -1;
+        s->valid = valid;
+        s->rows = rows;
+    }
+
+    return 0;
+}
+
+/* SERVE_REQUEST  --  Convert one request into the scratch output
+                      buffer.  The columns of a request go through the
+                      library's batch kernels by way of date32 values,
+                      so no row is converted on its own; a calendar the
+                      kernels reject (Badi', which has no year layouts)
+                      gets DCP_BAD_CALENDAR.  Returns the length of the
+                      response, or 0 when memory runs out. */
+
+static size_t serve_request(const dcp_request_t *req, const char *payload, dcd_scratch_t *s)
+{
+    dcp_response_t res;
+    size_t rows = req->count, out_len = sizeof(res), i;
+    const int32_t *in = (const int32_t *)payload;
+    int32_t *out;
+    uint8_t *valid;
+    int64_t jdn, nulls;
+
+    res.magic = DCP_MAGIC;
+    res.status = DCP_OK;
+    res.reserved = 0;
+    res.id = req->id;
+    res.count = 0;
+
+    if(req->op != DCP_OP_CONVERT && req->op != DCP_OP_TO_JDN && req->op != DCP_OP_FROM_JDN)
+        res.status = DCP_BAD_OP;
+    else if((req->op != DCP_OP_FROM_JDN && check_date(1, 1, 1, (dc_calendar_t)req->from) == 1) ||
+            (req->op != DCP_OP_TO_JDN && check_date(1, 1, 1, (dc_calendar_t)req->to) == 1))
+        res.status = DCP_BAD_CALENDAR;  // Only the calendars the op reads
+    else
+    {
+        res.count = req->count;
+        out_len += dcp_response_payload(req->op, req->count);
+    }
+
+    if(scratch_reserve(s, out_len, rows))
+        return 0;
+    memcpy(s->out, &res, sizeof(res));
+    if(res.status != DCP_OK)
+        return out_len;
+
+    out = (int32_t *)(s->out + sizeof(res));
+    switch(req->op)
+    {
+        case DCP_OP_CONVERT:
+            valid = (uint8_t *)(out + 3 * rows);
+            nulls = dc_ymd_to_date32(in, in + rows, in + 2 * rows, NULL, 0, rows, (dc_calendar_t)req->from, s->days, s->valid);
+            if(nulls >= 0)
+                nulls = dc_date32_to_ymd(s->days, s->valid, 0, rows, (dc_calendar_t)req->to, out, out + rows, out + 2 * rows, valid);
+            break;
+        case DCP_OP_TO_JDN:
+            valid = (uint8_t *)(out + rows);
+            if((nulls = dc_ymd_to_date32(in, in + rows, in + 2 * rows, NULL, 0, rows, (dc_calendar_t)req->from, out, valid)) < 0)
+                break;
+            for(i = 0; i < rows; i++)
+                if((valid[i >> 3] >> (i & 7)) & 1)
+                    out[i] += 2440588;
+            break;
+        default:
+            valid = (uint8_t *)(out + 3 * rows);
+            for(i = 0; i < rows; i++)
+            {
+                jdn = (int64_t)in[i] - 2440588;
+                s->days[i] = (jdn < INT32_MIN) ? INT32_MIN : (int32_t)jdn;  // Far out of range either way
+            }
+            nulls = dc_date32_to_ymd(s->days, NULL, 0, rows, (dc_calendar_t)req->to, out, out + rows, out + 2 * rows, valid);
+            break;
+    }
+    if(nulls < 0)
+    {
+        // Nothing was written: answer with the header alone
+        res.status = DCP_BAD_CALENDAR;
+        res.count = 0;
+        memcpy(s->out, &res, sizeof(res));
+        return sizeof(res);
+    }
+    memset(valid + (rows + 7) / 8, 0, (rows + 31) / 32 * 4 - (rows + 7) / 8);
+
+    return out_len;
+}
+
+/* SERVE_FRAMES  --  Answer every complete request in a connection's
+                     input buffer and keep any partial request at
+                     its start.  Returns -1 once the connection is to
+                     be closed. */
+
+static int serve_frames(dcd_conn_t *conn, dcd_scratch_t *s)
+{
+    dcp_request_t req;
+    size_t used, need, len;
+
+    for(used = 0; conn->in_len - used >= sizeof(req); used += need)
+    {
+        memcpy(&req, conn->in + used, sizeof(req));
+        if(req.magic != DCP_MAGIC || req.count > DCP_MAX_ROWS)
+        {
+            dcp_response_t res = {DCP_MAGIC, (req.magic != DCP_MAGIC) ? DCP_BAD_MAGIC : DCP_TOO_MANY_ROWS, 0, req.id, 0};
+            write_all(conn->fd, (const char *)&res, sizeof(res));
+            return -1;  // The stream can't be resynchronized
+        }
+
+        need = sizeof(req) + dcp_request_payload(req.op, req.count);
+        if(conn->in_len - used < need)
+            break;
+        if(!(len = serve_request(&req, conn->in + used + sizeof(req), s)) || write_all(conn->fd, s->out, len))
+            return -1;
+    }
+
+    memmove(conn->in, conn->in + used, conn->in_len - used);
+    conn->in_len -= used;
+
+    return 0;
+}
+
+/* SERVE_CONN  --  Read what a connection has sent and answer every
+                   complete request in it, keeping any partial request
+                   for the next time.  The input buffer never grows
+                   past the largest valid request: once it is full,
+                   the requests in it are answered before reading
+                   more.  Returns -1 once the connection is to be
+                   closed. */
+
+static int serve_conn(dcd_conn_t *conn, dcd_scratch_t *s)
+{
+    size_t cap;
+    ssize_t n;
+    char *in;
+    int eof = 0;
+
+    for(;;)
+    {
+        if(conn->in_cap - conn->in_len < DCD_READ_SIZE && conn->in_cap < DCD_MAX_FRAME)
+        {
+            cap = (conn->in_cap + DCD_READ_SIZE < DCD_MAX_FRAME) ? conn->in_cap + DCD_READ_SIZE : DCD_MAX_FRAME;
+            if(!(in = (char *)realloc(conn->in, cap)))
+                return -1;
+            conn->in = in;
+            conn->in_cap = cap;
+        }
+        if((n = recv(conn->fd, conn->in + conn->in_len, conn->in_cap - conn->in_len, 0)) > 0)
+        {
+            conn->in_len += (size_t)n;
+            if(conn->in_len == conn->in_cap && serve_frames(conn, s))  // A full buffer holds a whole request
+                return -1;
+            continue;
+        }
+        if(n == 0)
+            eof = 1;
+        else if(errno == EINTR)
+            continue;
+        else if(errno != EAGAIN && errno != EWOULDBLOCK)
+            return -1;
+        break;
+    }
+
+    if(serve_frames(conn, s))
+        return -1;
+
+    return eof ? -1 : 0;
+}
+
+static void *worker(void *arg)
+{
+    dcd_scratch_t scratch = {NULL, 0, NULL, NULL, 0};
+    dcd_conn_t *conn;
+
+    (void)arg;
+    for(;;)
+    {
+        if(!(conn = queue_pop()))
+            break;  // Shutdown
+        if(serve_conn(conn, &scratch) || conn_arm(conn, EPOLL_CTL_MOD))
+            conn_close(conn);
+    }
+
+    free(scratch.out);
+    free(scratch.days);
+    free(scratch.valid);
+    return NULL;
+}
+
+/* Fill the equinox caches and calendar bounds once, before the first
+   request.  The calendars the date32 kernels reject (Badi') are never
+   served, so their -1 is ignored. */
+
+static void warm_caches(void)
+{
+    int32_t day = 20000, y, m, d;
+    int calendar, year;
+
+    for(year = DC_EQUINOX_CACHE_FIRST; year < DC_EQUINOX_CACHE_FIRST + DC_EQUINOX_CACHE_YEARS; year++)
+    {
+        persian_to_jd(year - 621, 1, 1);
+        afghan_to_jd(year - 621, 1, 1);
+    }
+    for(calendar = 0; calendar < DC_CALENDARS; calendar++)
+        dc_date32_to_ymd(&day, NULL, 0, 1, (dc_calendar_t)calendar, &y, &m, &d, NULL);
+}
+
+int main(int argc, char *argv[])
+{
+    struct epoll_event ev, events[DCD_MAX_EVENTS];
+    struct sockaddr_un addr;
+    struct sigaction sa;
+    const char *path = DCP_DEFAULT_PATH;
+    pthread_t *threads;
+    dcd_conn_t *conn;
+    int listen_fd, fd, threads_n, opt, i, n;
+
+    threads_n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    while((opt = getopt(argc, argv, "s:t:")) != -1)
+    {
+        switch(opt)
+        {
+            case 's': path = optarg; break;
+            case 't': threads_n = atoi(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-s socket_path] [-t worker_threads]\n", argv[0]);
+                return 2;
+        }
+    }
+    if(threads_n < 1)
+        threads_n = 1;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(strlen(path) >= sizeof(addr.sun_path))
+    {
+        fprintf(stderr, "dateconvd: socket path too long\n");
+        return 1;
+    }
+    strcpy(addr.sun_path, path);
+
+    if((listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) < 0)
+    {
+        perror("dateconvd: socket");
+        return 1;
+    }
+    unlink(path);
+    if(bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) || listen(listen_fd, SOMAXCONN))
+    {
+        perror("dateconvd: bind");
+        return 1;
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    warm_caches();
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL;  // The listening socket
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+
+    threads = (pthread_t *)malloc(threads_n * sizeof(pthread_t));
+    for(i = 0; i < threads_n; i++)
+        pthread_create(&threads[i], NULL, worker, NULL);
+
+    fprintf(stderr, "dateconvd: listening on %s with %d workers\n", path, threads_n);
+
+    while(!stopping)
+    {
+        if((n = epoll_wait(epoll_fd, events, DCD_MAX_EVENTS, -1)) < 0)
+        {
+            if(errno == EINTR)
+                continue;
+            perror("dateconvd: epoll_wait");
+            break;
+        }
+
+        for(i = 0; i < n; i++)
+        {
+            if(events[i].data.ptr)
+            {
+                queue_push((dcd_conn_t *)events[i].data.ptr);
+                continue;
+            }
+
+            while((fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+            {
+                if(!(conn = (dcd_conn_t *)calloc(1, sizeof(dcd_conn_t))))
+                {
+                    close(fd);
+                    continue;
+                }
+                conn->fd = fd;
+                if(conn_arm(conn, EPOLL_CTL_ADD))
+                    conn_close(conn);
+            }
+        }
+    }
+
+    // Wake every worker with an empty connection to let it exit
+    for(i = 0; i < threads_n; i++)
+        queue_push(NULL);
+    for(i = 0; i < threads_n; i++)
+        pthread_join(threads[i], NULL);
+
+    close(listen_fd);
+    unlink(path);
+    free(threads);
+    return 0;
+}
@@ -13,9 +13,30 @@
                  This library is in the public domain.
 */
 
+/* DC_EMBEDDED selects the embedded profile (make embedded): only the
+   arithmetic calendars, on integer day numbers, and the astronomical
+   Persian calendar from the table of years generated by
+   tools/persian_table.c.  It needs neither libm nor malloc(); the
+   astronomy, the other calendars and the batch, index and Arrow APIs
+   are left out. */
+
 #include <stdlib.h>  // malloc(), NULL
 #include <string.h>  // strlen(), NULL
 #include <math.h>
+#include <time.h>    // time()
+#include <limits.h>  // INT_MAX, INT_MIN
+
+#ifdef DC_EMBEDDED
+#include "date_converter_persian_table.h"
+
+// Spells the bounds of the Persian table out in the error message of code 11
+#define DC_STR_(x) #x
+#define DC_STR(x) DC_STR_(x)
+#endif
+
+// The fast paths of date_converter_inline.h are defined here with external linkage
+#define DC_FAST
+#include "date_converter_inline.h"
 
 // ****************************************************************************************** //
 // /////////////////////////////////    COMMON FUNCTIONS    ///////////////////////////////// //
@@ -25,7 +46,215 @@ void str_copy_unsafe(char *dest, const char *src)
     while((*dest++ = *src++));
 }
 
+/* Relaxed atomic access for lazily filled caches.  Every fill stores
+   a value that is a pure function of its key, so a racing reader sees
+   either 0 (not yet computed) or the final value, never a torn one. */
+
+#define DC_LOAD_RELAXED(p)      __atomic_load_n((p), __ATOMIC_RELAXED)
+#define DC_STORE_RELAXED(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+
+// Integer division and remainder rounding toward minus infinity (b > 0), as floor() and mod() do
+
+static inline int floor_div(int a, int b)
+{
+    return (a >= 0) ? a / b : -((b - 1 - a) / b);
+}
+
+static inline int floor_mod(int a, int b)
+{
+    return a - b * floor_div(a, b);
+}
+
+static inline int ceil_div(int a, int b)
+{
+    return -floor_div(-a, b);
+}
+
+/* Dates and Julian days within which the integer day-number paths of
+   the arithmetic calendars are exact and cannot overflow; anything
+   else takes the original double path. */
+
+#define DC_JDN_YMD_OK(year, month, day)  ((unsigned)(year) + 500000u <= 1000000u && \
+                                          (unsigned)(month) + 1000u <= 2000u && \
+                                          (unsigned)(day) + 1000000u <= 2000000u)
+#define DC_JDN_JD_OK(jd)  ((jd) > -2e8 && (jd) < 2e8)
+
+// JD_FLOOR: floor() of a Julian day within DC_JDN_JD_OK(), without libm
+
+static inline int jd_floor(double jd)
+{
+    int i = (int)jd;
+    return i - (jd < i);
+}
+
+// JD_TO_JDN: Julian day number of a Julian day into *jdn; 0 outside DC_JDN_JD_OK()
+
+static inline int jd_to_jdn(double jd, int *jdn)
+{
+    if(!DC_JDN_JD_OK(jd))
+        return 0;
+
+    *jdn = jd_floor(jd) + 1;
+    return 1;
+}
+
+#ifndef DC_EMBEDDED
+
+/* Vectorized kernels.  The body of a hot loop is written once as a
+   DC_KERNEL function and DC_ISA_VARIANTS() compiles it for every
+   instruction set level, named <body>_sse2, _avx2 and _avx512; the
+   caller goes through the table of the level chosen at run time
+   (see ISA DISPATCH).  Contraction into FMA is turned off so that
+   every level gives bit-identical results. */
+
+#if defined(__GNUC__) && !defined(__clang__) && (defined(__x86_64__) || defined(__i386__)) && !defined(DC_NO_ISA_DISPATCH)
+#define DC_ISA_DISPATCH 1
+#else
+#define DC_ISA_DISPATCH 0
+#endif
+
+#define DC_KERNEL static inline __attribute__((always_inline))
+
+#if DC_ISA_DISPATCH
+#define DC_TARGET_AVX2    __attribute__((target("avx2"), optimize("fp-contract=off")))
+#define DC_TARGET_AVX512  __attribute__((target("avx512f,avx512vl,avx512bw,avx512dq,prefer-vector-width=512"), \
+                                         optimize("fp-contract=off")))
+
+#define DC_ISA_VARIANTS(body, params, args)                   \
+    static void body##_sse2 params { body args; }             \
+    DC_TARGET_AVX2 static void body##_avx2 params { body args; } \
+    DC_TARGET_AVX512 static void body##_avx512 params { body args; }
+#else
+#define DC_ISA_VARIANTS(body, params, args)                   \
+    static void body##_sse2 params { body args; }
+#endif
+
+// Rules of a calendar for the first pass of dc_check_date_n(), read from its dc_calendar_ops_t
+typedef struct
+{
+    int max_months;
+    int no_year_zero;
+    int fixed_days[32];  // Length of month m in every year, 0 if it varies (or m is out of range)
+} check_rules_t;
+
+// Kernels of one instruction set level
+typedef struct
+{
+    void (*nutation_terms_reduced)(const double ta[5], float to10, float *dp, float *de);
+    void (*equinox_terms_reduced)(double T, float *S);
+    void (*check_date_pass1)(const int *year, const int *month, const int *day, size_t n,
+                             const check_rules_t *rules, int *error_code, int *last_day_of_month, size_t *pending);
+    void (*date32_to_gregorian)(const int32_t *values, int n, int first, int last, int32_t *year, int32_t *month, int32_t *day);
+    void (*date32_from_gregorian)(const int32_t *year, const int32_t *month, const int32_t *day, int n,
+                                  int32_t *values, unsigned char *valid);
+    void (*bucket_block)(const int *start, int count, const int32_t *jdn, int n, int32_t *id);
+} isa_kernels_t;
+
+static const isa_kernels_t *isa_kernels(void);
+
+// Date of a Julian day from the month-boundary index, 0 outside its window (see MONTH INDEX)
+static int month_index_ymd(dc_calendar_t calendar_type, double jd, int *year, int *month, int *day);
+static void month_index_drop(dc_calendar_t calendar_type);
+
+// Forget the Naw-Ruz days of the Badi' calendar (see BADI' CALENDAR)
+static void badi_table_drop(void);
+
+/* Shared cache of expensive per-year results (the equinox days of the
+   Tehran and Kabul calendars outside their contexts' windows, the
+   Hebrew new years, the Badi' Naw-Ruz days outside its table), keyed
+   by calendar and year.  An entry is one 64-bit word packing the
+   calendar, the year and the result, so it is published and read with
+   a single atomic access: readers never wait and never see a torn
+   entry.  A result is a pure function of its key,
+   so racing fills store the same word.  A key probes a fixed set of
+   DC_YEAR_CACHE_WAYS slots; a fill that finds them all taken
+   overwrites one, and a lookup that misses recomputes. */
+
+#ifndef DC_YEAR_CACHE_BITS
+#define DC_YEAR_CACHE_BITS 12  // log2 of the number of entries, 8 bytes each
+#endif
+#define DC_YEAR_CACHE_WAYS 4   // Slots probed per key, a power of 2
+
+#define YEAR_CACHE_TAG  0xffffffff00000000ULL  // Calendar + 1 in the top 4 bits, year + 2^27 in the next 28
+
+static uint64_t year_cache[1 << DC_YEAR_CACHE_BITS];
+
+// Tag of a key, 0 for a year the cache does not keep (beyond 2^22 years a day number may not fit the entry)
+
+static inline uint64_t year_cache_tag(dc_calendar_t calendar_type, int year)
+{
+    if((unsigned)year + (1u << 22) >= (1u << 23))
+        return 0;
+    return ((uint64_t)(calendar_type + 1) << 60) | ((uint64_t)((unsigned)year + (1u << 27)) << 32);
+}
+
+static inline uint64_t *year_cache_set(uint64_t tag)
+{
+    return &year_cache[((tag * 0x9e3779b97f4a7c15ULL) >> (64 - DC_YEAR_CACHE_BITS)) & ~(uint64_t)(DC_YEAR_CACHE_WAYS - 1)];
+}
+
+static int year_cache_get(dc_calendar_t calendar_type, int year, int *value)
+{
+    uint64_t tag = year_cache_tag(calendar_type, year), entry, *set;
+    int i;
+
+    if(!tag)
+        return 0;
+
+    set = year_cache_set(tag);
+    for(i = 0; i < DC_YEAR_CACHE_WAYS; i++)
+    {
+        entry = DC_LOAD_RELAXED(&set[i]);
+        if((entry & YEAR_CACHE_TAG) == tag)
+        {
+            *value = (int)(uint32_t)entry;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void year_cache_put(dc_calendar_t calendar_type, int year, int value)
+{
+    uint64_t tag = year_cache_tag(calendar_type, year), entry, *set;
+    int i, victim;
+
+    if(!tag)
+        return;
+
+    // The first free slot, else the key's own slot, else one picked by the year
+    set = year_cache_set(tag);
+    victim = year & (DC_YEAR_CACHE_WAYS - 1);
+    for(i = 0; i < DC_YEAR_CACHE_WAYS; i++)
+    {
+        entry = DC_LOAD_RELAXED(&set[i]);
+        if(!entry || (entry & YEAR_CACHE_TAG) == tag)
+        {
+            victim = i;
+            break;
+        }
+    }
+
+    DC_STORE_RELAXED(&set[victim], tag | (uint32_t)value);
+}
+
+// Drop the entries of a calendar whose results have changed (a new ephemeris)
+
+static void year_cache_drop(dc_calendar_t calendar_type)
+{
+    uint64_t kind = (uint64_t)(calendar_type + 1) << 60;
+    int i;
+
+    for(i = 0; i < (1 << DC_YEAR_CACHE_BITS); i++)
+        if((DC_LOAD_RELAXED(&year_cache[i]) >> 60 << 60) == kind)
+            DC_STORE_RELAXED(&year_cache[i], 0);
+}
+
+#endif  // DC_EMBEDDED
+
 // /////////////////////////////////    COMMON FUNCTIONS    ///////////////////////////////// //
+#ifndef DC_EMBEDDED
 // ****************************************************************************************** //
 // /////////////////////////////////         ASTRO          ///////////////////////////////// //
 
@@ -66,20 +295,255 @@ double fixangr(double a)
     return a - (2 * MATH_PI) * (floor(a / (2 * MATH_PI)));
 }
 
+/* Trigonometry of the astronomical functions.  The astronomical
+   calendars must not depend on the platform's libm: sin(), cos(),
+   atan2() and asin() may differ in the last place between versions and
+   architectures, and in rare years that moves an equinox across a day
+   boundary.  These use only IEEE arithmetic and sqrt(), which round
+   the same everywhere (the library is built with -ffp-contract=off, so
+   no multiply-add is fused).  An angle in degrees is reduced exactly
+   to within 45 degrees of a multiple of 90; one in radians, to within
+   pi/4 of a multiple of pi/2 with pi/2 split in three parts (Cody and
+   Waite).  The fdlibm minimax polynomials of the sine, cosine and
+   arctangent then come within two ulps of the exact results, faster
+   than libm's general-purpose code.  Define DC_USE_LIBM_TRIG to use
+   libm instead. */
+
+#ifndef DC_USE_LIBM_TRIG
+
+// fdlibm __kernel_sin() and __kernel_cos(): minimax polynomials of the sine and cosine on [-pi/4, pi/4]
+
+static inline double sin_kernel(double x)
+{
+    static const double S1 = -1.66666666666666324348e-01, S2 = 8.33333333332248946124e-03,
+                        S3 = -1.98412698298579493134e-04, S4 = 2.75573137070700676789e-06,
+                        S5 = -2.50507602534068634195e-08, S6 = 1.58969099521155010221e-10;
+    double z = x * x;
+
+    return x + ((z * x) * (S1 + (z * (S2 + (z * (S3 + (z * (S4 + (z * (S5 + (z * S6)))))))))));
+}
+
+static inline double cos_kernel(double x)
+{
+    static const double C1 = 4.16666666666666019037e-02, C2 = -1.38888888888741095749e-03,
+                        C3 = 2.48015872894767294178e-05, C4 = -2.75573143513906633035e-07,
+                        C5 = 2.08757232129817482790e-09, C6 = -1.13596475577881948265e-11;
+    double z = x * x, hz = 0.5 * z, w = 1.0 - hz;
+
+    return w + (((1.0 - w) - hz) + ((z * z) * (C1 + (z * (C2 + (z * (C3 + (z * (C4 + (z * (C5 + (z * C6))))))))))));
+}
+
+/* Nearest quarter turn n of an angle in degrees (|d| < 2^62), and the
+   remainder x in radians.  d - 90n is exact: both are multiples of the
+   ulp of d, and the difference is at most 45. */
+
+static inline long long dquadrant(double d, double *x)
+{
+    long long n = (long long)((d / 90.0) + ((d < 0) ? -0.5 : 0.5));
+
+    *x = dtr(d - (90.0 * n));
+    return n;
+}
+
+/* The same for an angle in radians, within an ulp for |r| < 2^20 pi/2:
+   pi/2 is split as fdlibm's pio2_1, pio2_2 and pio2_2t, the first two
+   of 33 bits, so that their products by n are exact. */
+
+static inline long long rquadrant(double r, double *x)
+{
+    static const double PIO2_1 = 1.57079632673412561417e+00, PIO2_2 = 6.07710050630396597660e-11,
+                        PIO2_2T = 2.02226624879595063154e-21, INVPIO2 = 6.36619772367581382433e-01;
+    long long n = (long long)((r * INVPIO2) + ((r < 0) ? -0.5 : 0.5));
+
+    *x = ((r - (PIO2_1 * n)) - (PIO2_2 * n)) - (PIO2_2T * n);
+    return n;
+}
+
+// Sine and cosine of x plus n quarter turns
+
+static inline double quadrant_sin(double x, long long n)
+{
+    double v = (n & 1) ? cos_kernel(x) : sin_kernel(x);
+    return (n & 2) ? -v : v;
+}
+
+static inline double quadrant_cos(double x, long long n)
+{
+    double v = (n & 1) ? sin_kernel(x) : cos_kernel(x);
+    return ((n + 1) & 2) ? -v : v;
+}
+
 // DSIN: Sine of an angle in degrees
 
 double dsin(double d)
 {
-    return sin(dtr(d));
+    double x;
+    long long n = dquadrant(d, &x);
+
+    return quadrant_sin(x, n);
 }
 
 // DCOS: Cosine of an angle in degrees
 
+double dcos(double d)
+{
+    double x;
+    long long n = dquadrant(d, &x);
+
+    return quadrant_cos(x, n);
+}
+
+// RSIN, RCOS, RSINCOS: Sine and cosine of an angle in radians
+
+static inline double rsin(double r)
+{
+    double x;
+    long long n = rquadrant(r, &x);
+
+    return quadrant_sin(x, n);
+}
+
+static inline double rcos(double r)
+{
+    double x;
+    long long n = rquadrant(r, &x);
+
+    return quadrant_cos(x, n);
+}
+
+static inline void rsincos(double r, double *s, double *c)
+{
+    double x;
+    long long n = rquadrant(r, &x);
+
+    *s = quadrant_sin(x, n);
+    *c = quadrant_cos(x, n);
+}
+
+// ATAN_POSITIVE: Arctangent of x >= 0, as fdlibm atan()
+
+static double atan_positive(double x)
+{
+    static const double atanhi[] = {4.63647609000806093515e-01, 7.85398163397448278999e-01,
+                                    9.82793723247329054082e-01, 1.57079632679489655800e+00};
+    static const double atanlo[] = {2.26987774529616870924e-17, 3.06161699786838301793e-17,
+                                    1.39033110312309984516e-17, 6.12323399573676603587e-17};
+    static const double aT[] = {3.33333333333329318027e-01, -1.99999999998764832476e-01, 1.42857142725034663711e-01,
+                                -1.11111104054623557880e-01, 9.09088713343650656196e-02, -7.69187620504482999495e-02,
+                                6.66107313738753120669e-02, -5.83357013379057348645e-02, 4.97687799461593236017e-02,
+                                -3.65315727442169155270e-02, 1.62858201153657823623e-02};
+    double z, w, s1, s2;
+    int id;
+
+    // Reduce to |x| < 7/16 about atan(0), atan(1/2), atan(1), atan(3/2) or atan(infinity)
+    if(x < 0.4375)
+    {
+        id = -1;
+    }
+    else if(x < 0.6875)
+    {
+        id = 0;
+        x = ((2.0 * x) - 1.0) / (2.0 + x);
+    }
+    else if(x < 1.1875)
+    {
+        id = 1;
+        x = (x - 1.0) / (x + 1.0);
+    }
+    else if(x < 2.4375)
+    {
+        id = 2;
+        x = (x - 1.5) / (1.0 + (1.5 * x));
+    }
+    else
+    {
+        id = 3;
+        x = -1.0 / x;
+    }
+
+    z = x * x;
+    w = z * z;
+    s1 = z * (aT[0] + (w * (aT[2] + (w * (aT[4] + (w * (aT[6] + (w * (aT[8] + (w * aT[10]))))))))));
+    s2 = w * (aT[1] + (w * (aT[3] + (w * (aT[5] + (w * (aT[7] + (w * aT[9]))))))));
+
+    if(id < 0)
+        return x - (x * (s1 + s2));
+    return atanhi[id] - (((x * (s1 + s2)) - atanlo[id]) - x);
+}
+
+// RATAN2: Angle in radians of the point (x, y), in [-pi, pi]
+
+static double ratan2(double y, double x)
+{
+    static const double PI_LO = 1.2246467991473531772e-16;  // pi - MATH_PI
+    double a;
+
+    if(x == 0)
+        return (y > 0) ? (MATH_PI / 2) : ((y < 0) ? -(MATH_PI / 2) : 0);
+
+    a = atan_positive(fabs(y / x));
+    if(x < 0)
+        a = MATH_PI - (a - PI_LO);
+    return (y < 0) ? -a : a;
+}
+
+// RASIN, RACOS: Arcsine and arccosine in radians, through the arctangent
+
+static inline double rasin(double x)
+{
+    return ratan2(x, sqrt((1.0 - x) * (1.0 + x)));
+}
+
+static inline double racos(double x)
+{
+    return ratan2(sqrt((1.0 - x) * (1.0 + x)), x);
+}
+
+#else
+
+double dsin(double d)
+{
+    return sin(dtr(d));
+}
+
 double dcos(double d)
 {
     return cos(dtr(d));
 }
 
+static inline double rsin(double r)
+{
+    return sin(r);
+}
+
+static inline double rcos(double r)
+{
+    return cos(r);
+}
+
+static inline void rsincos(double r, double *s, double *c)
+{
+    *s = sin(r);
+    *c = cos(r);
+}
+
+static inline double ratan2(double y, double x)
+{
+    return atan2(y, x);
+}
+
+static inline double rasin(double x)
+{
+    return asin(x);
+}
+
+static inline double racos(double x)
+{
+    return acos(x);
+}
+
+#endif  // DC_USE_LIBM_TRIG
+
 // MOD: Modulus function which works for non-integers
 
 double mod(double a, double b)
@@ -138,6 +602,142 @@ double obliqeq(double jd)
     return eps;
 }
 
+/* Periodic terms for nutation in longiude (delta \Psi) and
+   obliquity (delta \Epsilon) as given in table 21.A of
+   Meeus, "Astronomical Algorithms", first edition. */
+
+static const int nutArgMult[] = {
+     0,  0,  0,  0,  1,
+    -2,  0,  0,  2,  2,
+     0,  0,  0,  2,  2,
+     0,  0,  0,  0,  2,
+     0,  1,  0,  0,  0,
+     0,  0,  1,  0,  0,
+    -2,  1,  0,  2,  2,
+     0,  0,  0,  2,  1,
+     0,  0,  1,  2,  2,
+    -2, -1,  0,  2,  2,
+    -2,  0,  1,  0,  0,
+    -2,  0,  0,  2,  1,
+     0,  0, -1,  2,  2,
+     2,  0,  0,  0,  0,
+     0,  0,  1,  0,  1,
+     2,  0, -1,  2,  2,
+     0,  0, -1,  0,  1,
+     0,  0,  1,  2,  1,
+    -2,  0,  2,  0,  0,
+     0,  0, -2,  2,  1,
+     2,  0,  0,  2,  2,
+     0,  0,  2,  2,  2,
+     0,  0,  2,  0,  0,
+    -2,  0,  1,  2,  2,
+     0,  0,  0,  2,  0,
+    -2,  0,  0,  2,  0,
+     0,  0, -1,  2,  1,
+     0,  2,  0,  0,  0,
+     2,  0, -1,  0,  1,
+    -2,  2,  0,  2,  2,
+     0,  1,  0,  0,  1,
+    -2,  0,  1,  0,  1,
+     0, -1,  0,  0,  1,
+     0,  0,  2, -2,  0,
+     2,  0, -1,  2,  1,
+     2,  0,  1,  2,  2,
+     0,  1,  0,  2,  2,
+    -2,  1,  1,  0,  0,
+     0, -1,  0,  2,  2,
+     2,  0,  0,  2,  1,
+     2,  0,  1,  0,  0,
+    -2,  0,  2,  2,  2,
+    -2,  0,  1,  2,  1,
+     2,  0, -2,  0,  1,
+     2,  0,  0,  0,  1,
+     0, -1,  1,  0,  0,
+    -2, -1,  0,  2,  1,
+    -2,  0,  0,  0,  1,
+     0,  0,  2,  2,  1,
+    -2,  0,  2,  0,  1,
+    -2,  1,  0,  2,  1,
+     0,  0,  1, -2,  0,
+    -1,  0,  1,  0,  0,
+    -2,  1,  0,  0,  0,
+     1,  0,  0,  0,  0,
+     0,  0,  1,  2,  0,
+    -1, -1,  1,  0,  0,
+     0,  1,  1,  0,  0,
+     0, -1,  1,  2,  2,
+     2, -1, -1,  2,  2,
+     0,  0, -2,  2,  2,
+     0,  0,  3,  2,  2,
+     2, -1,  0,  2,  2
+};
+
+static const int nutArgCoeff[] = {
+    -171996,   -1742,   92095,      89,          /*  0,  0,  0,  0,  1 */
+     -13187,     -16,    5736,     -31,          /* -2,  0,  0,  2,  2 */
+      -2274,      -2,     977,      -5,          /*  0,  0,  0,  2,  2 */
+       2062,       2,    -895,       5,          /*  0,  0,  0,  0,  2 */
+       1426,     -34,      54,      -1,          /*  0,  1,  0,  0,  0 */
+        712,       1,      -7,       0,          /*  0,  0,  1,  0,  0 */
+       -517,      12,     224,      -6,          /* -2,  1,  0,  2,  2 */
+       -386,      -4,     200,       0,          /*  0,  0,  0,  2,  1 */
+       -301,       0,     129,      -1,          /*  0,  0,  1,  2,  2 */
+        217,      -5,     -95,       3,          /* -2, -1,  0,  2,  2 */
+       -158,       0,       0,       0,          /* -2,  0,  1,  0,  0 */
+        129,       1,     -70,       0,          /* -2,  0,  0,  2,  1 */
+        123,       0,     -53,       0,          /*  0,  0, -1,  2,  2 */
+         63,       0,       0,       0,          /*  2,  0,  0,  0,  0 */
+         63,       1,     -33,       0,          /*  0,  0,  1,  0,  1 */
+        -59,       0,      26,       0,          /*  2,  0, -1,  2,  2 */
+        -58,      -1,      32,       0,          /*  0,  0, -1,  0,  1 */
+        -51,       0,      27,       0,          /*  0,  0,  1,  2,  1 */
+         48,       0,       0,       0,          /* -2,  0,  2,  0,  0 */
+         46,       0,     -24,       0,          /*  0,  0, -2,  2,  1 */
+        -38,       0,      16,       0,          /*  2,  0,  0,  2,  2 */
+        -31,       0,      13,       0,          /*  0,  0,  2,  2,  2 */
+         29,       0,       0,       0,          /*  0,  0,  2,  0,  0 */
+         29,       0,     -12,       0,          /* -2,  0,  1,  2,  2 */
+         26,       0,       0,       0,          /*  0,  0,  0,  2,  0 */
+        -22,       0,       0,       0,          /* -2,  0,  0,  2,  0 */
+         21,       0,     -10,       0,          /*  0,  0, -1,  2,  1 */
+         17,      -1,       0,       0,          /*  0,  2,  0,  0,  0 */
+         16,       0,      -8,       0,          /*  2,  0, -1,  0,  1 */
+        -16,       1,       7,       0,          /* -2,  2,  0,  2,  2 */
+        -15,       0,       9,       0,          /*  0,  1,  0,  0,  1 */
+        -13,       0,       7,       0,          /* -2,  0,  1,  0,  1 */
+        -12,       0,       6,       0,          /*  0, -1,  0,  0,  1 */
+         11,       0,       0,       0,          /*  0,  0,  2, -2,  0 */
+        -10,       0,       5,       0,          /*  2,  0, -1,  2,  1 */
+         -8,       0,       3,       0,          /*  2,  0,  1,  2,  2 */
+          7,       0,      -3,       0,          /*  0,  1,  0,  2,  2 */
+         -7,       0,       0,       0,          /* -2,  1,  1,  0,  0 */
+         -7,       0,       3,       0,          /*  0, -1,  0,  2,  2 */
+         -7,       0,       3,       0,          /*  2,  0,  0,  2,  1 */
+          6,       0,       0,       0,          /*  2,  0,  1,  0,  0 */
+          6,       0,      -3,       0,          /* -2,  0,  2,  2,  2 */
+          6,       0,      -3,       0,          /* -2,  0,  1,  2,  1 */
+         -6,       0,       3,       0,          /*  2,  0, -2,  0,  1 */
+         -6,       0,       3,       0,          /*  2,  0,  0,  0,  1 */
+          5,       0,       0,       0,          /*  0, -1,  1,  0,  0 */
+         -5,       0,       3,       0,          /* -2, -1,  0,  2,  1 */
+         -5,       0,       3,       0,          /* -2,  0,  0,  0,  1 */
+         -5,       0,       3,       0,          /*  0,  0,  2,  2,  1 */
+          4,       0,       0,       0,          /* -2,  0,  2,  0,  1 */
+          4,       0,       0,       0,          /* -2,  1,  0,  2,  1 */
+          4,       0,       0,       0,          /*  0,  0,  1, -2,  0 */
+         -4,       0,       0,       0,          /* -1,  0,  1,  0,  0 */
+         -4,       0,       0,       0,          /* -2,  1,  0,  0,  0 */
+         -4,       0,       0,       0,          /*  1,  0,  0,  0,  0 */
+          3,       0,       0,       0,          /*  0,  0,  1,  2,  0 */
+         -3,       0,       0,       0,          /* -1, -1,  1,  0,  0 */
+         -3,       0,       0,       0,          /*  0,  1,  1,  0,  0 */
+         -3,       0,       0,       0,          /*  0, -1,  1,  2,  2 */
+         -3,       0,       0,       0,          /*  2, -1, -1,  2,  2 */
+         -3,       0,       0,       0,          /*  0,  0, -2,  2,  2 */
+         -3,       0,       0,       0,          /*  0,  0,  3,  2,  2 */
+         -3,       0,       0,       0           /*  2, -1,  0,  2,  2 */
+};
+
 /* NUTATION  --  Calculate the nutation in longitude, deltaPsi, and
                  obliquity, deltaEpsilon for a given Julian date
                  jd.  Results are returned as a two element Array
@@ -145,143 +745,7 @@ double obliqeq(double jd)
 
 double *nutation(double jd, double result[])
 {
-    /* Periodic terms for nutation in longiude (delta \Psi) and
-       obliquity (delta \Epsilon) as given in table 21.A of
-       Meeus, "Astronomical Algorithms", first edition. */
-
-    static const int nutArgMult[] = {
-         0,  0,  0,  0,  1,
-        -2,  0,  0,  2,  2,
-         0,  0,  0,  2,  2,
-         0,  0,  0,  0,  2,
-         0,  1,  0,  0,  0,
-         0,  0,  1,  0,  0,
-        -2,  1,  0,  2,  2,
-         0,  0,  0,  2,  1,
-         0,  0,  1,  2,  2,
-        -2, -1,  0,  2,  2,
-        -2,  0,  1,  0,  0,
-        -2,  0,  0,  2,  1,
-         0,  0, -1,  2,  2,
-         2,  0,  0,  0,  0,
-         0,  0,  1,  0,  1,
-         2,  0, -1,  2,  2,
-         0,  0, -1,  0,  1,
-         0,  0,  1,  2,  1,
-        -2,  0,  2,  0,  0,
-         0,  0, -2,  2,  1,
-         2,  0,  0,  2,  2,
-         0,  0,  2,  2,  2,
-         0,  0,  2,  0,  0,
-        -2,  0,  1,  2,  2,
-         0,  0,  0,  2,  0,
-        -2,  0,  0,  2,  0,
-         0,  0, -1,  2,  1,
-         0,  2,  0,  0,  0,
-         2,  0, -1,  0,  1,
-        -2,  2,  0,  2,  2,
-         0,  1,  0,  0,  1,
-        -2,  0,  1,  0,  1,
-         0, -1,  0,  0,  1,
-         0,  0,  2, -2,  0,
-         2,  0, -1,  2,  1,
-         2,  0,  1,  2,  2,
-         0,  1,  0,  2,  2,
-        -2,  1,  1,  0,  0,
-         0, -1,  0,  2,  2,
-         2,  0,  0,  2,  1,
-         2,  0,  1,  0,  0,
-        -2,  0,  2,  2,  2,
-        -2,  0,  1,  2,  1,
-         2,  0, -2,  0,  1,
-         2,  0,  0,  0,  1,
-         0, -1,  1,  0,  0,
-        -2, -1,  0,  2,  1,
-        -2,  0,  0,  0,  1,
-         0,  0,  2,  2,  1,
-        -2,  0,  2,  0,  1,
-        -2,  1,  0,  2,  1,
-         0,  0,  1, -2,  0,
-        -1,  0,  1,  0,  0,
-        -2,  1,  0,  0,  0,
-         1,  0,  0,  0,  0,
-         0,  0,  1,  2,  0,
-        -1, -1,  1,  0,  0,
-         0,  1,  1,  0,  0,
-         0, -1,  1,  2,  2,
-         2, -1, -1,  2,  2,
-         0,  0, -2,  2,  2,
-         0,  0,  3,  2,  2,
-         2, -1,  0,  2,  2
-    };
-
-    static const int nutArgCoeff[] = {
-        -171996,   -1742,   92095,      89,          /*  0,  0,  0,  0,  1 */
-         -13187,     -16,    5736,     -31,          /* -2,  0,  0,  2,  2 */
-          -2274,      -2,     977,      -5,          /*  0,  0,  0,  2,  2 */
-           2062,       2,    -895,       5,          /*  0,  0,  0,  0,  2 */
-           1426,     -34,      54,      -1,          /*  0,  1,  0,  0,  0 */
-            712,       1,      -7,       0,          /*  0,  0,  1,  0,  0 */
-           -517,      12,     224,      -6,          /* -2,  1,  0,  2,  2 */
-           -386,      -4,     200,       0,          /*  0,  0,  0,  2,  1 */
-           -301,       0,     129,      -1,          /*  0,  0,  1,  2,  2 */
-            217,      -5,     -95,       3,          /* -2, -1,  0,  2,  2 */
-           -158,       0,       0,       0,          /* -2,  0,  1,  0,  0 */
-            129,       1,     -70,       0,          /* -2,  0,  0,  2,  1 */
-            123,       0,     -53,       0,          /*  0,  0, -1,  2,  2 */
-             63,       0,       0,       0,          /*  2,  0,  0,  0,  0 */
-             63,       1,     -33,       0,          /*  0,  0,  1,  0,  1 */
-            -59,       0,      26,       0,          /*  2,  0, -1,  2,  2 */
-            -58,      -1,      32,       0,          /*  0,  0, -1,  0,  1 */
-            -51,       0,      27,       0,          /*  0,  0,  1,  2,  1 */
-             48,       0,       0,       0,          /* -2,  0,  2,  0,  0 */
-             46,       0,     -24,       0,          /*  0,  0, -2,  2,  1 */
-            -38,       0,      16,       0,          /*  2,  0,  0,  2,  2 */
-            -31,       0,      13,       0,          /*  0,  0,  2,  2,  2 */
-             29,       0,       0,       0,          /*  0,  0,  2,  0,  0 */
-             29,       0,     -12,       0,          /* -2,  0,  1,  2,  2 */
-             26,       0,       0,       0,          /*  0,  0,  0,  2,  0 */
-            -22,       0,       0,       0,          /* -2,  0,  0,  2,  0 */
-             21,       0,     -10,       0,          /*  0,  0, -1,  2,  1 */
-             17,      -1,       0,       0,          /*  0,  2,  0,  0,  0 */
-             16,       0,      -8,       0,          /*  2,  0, -1,  0,  1 */
-            -16,       1,       7,       0,          /* -2,  2,  0,  2,  2 */
-            -15,       0,       9,       0,          /*  0,  1,  0,  0,  1 */
-            -13,       0,       7,       0,          /* -2,  0,  1,  0,  1 */
-            -12,       0,       6,       0,          /*  0, -1,  0,  0,  1 */
-             11,       0,       0,       0,          /*  0,  0,  2, -2,  0 */
-            -10,       0,       5,       0,          /*  2,  0, -1,  2,  1 */
-             -8,       0,       3,       0,          /*  2,  0,  1,  2,  2 */
-              7,       0,      -3,       0,          /*  0,  1,  0,  2,  2 */
-             -7,       0,       0,       0,          /* -2,  1,  1,  0,  0 */
-             -7,       0,       3,       0,          /*  0, -1,  0,  2,  2 */
-             -7,       0,       3,       0,          /*  2,  0,  0,  2,  1 */
-              6,       0,       0,       0,          /*  2,  0,  1,  0,  0 */
-              6,       0,      -3,       0,          /* -2,  0,  2,  2,  2 */
-              6,       0,      -3,       0,          /* -2,  0,  1,  2,  1 */
-             -6,       0,       3,       0,          /*  2,  0, -2,  0,  1 */
-             -6,       0,       3,       0,          /*  2,  0,  0,  0,  1 */
-              5,       0,       0,       0,          /*  0, -1,  1,  0,  0 */
-             -5,       0,       3,       0,          /* -2, -1,  0,  2,  1 */
-             -5,       0,       3,       0,          /* -2,  0,  0,  0,  1 */
-             -5,       0,       3,       0,          /*  0,  0,  2,  2,  1 */
-              4,       0,       0,       0,          /* -2,  0,  2,  0,  1 */
-              4,       0,       0,       0,          /* -2,  1,  0,  2,  1 */
-              4,       0,       0,       0,          /*  0,  0,  1, -2,  0 */
-             -4,       0,       0,       0,          /* -1,  0,  1,  0,  0 */
-             -4,       0,       0,       0,          /* -2,  1,  0,  0,  0 */
-             -4,       0,       0,       0,          /*  1,  0,  0,  0,  0 */
-              3,       0,       0,       0,          /*  0,  0,  1,  2,  0 */
-             -3,       0,       0,       0,          /* -1, -1,  1,  0,  0 */
-             -3,       0,       0,       0,          /*  0,  1,  1,  0,  0 */
-             -3,       0,       0,       0,          /*  0, -1,  1,  2,  2 */
-             -3,       0,       0,       0,          /*  2, -1, -1,  2,  2 */
-             -3,       0,       0,       0,          /*  0,  0, -2,  2,  2 */
-             -3,       0,       0,       0,          /*  0,  0,  3,  2,  2 */
-             -3,       0,       0,       0           /*  2, -1,  0,  2,  2 */
-    };
-
-    double deltaPsi, deltaEpsilon, t = (jd - 2451545.0) / 36525.0, t2, t3, to10, dp = 0, de = 0, ang;
+    double deltaPsi, deltaEpsilon, t = (jd - 2451545.0) / 36525.0, t2, t3, to10, dp = 0, de = 0, ang, sa, ca;
     double ta[5];
     int i, j;
 
@@ -314,8 +778,9 @@ double *nutation(double jd, double result[])
             if(nutArgMult[(i * 5) + j] != 0)
                 ang += nutArgMult[(i * 5) + j] * ta[j];
         }
-        dp += (nutArgCoeff[(i * 4) + 0] + nutArgCoeff[(i * 4) + 1] * to10) * sin(ang);
-        de += (nutArgCoeff[(i * 4) + 2] + nutArgCoeff[(i * 4) + 3] * to10) * cos(ang);
+        rsincos(ang, &sa, &ca);
+        dp += (nutArgCoeff[(i * 4) + 0] + nutArgCoeff[(i * 4) + 1] * to10) * sa;
+        de += (nutArgCoeff[(i * 4) + 2] + nutArgCoeff[(i * 4) + 3] * to10) * ca;
     }
 
     /* Return the result, converting from ten thousandths of arc
@@ -382,47 +847,41 @@ double deltat(int year)
     return dt;
 }
 
-/* EQUINOX  --  Determine the Julian Ephemeris Day of an
-                equinox or solstice.  The "which" argument
-                selects the item to be computed:
-
-                    0   March equinox
-                    1   June solstice
-                    2   September equinox
-                    3   December solstice
-*/
-
-double equinox(int year, int which)
+// Periodic terms to obtain true time of an equinox or solstice
+
+static const double EquinoxpTerms[] = {
+    485, 324.96,   1934.136,
+    203, 337.23,  32964.467,
+    199, 342.08,     20.186,
+    182,  27.85, 445267.112,
+    156,  73.14,  45036.886,
+    136, 171.52,  22518.443,
+     77, 222.54,  65928.934,
+     74, 296.72,   3034.906,
+     70, 243.58,   9037.513,
+     58, 119.81,  33718.147,
+     52, 297.17,    150.678,
+     50,  21.02,   2281.226,
+     45, 247.54,  29929.562,
+     44, 325.15,  31555.956,
+     29,  60.93,   4443.417,
+     18, 155.12,  67555.328,
+     17, 288.79,   4562.452,
+     16, 198.04,  62894.029,
+     14, 199.76,  31436.921,
+     12,  95.39,  14577.848,
+     12, 287.11,  31931.756,
+     12, 320.81,  34777.259,
+      9, 227.73,   1222.114,
+      8,  15.45,  16859.074
+};
+
+/* EQUINOX_MEAN  --  Determine the Julian Ephemeris Day of the
+                     mean equinox or solstice selected by "which"
+                     as for equinox() below. */
+
+double equinox_mean(int year, int which)
 {
-    // Periodic terms to obtain true time
-
-    static const double EquinoxpTerms[] = {
-        485, 324.96,   1934.136,
-        203, 337.23,  32964.467,
-        199, 342.08,     20.186,
-        182,  27.85, 445267.112,
-        156,  73.14,  45036.886,
-        136, 171.52,  22518.443,
-         77, 222.54,  65928.934,
-         74, 296.72,   3034.906,
-         70, 243.58,   9037.513,
-         58, 119.81,  33718.147,
-         52, 297.17,    150.678,
-         50,  21.02,   2281.226,
-         45, 247.54,  29929.562,
-         44, 325.15,  31555.956,
-         29,  60.93,   4443.417,
-         18, 155.12,  67555.328,
-         17, 288.79,   4562.452,
-         16, 198.04,  62894.029,
-         14, 199.76,  31436.921,
-         12,  95.39,  14577.848,
-         12, 287.11,  31931.756,
-         12, 320.81,  34777.259,
-          9, 227.73,   1222.114,
-          8,  15.45,  16859.074
-    };
-
     static const double JDE0tab1000[4][5] = {
         {1721139.29189, 365242.13740,  0.06134,  0.00111, -0.00071},
         {1721233.25401, 365241.72562, -0.05323,  0.00907,  0.00025},
@@ -437,9 +896,8 @@ double equinox(int year, int which)
         {2451900.05952, 365242.74049, -0.06223, -0.00823,  0.00032}
     };
 
-    double deltaL, JDE0, JDE, S, T, W, Y;
+    double Y;
     const double (*JDE0tab)[5];
-    int i, j;
 
     /* Initialise terms for mean equinox and solstices. We
        have two sets: one for years prior to 1000 and a second
@@ -456,11 +914,29 @@ double equinox(int year, int which)
         Y = (year - 2000) / (double)1000;
     }
 
-    JDE0 =  JDE0tab[which][0] +
+    return  JDE0tab[which][0] +
            (JDE0tab[which][1] * Y) +
            (JDE0tab[which][2] * Y * Y) +
            (JDE0tab[which][3] * Y * Y * Y) +
            (JDE0tab[which][4] * Y * Y * Y * Y);
+}
+
+/* EQUINOX  --  Determine the Julian Ephemeris Day of an
+                equinox or solstice.  The "which" argument
+                selects the item to be computed:
+
+                    0   March equinox
+                    1   June solstice
+                    2   September equinox
+                    3   December solstice
+*/
+
+double equinox(int year, int which)
+{
+    double deltaL, JDE0, JDE, S, T, W;
+    int i, j;
+
+    JDE0 = equinox_mean(year, which);
 
     T = (JDE0 - 2451545.0) / 36525;
     W = (35999.373 * T) - 2.47;
@@ -480,6 +956,315 @@ double equinox(int year, int which)
     return JDE;
 }
 
+/* Terms of the VSOP87 theory of the Earth, truncated as in Meeus,
+   Astronomical Algorithms, Appendix III: amplitude (1e-8 radians or
+   AU), phase (radians) and frequency (radians per Julian millennium).
+   L and R are the heliocentric longitude and radius vector; the
+   latitude, which does not move the equinoxes, is left out. */
+
+static const double VSOP87_L0[] = {
+    175347046, 0,              0,
+      3341656, 4.6692568,   6283.0758500,
+        34894, 4.62610,    12566.15170,
+         3497, 2.7441,      5753.3849,
+         3418, 2.8289,         3.5231,
+         3136, 3.6277,     77713.7715,
+         2676, 4.4181,      7860.4194,
+         2343, 6.1352,      3930.2097,
+         1324, 0.7425,     11506.7698,
+         1273, 2.0371,       529.6910,
+         1199, 1.1096,      1577.3435,
+          990, 5.233,       5884.927,
+          902, 2.045,         26.298,
+          857, 3.508,        398.149,
+          780, 1.179,       5223.694,
+          753, 2.533,       5507.553,
+          505, 4.583,      18849.228,
+          492, 4.205,        775.523,
+          357, 2.920,          0.067,
+          317, 5.849,      11790.629,
+          284, 1.899,        796.298,
+          271, 0.315,      10977.079,
+          243, 0.345,       5486.778,
+          206, 4.806,       2544.314,
+          205, 1.869,       5573.143,
+          202, 2.458,       6069.777,
+          156, 0.833,        213.299,
+          132, 3.411,       2942.463,
+          126, 1.083,         20.775,
+          115, 0.645,          0.980,
+          103, 0.636,       4694.003,
+          102, 0.976,      15720.839,
+          102, 4.267,          7.114,
+           99, 6.21,        2146.17,
+           98, 0.68,         155.42,
+           86, 5.98,      161000.69,
+           85, 1.30,        6275.96,
+           85, 3.67,       71430.70,
+           80, 1.81,       17260.15,
+           79, 3.04,       12036.46,
+           75, 1.76,        5088.63,
+           74, 3.50,        3154.69,
+           74, 4.68,         801.82,
+           70, 0.83,        9437.76,
+           62, 3.98,        8827.39,
+           61, 1.82,        7084.90,
+           57, 2.78,        6286.60,
+           56, 4.39,       14143.50,
+           56, 3.47,        6279.55,
+           52, 0.19,       12139.55,
+           52, 1.33,        1748.02,
+           51, 0.28,        5856.48,
+           49, 0.49,        1194.45,
+           41, 5.37,        8429.24,
+           41, 2.40,       19651.05,
+           39, 6.17,       10447.39,
+           37, 6.04,       10213.29,
+           37, 2.57,        1059.38,
+           36, 1.71,        2352.87,
+           36, 1.78,        6812.77,
+           33, 0.59,       17789.85,
+           30, 0.44,       83996.85,
+           30, 2.74,        1349.87,
+           25, 3.16,        4690.48
+};
+
+static const double VSOP87_L1[] = {
+    628331966747, 0,            0,
+          206059, 2.678235,  6283.07585,
+            4303, 2.6351,   12566.1517,
+             425, 1.590,        3.523,
+             119, 5.796,       26.298,
+             109, 2.966,     1577.344,
+              93, 2.59,     18849.23,
+              72, 1.14,       529.69,
+              68, 1.87,       398.15,
+              67, 4.41,      5507.55,
+              59, 2.89,      5223.69,
+              56, 2.17,       155.42,
+              45, 0.40,       796.30,
+              36, 0.47,       775.52,
+              29, 2.65,         7.11,
+              21, 5.34,         0.98,
+              19, 1.85,      5486.78,
+              19, 4.97,       213.30,
+              17, 2.99,      6275.96,
+              16, 0.03,      2544.31,
+              16, 1.43,      2146.17,
+              15, 1.21,     10977.08,
+              12, 2.83,      1748.02,
+              12, 3.26,      5088.63,
+              12, 5.27,      1194.45,
+              12, 2.08,      4694.00,
+              11, 0.77,       553.57,
+              10, 1.30,      6286.60,
+              10, 4.24,      1349.87,
+               9, 2.70,       242.73,
+               9, 5.64,       951.72,
+               8, 5.30,      2352.87,
+               6, 2.65,      9437.76,
+               6, 4.67,      4690.48
+};
+
+static const double VSOP87_L2[] = {
+    52919, 0,          0,
+     8720, 1.0721,  6283.0758,
+      309, 0.867,  12566.152,
+       27, 0.05,       3.52,
+       16, 5.19,      26.30,
+       16, 3.68,     155.42,
+       10, 0.76,   18849.23,
+        9, 2.06,   77713.77,
+        7, 0.83,     775.52,
+        5, 4.66,    1577.34,
+        4, 1.03,       7.11,
+        4, 3.44,    5573.14,
+        3, 5.14,     796.30,
+        3, 6.05,    5507.55,
+        3, 1.19,     242.73,
+        3, 6.12,     529.69,
+        3, 0.31,     398.15,
+        3, 2.28,     553.57,
+        2, 4.38,    5223.69,
+        2, 3.75,       0.98
+};
+
+static const double VSOP87_L3[] = {
+    289, 5.844,  6283.076,
+     35, 0,         0,
+     17, 5.49,  12566.15,
+      3, 5.20,    155.42,
+      1, 4.72,      3.52,
+      1, 5.30,  18849.23,
+      1, 5.97,    242.73
+};
+
+static const double VSOP87_L4[] = {
+    114, 3.142,     0,
+      8, 4.13,   6283.08,
+      1, 3.84,  12566.15
+};
+
+static const double VSOP87_L5[] = {
+    1, 3.14, 0
+};
+
+static const double VSOP87_R0[] = {
+    100013989, 0,              0,
+      1670700, 3.0984635,   6283.0758500,
+        13956, 3.05525,    12566.15170,
+         3084, 5.1985,     77713.7715,
+         1628, 1.1739,      5753.3849,
+         1576, 2.8469,      7860.4194,
+          925, 5.453,      11506.770,
+          542, 4.564,       3930.210,
+          472, 3.661,       5884.927,
+          346, 0.964,       5507.553,
+          329, 5.900,       5223.694,
+          307, 0.299,       5573.143,
+          243, 4.273,      11790.629,
+          212, 5.847,       1577.344,
+          186, 5.022,      10977.079,
+          175, 3.012,      18849.228,
+          110, 5.055,       5486.778,
+           98, 0.89,        6069.78,
+           86, 5.69,       15720.84,
+           86, 1.27,      161000.69,
+           65, 0.27,       17260.15,
+           63, 0.92,         529.69,
+           57, 2.01,       83996.85,
+           56, 5.24,       71430.70,
+           49, 3.25,        2544.31,
+           47, 2.58,         775.52,
+           45, 5.54,        9437.76,
+           43, 6.01,        6275.96,
+           39, 5.36,        4694.00,
+           38, 2.39,        8827.39,
+           37, 0.83,       19651.05,
+           37, 4.90,       12139.55,
+           36, 1.67,       12036.46,
+           35, 1.84,        2942.46,
+           33, 0.24,        7084.90,
+           32, 0.18,        5088.63,
+           32, 1.78,         398.15,
+           28, 1.21,        6286.60,
+           28, 1.90,        6279.55,
+           26, 4.59,       10447.39
+};
+
+static const double VSOP87_R1[] = {
+    103019, 1.107490,  6283.075850,
+      1721, 1.0644,   12566.1517,
+       702, 3.142,        0,
+        32, 1.02,     18849.23,
+        31, 2.84,      5507.55,
+        25, 1.32,      5223.69,
+        18, 1.42,      1577.34,
+        10, 5.91,     10977.08,
+         9, 1.42,      6275.96,
+         9, 0.27,      5486.78
+};
+
+static const double VSOP87_R2[] = {
+    4359, 5.7846,  6283.0758,
+     124, 5.579,  12566.152,
+      12, 3.14,       0,
+       9, 3.63,   77713.77,
+       6, 1.87,    5573.14,
+       3, 5.47,   18849.23
+};
+
+static const double VSOP87_R3[] = {
+    145, 4.273,  6283.076,
+      7, 3.92,  12566.15
+};
+
+static const double VSOP87_R4[] = {
+    4, 2.56, 6283.08
+};
+
+// VSOP87_SERIES: Sum the terms of one power of time of a VSOP87 series
+
+static double vsop87_series(const double *terms, int n, double tau)
+{
+    double s;
+    int i, j;
+
+    s = 0;
+    for(i = 0, j = 0; i < n; i++)
+    {
+        s += terms[j] * rcos(terms[j + 1] + (terms[j + 2] * tau));
+        j += 3;
+    }
+
+    return s;
+}
+
+#define VSOP87_TERMS(t) ((int)(sizeof(t) / sizeof(t[0]) / 3))
+
+/* SUN_APPARENT_LONGITUDE  --  Apparent geocentric longitude of the Sun,
+                              in degrees, at a Julian Ephemeris Day,
+                              from the truncated VSOP87 Earth series
+                              with the FK5 correction, nutation in
+                              longitude and aberration (Meeus, chapter
+                              25, higher accuracy). */
+
+double sun_apparent_longitude(double jde)
+{
+    double tau, L, R, theta;
+    double nut[2];
+
+    tau = (jde - J2000) / JulianMillennium;
+
+    L = vsop87_series(VSOP87_L0, VSOP87_TERMS(VSOP87_L0), tau) +
+        tau * (vsop87_series(VSOP87_L1, VSOP87_TERMS(VSOP87_L1), tau) +
+        tau * (vsop87_series(VSOP87_L2, VSOP87_TERMS(VSOP87_L2), tau) +
+        tau * (vsop87_series(VSOP87_L3, VSOP87_TERMS(VSOP87_L3), tau) +
+        tau * (vsop87_series(VSOP87_L4, VSOP87_TERMS(VSOP87_L4), tau) +
+        tau * vsop87_series(VSOP87_L5, VSOP87_TERMS(VSOP87_L5), tau)))));
+
+    R = vsop87_series(VSOP87_R0, VSOP87_TERMS(VSOP87_R0), tau) +
+        tau * (vsop87_series(VSOP87_R1, VSOP87_TERMS(VSOP87_R1), tau) +
+        tau * (vsop87_series(VSOP87_R2, VSOP87_TERMS(VSOP87_R2), tau) +
+        tau * (vsop87_series(VSOP87_R3, VSOP87_TERMS(VSOP87_R3), tau) +
+        tau * vsop87_series(VSOP87_R4, VSOP87_TERMS(VSOP87_R4), tau))));
+
+    // Geocentric longitude of the Sun, reduced to the FK5 system
+
+    theta = rtd(L * 1e-8) + 180 + (-0.09033 / 3600);
+
+    // Nutation in longitude and aberration give the apparent longitude
+
+    theta += nutation(jde, nut)[0] + (-20.4898 / (3600 * (R * 1e-8)));
+
+    return fixangle(theta);
+}
+
+/* EQUINOX_VSOP87  --  Julian Ephemeris Day of an equinox or solstice,
+                       selected by "which" as for equinox(), solved
+                       for the apparent solar longitude of 90 * which
+                       degrees from the truncated VSOP87 series.
+                       Starting from equinox(), each step corrects
+                       the time by the longitude still to go (Meeus,
+                       chapter 27); three steps reach a millisecond. */
+
+double equinox_vsop87(int year, int which)
+{
+    double JDE, step;
+    int i;
+
+    JDE = equinox(year, which);
+    for(i = 0; i < 8; i++)
+    {
+        step = 58 * dsin((which * 90) - sun_apparent_longitude(JDE));
+        JDE += step;
+        if(fabs(step) < 1e-8)
+            break;
+    }
+
+    return JDE;
+}
+
 /* SUNPOS  --  Position of the Sun.  Please see the comments
                on the return statement at the end of this function
                which describe the array it returns.  We return
@@ -507,12 +1292,12 @@ double *sunpos(double jd, double result[])
     Lambda = sunLong + (-0.00569) + (-0.00478 * dsin(Omega));
     epsilon0 = obliqeq(jd);
     epsilon = epsilon0 + (0.00256 * dcos(Omega));
-    Alpha = rtd(atan2(dcos(epsilon0) * dsin(sunLong), dcos(sunLong)));
+    Alpha = rtd(ratan2(dcos(epsilon0) * dsin(sunLong), dcos(sunLong)));
     Alpha = fixangle(Alpha);
-    Delta = rtd(asin(dsin(epsilon0) * dsin(sunLong)));
-    AlphaApp = rtd(atan2(dcos(epsilon) * dsin(Lambda), dcos(Lambda)));
+    Delta = rtd(rasin(dsin(epsilon0) * dsin(sunLong)));
+    AlphaApp = rtd(ratan2(dcos(epsilon) * dsin(Lambda), dcos(Lambda)));
     AlphaApp = fixangle(AlphaApp);
-    DeltaApp = rtd(asin(dsin(epsilon) * dsin(Lambda)));
+    DeltaApp = rtd(rasin(dsin(epsilon) * dsin(Lambda)));
 
     result[0]  = L0;          //  [0] Geometric mean longitude of the Sun
     result[1]  = M;           //  [1] Mean anomaly of the Sun
@@ -558,1250 +1343,5601 @@ double equationOfTime(double jd)
     return E;
 }
 
-// /////////////////////////////////         ASTRO          ///////////////////////////////// //
-// ****************************************************************************************** //
-// /////////////////////////////////   GREGORIAN CALENDAR   ///////////////////////////////// //
+/* DC_SUNPOS_BATCH  --  Position of the Sun for an array of Julian
+                        days.  Field i of sunpos()'s result is written
+                        to out[i][0..n-1] when bit i (DC_SUN_*) is set
+                        in "fields"; the other out[] pointers are not
+                        touched and may be NULL.  Only the intermediate
+                        quantities needed by the requested fields are
+                        evaluated.  Days are processed in blocks of
+                        DC_SUN_LANES laid out as structure of arrays so
+                        the polynomial stages vectorize, and the sines
+                        of 2M and 3M come from multiple-angle identities
+                        instead of further sine evaluations, so results
+                        agree with sunpos() to within rounding. */
+
+#define DC_SUN_LANES 8
+
+void dc_sunpos_batch(const double *jd, size_t n, unsigned fields, double *out[12])
+{
+    double T[DC_SUN_LANES], L0[DC_SUN_LANES], M[DC_SUN_LANES], e[DC_SUN_LANES], C[DC_SUN_LANES],
+           sunLong[DC_SUN_LANES], sunAnomaly[DC_SUN_LANES], sunR[DC_SUN_LANES], Omega[DC_SUN_LANES],
+           Lambda[DC_SUN_LANES], epsilon0[DC_SUN_LANES], epsilon[DC_SUN_LANES], sM[DC_SUN_LANES], cM[DC_SUN_LANES];
+    double *res[12] = {L0, M, e, C, sunLong, sunAnomaly, sunR, Lambda, NULL, NULL, NULL, NULL};
+    unsigned need;
+    size_t base, i, lanes;
+    int f;
+
+    // Close the requested set over the quantities each field depends on
+
+    need = fields & DC_SUN_ALL;
+    if(need & (DC_SUN_ALPHA_APP | DC_SUN_DELTA_APP))
+        need |= DC_SUN_LAMBDA;
+    if(need & (DC_SUN_ALPHA | DC_SUN_DELTA | DC_SUN_LAMBDA))
+        need |= DC_SUN_LONG;
+    if(need & DC_SUN_R)
+        need |= DC_SUN_E | DC_SUN_ANOMALY;
+    if(need & DC_SUN_ANOMALY)
+        need |= DC_SUN_M | DC_SUN_C;
+    if(need & DC_SUN_LONG)
+        need |= DC_SUN_L0 | DC_SUN_C;
+    if(need & DC_SUN_C)
+        need |= DC_SUN_M;
+
+    for(base = 0; base < n; base += DC_SUN_LANES)
+    {
+        lanes = ((n - base) < DC_SUN_LANES) ? (n - base) : DC_SUN_LANES;
 
-static const double GREGORIAN_EPOCH = 1721425.5;
+        for(i = 0; i < lanes; i++)
+            T[i] = (jd[base + i] - J2000) / JulianCentury;
 
-// LEAP_GREGORIAN: Is a given year in the Gregorian calendar a leap year?
+        if(need & DC_SUN_L0)
+            for(i = 0; i < lanes; i++)
+                L0[i] = fixangle(280.46646 + (36000.76983 * T[i]) + (0.0003032 * T[i] * T[i]));
 
-int leap_gregorian(int year)
-{
-    // return ((year % 4) == 0) && (!(((year % 100) == 0) && ((year % 400) != 0)));
-    return (year % 400 == 0) || ((year % 4 == 0) && (year % 100 != 0));
+        if(need & DC_SUN_M)
+            for(i = 0; i < lanes; i++)
+                M[i] = fixangle(357.52911 + (35999.05029 * T[i]) + (-0.0001537 * T[i] * T[i]));
+
+        if(need & DC_SUN_E)
+            for(i = 0; i < lanes; i++)
+                e[i] = 0.016708634 + (-0.000042037 * T[i]) + (-0.0000001267 * T[i] * T[i]);
+
+        if(need & DC_SUN_C)
+        {
+            for(i = 0; i < lanes; i++)
+            {
+                sM[i] = dsin(M[i]);
+                cM[i] = dcos(M[i]);
+            }
+            for(i = 0; i < lanes; i++)
+                C[i] = ((1.914602 + (-0.004817 * T[i]) + (-0.000014 * T[i] * T[i])) * sM[i]) +
+                       ((0.019993 - (0.000101 * T[i])) * (2 * sM[i] * cM[i])) +
+                       (0.000289 * (sM[i] * (3 - (4 * sM[i] * sM[i]))));
+        }
+
+        if(need & DC_SUN_LONG)
+            for(i = 0; i < lanes; i++)
+                sunLong[i] = L0[i] + C[i];
+
+        if(need & DC_SUN_ANOMALY)
+            for(i = 0; i < lanes; i++)
+                sunAnomaly[i] = M[i] + C[i];
+
+        if(need & DC_SUN_R)
+            for(i = 0; i < lanes; i++)
+                sunR[i] = (1.000001018 * (1 - (e[i] * e[i]))) / (1 + (e[i] * dcos(sunAnomaly[i])));
+
+        if(need & (DC_SUN_LAMBDA | DC_SUN_ALPHA_APP | DC_SUN_DELTA_APP))
+            for(i = 0; i < lanes; i++)
+                Omega[i] = 125.04 - (1934.136 * T[i]);
+
+        if(need & DC_SUN_LAMBDA)
+            for(i = 0; i < lanes; i++)
+                Lambda[i] = sunLong[i] + (-0.00569) + (-0.00478 * dsin(Omega[i]));
+
+        if(need & (DC_SUN_ALPHA | DC_SUN_DELTA | DC_SUN_ALPHA_APP | DC_SUN_DELTA_APP))
+            for(i = 0; i < lanes; i++)
+                epsilon0[i] = obliqeq(jd[base + i]);
+
+        if(need & (DC_SUN_ALPHA_APP | DC_SUN_DELTA_APP))
+            for(i = 0; i < lanes; i++)
+                epsilon[i] = epsilon0[i] + (0.00256 * dcos(Omega[i]));
+
+        for(f = 0; f < 8; f++)
+            if(fields & (1u << f))
+                memcpy(out[f] + base, res[f], lanes * sizeof(double));
+
+        if(fields & DC_SUN_ALPHA)
+            for(i = 0; i < lanes; i++)
+                out[8][base + i] = fixangle(rtd(ratan2(dcos(epsilon0[i]) * dsin(sunLong[i]), dcos(sunLong[i]))));
+
+        if(fields & DC_SUN_DELTA)
+            for(i = 0; i < lanes; i++)
+                out[9][base + i] = rtd(rasin(dsin(epsilon0[i]) * dsin(sunLong[i])));
+
+        if(fields & DC_SUN_ALPHA_APP)
+            for(i = 0; i < lanes; i++)
+                out[10][base + i] = fixangle(rtd(ratan2(dcos(epsilon[i]) * dsin(Lambda[i]), dcos(Lambda[i]))));
+
+        if(fields & DC_SUN_DELTA_APP)
+            for(i = 0; i < lanes; i++)
+                out[11][base + i] = rtd(rasin(dsin(epsilon[i]) * dsin(Lambda[i])));
+    }
 }
 
-// GREGORIAN_TO_JD:‌ Determine Julian day number from Gregorian calendar date
+/* Reduced-precision evaluation of the March equinox.  Large
+   arguments (Julian days, angles growing with time) are formed and
+   range reduced in double; everything that follows runs in float,
+   with polynomial sine and cosine on [-45, 45] degrees and only the
+   leading terms of the nutation series, so the kernels vectorize at
+   twice the width of the double ones.  meridian_equinox_reduced()
+   stays within EQUINOX_REDUCED_ERROR days of meridian_equinox() for
+   every Gregorian year of the equinox cache window (see
+   tools/equinox_error_report.c), so its day is trusted only when it
+   lies further than that from a day boundary. */
 
-double gregorian_to_jd(int year, int month, int day)
+static const double EQUINOX_REDUCED_ERROR = 1e-6;  // Days, about 20 times the measured maximum
+#define NUTATION_REDUCED_TERMS 16  // Leading terms of the nutation series evaluated
+
+static dc_astro_precision_t astro_precision = DC_ASTRO_DOUBLE;
+
+// DC_SET_ASTRO_PRECISION: Select how equinox days are evaluated (not thread-safe)
+
+void dc_set_astro_precision(dc_astro_precision_t precision)
 {
-    return (GREGORIAN_EPOCH - 1) + (365 * (year - 1)) + floor((year - 1) / (double)4) +
-           (-floor((year - 1) / (double)100)) + floor((year - 1) / (double)400) +
-           floor((((367 * month) - 362) / (double)12) +
-           ((month <= 2) ? 0 : (leap_gregorian(year) ? -1 : -2)) + day);
+    astro_precision = precision;
 }
 
-// JD_TO_GREGORIAN: Calculate Gregorian calendar date from Julian day
+dc_astro_precision_t dc_get_astro_precision(void)
+{
+    return astro_precision;
+}
 
-void jd_to_gregorian(double jd, int *year, int *month, int *day)
+// FSINCOS_DEG: Float sine and cosine of an angle in degrees
+
+static inline void fsincos_deg(double d, float *s, float *c)
 {
-    double wjd, depoch, quadricent, dqc, cent, dcent, quad, dquad, yindex, yearday, leapadj;
+    // Cephes sinf()/cosf() minimax coefficients for [-pi/4, pi/4]
 
-    wjd = floor(jd - 0.5) + 0.5;
-    depoch = wjd - GREGORIAN_EPOCH;
-    quadricent = floor(depoch / 146097);
-    dqc = mod(depoch, 146097);
-    cent = floor(dqc / 36524);
-    dcent = mod(dqc, 36524);
-    quad = floor(dcent / 1461);
-    dquad = mod(dcent, 1461);
-    yindex = floor(dquad / 365);
+    double q;
+    float r, z, ps, pc;
+    int quadrant;
 
-    *year = (int)((quadricent * 400) + (cent * 100) + (quad * 4) + yindex);
-    if(!((cent == 4) || (yindex == 4)))
-        (*year)++;
+    q = floor((d / 90.0) + 0.5);
+    r = (float)dtr(d - (90.0 * q));
+    quadrant = (int)(q - (4.0 * floor(q / 4.0)));
 
-    yearday = wjd - gregorian_to_jd(*year, 1, 1);
-    leapadj = ((wjd < gregorian_to_jd(*year, 3, 1)) ? 0 : (leap_gregorian(*year) ? 1 : 2));
-    *month = (int)floor((((yearday + leapadj) * 12) + 373) / 367);
-    *day = (int)(wjd - gregorian_to_jd(*year, *month, 1)) + 1;
+    z = r * r;
+    ps = r + ((r * z) * ((((-1.9515295891e-4f * z) + 8.3321608736e-3f) * z) - 1.6666654611e-1f));
+    pc = 1.0f - (0.5f * z) + ((z * z) * ((((2.443315711809948e-5f * z) - 1.388731625493765e-3f) * z) + 4.166664568298827e-2f));
+
+    switch(quadrant)
+    {
+        case 0: *s = ps; *c = pc; break;
+        case 1: *s = pc; *c = -ps; break;
+        case 2: *s = -ps; *c = -pc; break;
+        default: *s = -pc; *c = ps; break;
+    }
 }
 
-int *jd_to_gregorian_arr(double jd, int result_ymd[])
+static inline float fsin_deg(double d)
 {
-    jd_to_gregorian(jd, &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    float s, c;
+    fsincos_deg(d, &s, &c);
+    return s;
 }
 
-const char *gregorian_month_name(int month)
+static inline float fcos_deg(double d)
 {
-    if(month < 1 || month > 12)
-        return NULL;
-    static const char *gm_name[] = {"January", "February", "March", "April", "May", "June",
-                                    "July", "August", "September", "October", "November", "December"};
-    return gm_name[month - 1];
+    float s, c;
+    fsincos_deg(d, &s, &c);
+    return c;
 }
 
-int gregorian_month_days(int year, int month)
+// Leading terms of the nutation series, as nutation(), in float
+
+DC_KERNEL void nutation_terms_reduced(const double ta[5], float to10, float *dp, float *de)
 {
-    switch(month)
+    double ang[NUTATION_REDUCED_TERMS], a;
+    float sa[NUTATION_REDUCED_TERMS], ca[NUTATION_REDUCED_TERMS], sp = 0, se = 0;
+    int i, j;
+
+    for(i = 0; i < NUTATION_REDUCED_TERMS; i++)
     {
-        case 1:
-        case 3:
-        case 5:
-        case 7:
-        case 8:
-        case 10:
-        case 12:
-            return 31;
-        case 4:
-        case 6:
-        case 9:
-        case 11:
-            return 30;
-        case 2:
-            break;
-        default:
-            return -1;  // ERROR: The month must be between 1-12
+        a = 0;
+        for(j = 0; j < 5; j++)
+            a += nutArgMult[(i * 5) + j] * ta[j];
+        ang[i] = a;
+    }
+    for(i = 0; i < NUTATION_REDUCED_TERMS; i++)
+        fsincos_deg(ang[i], &sa[i], &ca[i]);
+    for(i = 0; i < NUTATION_REDUCED_TERMS; i++)
+    {
+        sp += (nutArgCoeff[(i * 4) + 0] + nutArgCoeff[(i * 4) + 1] * to10) * sa[i];
+        se += (nutArgCoeff[(i * 4) + 2] + nutArgCoeff[(i * 4) + 3] * to10) * ca[i];
     }
 
-    return leap_gregorian(year) ? 29 : 28;
+    *dp = sp;
+    *de = se;
 }
 
-// /////////////////////////////////   GREGORIAN CALENDAR   ///////////////////////////////// //
-// ****************************************************************************************** //
-// /////////////////////////////////    PERSIAN CALENDAR    ///////////////////////////////// //
-
-static const double PERSIAN_EPOCH = 1948320.5;
+DC_ISA_VARIANTS(nutation_terms_reduced, (const double ta[5], float to10, float *dp, float *de), (ta, to10, dp, de))
 
-/* TEHRAN_EQUINOX  --  Determine Julian day and fraction of the
-                       March equinox at the Tehran meridian in
-                       a given Gregorian year. */
+/* EQUATIONOFTIME_REDUCED  --  Equation of time as a fraction of a
+                               day, as equationOfTime(), using the
+                               apparent right ascension of the Sun
+                               and the leading nutation terms in
+                               float. */
 
-double tehran_equinox(int year)
+float equationOfTime_reduced(double jd)
 {
-    double equJED, equJD, equAPP, equTehran, dtTehran;
+    double tau, T, L0, M, Omega, ta[5];
+    float C, sunLong, Lambda, epsilon0, epsilon, alpha, dp, de, sa, ca, E, tf, tf2;
 
-    // March equinox in dynamical time
-    equJED = equinox(year, 0);
-
-    // Correct for delta T to obtain Universal time
-    equJD = equJED - (deltat(year) / (24 * 60 * 60));
+    tau = (jd - J2000) / JulianMillennium;
+    L0 = 280.4664567 + (360007.6982779 * tau) +
+         (0.03032028 * tau * tau) +
+         ((tau * tau * tau) / 49931) +
+         (-((tau * tau * tau * tau) / 15300)) +
+         (-((tau * tau * tau * tau * tau) / 2000000));
+    L0 = fixangle(L0);
 
-    // Apply the equation of time to yield the apparent time at Greenwich
-    equAPP = equJD + equationOfTime(equJED);
+    // Apparent right ascension of the Sun, as sunpos()[10]
 
-    /* Finally, we must correct for the constant difference between
-       the Greenwich meridian andthe time zone standard for
-       Iran Standard time, 52°30' to the East. */
+    T = (jd - J2000) / JulianCentury;
+    tf = (float)T;
+    tf2 = tf * tf;
+    M = fixangle(357.52911 + (35999.05029 * T) + (-0.0001537 * T * T));
+    fsincos_deg(M, &sa, &ca);
+    C = ((1.914602f + (-0.004817f * tf) + (-0.000014f * tf2)) * sa) +
+        ((0.019993f - (0.000101f * tf)) * (2 * sa * ca)) +
+        (0.000289f * (sa * (3 - (4 * sa * sa))));
+    sunLong = (float)fixangle(280.46646 + (36000.76983 * T) + (0.0003032 * T * T)) + C;
+    Omega = fixangle(125.04 - (1934.136 * T));
+    Lambda = sunLong + (-0.00569f) + (-0.00478f * fsin_deg(Omega));
+    epsilon0 = (float)obliqeq(jd);
+    epsilon = epsilon0 + (0.00256f * fcos_deg(Omega));
+    fsincos_deg(Lambda, &sa, &ca);
+    alpha = (float)rtd(ratan2(fcos_deg(epsilon) * sa, ca));
+
+    // Leading terms of the nutation series, as nutation()
+
+    ta[0] = 297.850363 + 445267.11148 * T;
+    ta[1] = 357.52772 + 35999.05034 * T;
+    ta[2] = 134.96298 + 477198.867398 * T;
+    ta[3] = 93.27191 + 483202.017538 * T;
+    ta[4] = 125.04452 - 1934.136261 * T;
+
+    isa_kernels()->nutation_terms_reduced(ta, tf / 10, &dp, &de);
+    dp /= (3600.0f * 10000.0f);
+    de /= (3600.0f * 10000.0f);
+
+    E = (float)L0 + (-0.0057183f) + (-(float)fixangle(alpha)) + (dp * fcos_deg(obliqeq(jd) + de));
+    E = E - 20.0f * floorf(E / 20.0f);
+    return E / (24 * 60);
+}
+
+// Periodic terms of the equinox, as equinox(), in float
+
+DC_KERNEL void equinox_terms_reduced(double T, float *S)
+{
+    double arg[24];
+    float c[24], sum = 0;
+    int i;
 
-    dtTehran = (52 + (30 / 60.0) + (0 / (60.0 * 60.0))) / 360;
-    equTehran = equAPP + dtTehran;
+    for(i = 0; i < 24; i++)
+        arg[i] = EquinoxpTerms[(i * 3) + 1] + (EquinoxpTerms[(i * 3) + 2] * T);
+    for(i = 0; i < 24; i++)
+        c[i] = fcos_deg(arg[i]);
+    for(i = 0; i < 24; i++)
+        sum += (float)EquinoxpTerms[i * 3] * c[i];
 
-    return equTehran;
+    *S = sum;
 }
 
-/* TEHRAN_EQUINOX_JD  --  Calculate Julian day during which the
-                          March equinox, reckoned from the Tehran
-                          meridian, occurred for a given Gregorian
-                          year. */
+DC_ISA_VARIANTS(equinox_terms_reduced, (double T, float *S), (T, S))
 
-double tehran_equinox_jd(int year)
+/* EQUINOX_REDUCED  --  Julian Ephemeris Day of the March equinox,
+                        as equinox(year, 0), with the periodic terms
+                        summed in float. */
+
+double equinox_reduced(int year)
 {
-    return floor(tehran_equinox(year));
-}
+    double JDE0, T;
+    float deltaL, S;
 
-/* PERSIAN_YEAR  --  Determine the year in the Persian
-                     astronomical calendar in which a
-                     given Julian day falls.  Returns an
-                     array of two elements:
+    JDE0 = equinox_mean(year, 0);
+    T = (JDE0 - 2451545.0) / 36525;
 
-                           [0]  Persian year
-                           [1]  Julian day number containing
-                                equinox for this year.
+    isa_kernels()->equinox_terms_reduced(T, &S);
+
+    deltaL = 1 + (0.0334f * fcos_deg((35999.373 * T) - 2.47)) + (0.0007f * fcos_deg(2 * ((35999.373 * T) - 2.47)));
+
+    return JDE0 + ((S * 0.00001f) / deltaL);
+}
+
+// /////////////////////////////////         ASTRO          ///////////////////////////////// //
+// ****************************************************************************************** //
+// /////////////////////////////////          MOON          ///////////////////////////////// //
+
+static const double SynodicMonth = 29.530588861;              // Mean synodic month in days
+
+/* Periodic terms for the true phases of the Moon, from chapter 49 of
+   Meeus, "Astronomical Algorithms".  Each row gives the coefficient
+   in units of 0.00001 day, the power of the eccentricity factor E
+   and the multiples of M, M', F and Omega in the sine argument. */
+
+static const int moonNewTerms[] = {
+    -40720, 0,  0,  1,  0,  0,
+     17241, 1,  1,  0,  0,  0,
+      1608, 0,  0,  2,  0,  0,
+      1039, 0,  0,  0,  2,  0,
+       739, 1, -1,  1,  0,  0,
+      -514, 1,  1,  1,  0,  0,
+       208, 2,  2,  0,  0,  0,
+      -111, 0,  0,  1, -2,  0,
+       -57, 0,  0,  1,  2,  0,
+        56, 1,  1,  2,  0,  0,
+       -42, 0,  0,  3,  0,  0,
+        42, 1,  1,  0,  2,  0,
+        38, 1,  1,  0, -2,  0,
+       -24, 1, -1,  2,  0,  0,
+       -17, 0,  0,  0,  0,  1,
+        -7, 0,  2,  1,  0,  0,
+         4, 0,  0,  2, -2,  0,
+         4, 0,  3,  0,  0,  0,
+         3, 0,  1,  1, -2,  0,
+         3, 0,  0,  2,  2,  0,
+        -3, 0,  1,  1,  2,  0,
+         3, 0, -1,  1,  2,  0,
+        -2, 0, -1,  1, -2,  0,
+        -2, 0,  1,  3,  0,  0,
+         2, 0,  0,  4,  0,  0
+};
+
+static const int moonFullTerms[] = {
+    -40614, 0,  0,  1,  0,  0,
+     17302, 1,  1,  0,  0,  0,
+      1614, 0,  0,  2,  0,  0,
+      1043, 0,  0,  0,  2,  0,
+       734, 1, -1,  1,  0,  0,
+      -515, 1,  1,  1,  0,  0,
+       209, 2,  2,  0,  0,  0,
+      -111, 0,  0,  1, -2,  0,
+       -57, 0,  0,  1,  2,  0,
+        56, 1,  1,  2,  0,  0,
+       -42, 0,  0,  3,  0,  0,
+        42, 1,  1,  0,  2,  0,
+        38, 1,  1,  0, -2,  0,
+       -24, 1, -1,  2,  0,  0,
+       -17, 0,  0,  0,  0,  1,
+        -7, 0,  2,  1,  0,  0,
+         4, 0,  0,  2, -2,  0,
+         4, 0,  3,  0,  0,  0,
+         3, 0,  1,  1, -2,  0,
+         3, 0,  0,  2,  2,  0,
+        -3, 0,  1,  1,  2,  0,
+         3, 0, -1,  1,  2,  0,
+        -2, 0, -1,  1, -2,  0,
+        -2, 0,  1,  3,  0,  0,
+         2, 0,  0,  4,  0,  0
+};
+
+static const int moonQuarterTerms[] = {
+    -62801, 0,  0,  1,  0,  0,
+     17172, 1,  1,  0,  0,  0,
+     -1183, 1,  1,  1,  0,  0,
+       862, 0,  0,  2,  0,  0,
+       804, 0,  0,  0,  2,  0,
+       454, 1, -1,  1,  0,  0,
+       204, 2,  2,  0,  0,  0,
+      -180, 0,  0,  1, -2,  0,
+       -70, 0,  0,  1,  2,  0,
+       -40, 0,  0,  3,  0,  0,
+       -34, 1, -1,  2,  0,  0,
+        32, 1,  1,  0,  2,  0,
+        32, 1,  1,  0, -2,  0,
+       -28, 2,  2,  1,  0,  0,
+        27, 1,  1,  2,  0,  0,
+       -17, 0,  0,  0,  0,  1,
+        -5, 0, -1,  1, -2,  0,
+         4, 0,  0,  2,  2,  0,
+        -4, 0,  1,  1,  2,  0,
+         4, 0, -2,  1,  0,  0,
+         3, 0,  1,  1, -2,  0,
+         3, 0,  3,  0,  0,  0,
+         2, 0,  0,  2, -2,  0,
+         2, 0, -1,  1,  2,  0,
+        -2, 0,  1,  3,  0,  0
+};
+
+/* MOON_PHASE_JDE  --  Determine the Julian Ephemeris Day of a true
+                       lunar phase.  The lunation k counts new moons
+                       from that of 2000 January 6, and the "which"
+                       argument selects the phase within it:
+
+                           0   New moon
+                           1   First quarter
+                           2   Full moon
+                           3   Last quarter
 */
 
-double *persian_year(double jd, double result[])
-{
-    double lasteq, nexteq, adr;
-    int guess;
-    int y, m, d;
+double moon_phase_jde(int k, int which)
+{
+    // Planetary arguments: constant term, rate per lunation, coefficient in 0.000001 day
+
+    static const double moonPlanetTerms[] = {
+        299.77,  0.107408, 325,
+        251.88,  0.016321, 165,
+        251.83, 26.651886, 164,
+        349.42, 36.412478, 126,
+         84.66, 18.206239, 110,
+        141.74, 53.303771,  62,
+        207.14,  2.453732,  60,
+        154.84,  7.306860,  56,
+         34.52, 27.261239,  47,
+        207.19,  0.121824,  42,
+        291.34,  1.844379,  40,
+        161.72, 24.198154,  37,
+        239.56, 25.513099,  35,
+        331.55,  3.592518,  23
+    };
 
-    jd_to_gregorian(jd, &y, &m, &d);
-    guess = y - 2;
+    const int *terms;
+    double kk, T, T2, T3, T4, JDE, E, M, Mp, F, Omega, ang, S, W;
+    int i;
 
-    lasteq = tehran_equinox_jd(guess);
-    while(lasteq > jd)
+    kk = k + (which / 4.0);
+    T = kk / 1236.85;
+    T2 = T * T;
+    T3 = T2 * T;
+    T4 = T3 * T;
+
+    JDE = 2451550.09766 + (SynodicMonth * kk) + (0.00015437 * T2) - (0.000000150 * T3) + (0.00000000073 * T4);
+
+    E = 1 - (0.002516 * T) - (0.0000074 * T2);
+    M = dtr(fixangle(2.5534 + (29.10535670 * kk) - (0.0000014 * T2) - (0.00000011 * T3)));
+    Mp = dtr(fixangle(201.5643 + (385.81693528 * kk) + (0.0107582 * T2) + (0.00001238 * T3) - (0.000000058 * T4)));
+    F = dtr(fixangle(160.7108 + (390.67050284 * kk) - (0.0016118 * T2) - (0.00000227 * T3) + (0.000000011 * T4)));
+    Omega = dtr(fixangle(124.7746 - (1.56375588 * kk) + (0.0020672 * T2) + (0.00000215 * T3)));
+
+    terms = (which == 0) ? moonNewTerms : ((which == 2) ? moonFullTerms : moonQuarterTerms);
+
+    S = 0;
+    for(i = 0; i < 25 * 6; i += 6)
     {
-        guess--;
-        lasteq = tehran_equinox_jd(guess);
+        ang = (terms[i + 2] * M) + (terms[i + 3] * Mp) + (terms[i + 4] * F) + (terms[i + 5] * Omega);
+        S += terms[i] * ((terms[i + 1] == 0) ? 1 : ((terms[i + 1] == 1) ? E : E * E)) * rsin(ang);
     }
+    JDE += S * 0.00001;
 
-    nexteq = lasteq - 1;
-    while(!((lasteq <= jd) && (jd < nexteq)))
+    // The quarters carry an additional correction of opposite sign
+
+    if(which == 1 || which == 3)
     {
-        lasteq = nexteq;
-        guess++;
-        nexteq = tehran_equinox_jd(guess);
+        W = 0.00306 - (0.00038 * E * rcos(M)) + (0.00026 * rcos(Mp)) - (0.00002 * rcos(Mp - M)) +
+            (0.00002 * rcos(Mp + M)) + (0.00002 * rcos(2 * F));
+        JDE += (which == 1) ? W : -W;
     }
-    adr = round((lasteq - PERSIAN_EPOCH) / TropicalYear) + 1;
 
-    result[0] = adr;
-    result[1] = lasteq;
+    // Corrections for the planetary arguments
 
-    return result;
+    S = 0;
+    for(i = 0; i < 14 * 3; i += 3)
+        S += moonPlanetTerms[i + 2] * dsin(moonPlanetTerms[i] + (moonPlanetTerms[i + 1] * kk) - ((i == 0) ? 0.009173 * T2 : 0));
+    JDE += S * 0.000001;
+
+    return JDE;
 }
 
-/* PERSIAN_TO_JD  --  Obtain Julian day from a given Persian
-                      astronomical calendar date. */
+/* MOON_PHASE_JD  --  Universal time of a true lunar phase, obtained
+                      from moon_phase_jde() by removing Delta T. */
 
-double persian_to_jd(int year, int month, int day)
+double moon_phase_jd(int k, int which)
 {
-    double equinox, guess, jd;
-    double adr[2];
+    return moon_phase_jde(k, which) - (deltat((int)floor(2000 + ((k + (which / 4.0)) / 12.3685))) / (24 * 60 * 60));
+}
 
-    guess = (PERSIAN_EPOCH - 1) + (TropicalYear * ((year - 1) - 1));
-    adr[0] = year - 1;
-    adr[1] = 0;
+/* Lunations are cached per thread in a small direct-mapped table so
+   calendars and interfaces that keep asking about the same months do
+   not re-run the periodic terms. */
 
-    while(adr[0] < year)
-        guess = persian_year(guess, adr)[1] + (TropicalYear + 2);
-    equinox = adr[1];
+#define DC_LUNATION_CACHE_SIZE 256
 
-    jd = equinox + ((month <= 7) ? ((month - 1) * 31) : (((month - 1) * 30) + 6)) + (day - 1) + 0.5;
-    return jd;
-}
+static _Thread_local dc_lunation_t lunation_cache[DC_LUNATION_CACHE_SIZE];
+static _Thread_local int lunation_cache_valid[DC_LUNATION_CACHE_SIZE];
 
-/* JD_TO_PERSIAN  --  Calculate date in the Persian astronomical
-                      calendar from Julian day. */
+// DC_LUNATION: Fill the four principal phases (Universal time) of lunation k
 
-void jd_to_persian(double jd, int *year, int *month, int *day)
+dc_lunation_t *dc_lunation(int k, dc_lunation_t *result)
 {
-    double equinox, yday;
-    double adr[2];
+    int slot, which;
 
-    jd = floor(jd) + 0.5;
-    *year = (int)persian_year(jd, adr)[0];
-    equinox = adr[1];
-    *day = (int)floor((jd - equinox) / 30) + 1;
+    slot = k & (DC_LUNATION_CACHE_SIZE - 1);
+    if(!lunation_cache_valid[slot] || lunation_cache[slot].k != k)
+    {
+        lunation_cache[slot].k = k;
+        for(which = 0; which < 4; which++)
+            lunation_cache[slot].phase[which] = moon_phase_jd(k, which);
+        lunation_cache_valid[slot] = 1;
+    }
 
-    yday = (floor(jd) - (persian_to_jd(*year, 1, 1) - 0.5)) + 1;
-    *month = (int)((yday <= 186) ? ceil(yday / 31) : ceil((yday - 6) / 30));
-    *day = (int)(floor(jd) - (persian_to_jd(*year, *month, 1) - 0.5)) + 1;
+    *result = lunation_cache[slot];
+    return result;
 }
 
-int *jd_to_persian_arr(double jd, int result_ymd[])
+// DC_NEW_MOON: Julian day (Universal time) of the new moon of lunation k
+
+double dc_new_moon(int k)
 {
-    jd_to_persian(jd, &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    dc_lunation_t lun;
+    return dc_lunation(k, &lun)->phase[0];
 }
 
-/* LEAP_PERSIAN  --  Is a given year a leap year in the Persian
-                     astronomical calendar? */
+// DC_LUNATION_OF: Lunation whose new moon most recently precedes a Julian day
 
-int leap_persian(int year)
+int dc_lunation_of(double jd)
 {
-    return (persian_to_jd(year + 1, 1, 1) - persian_to_jd(year, 1, 1)) > 365;
+    int k;
+
+    k = (int)floor((jd - 2451550.09766) / SynodicMonth);
+    while(dc_new_moon(k) > jd)
+        k--;
+    while(dc_new_moon(k + 1) <= jd)
+        k++;
+
+    return k;
 }
 
-const char *persian_month_name(int month)
+/* DC_MOON_PHASE  --  Phase of the Moon at a given Julian day as a
+                      fraction of the lunation: 0 at new moon, 0.25 at
+                      first quarter, 0.5 at full moon and 0.75 at last
+                      quarter.  Between principal phases the fraction
+                      is interpolated linearly in time.  The lunation
+                      number is stored through the optional pointer. */
+
+double dc_moon_phase(double jd, int *lunation)
 {
-    if(month < 1 || month > 12)
-        return NULL;
-    static const char *pm_name[] = {"Farvardin", "Ordibehesht", "Khordad", "Tir", "Mordad", "Shahrivar",
-                                    "Mehr", "Aban", "Azar", "Dey", "Bahman", "Esfand"};
-    return pm_name[month - 1];
+    dc_lunation_t lun;
+    double next;
+    int k, which;
+
+    k = dc_lunation_of(jd);
+    dc_lunation(k, &lun);
+    if(lunation)
+        *lunation = k;
+
+    for(which = 3; which > 0 && lun.phase[which] > jd; which--);
+    next = (which == 3) ? dc_new_moon(k + 1) : lun.phase[which + 1];
+
+    return (which + ((jd - lun.phase[which]) / (next - lun.phase[which]))) / 4;
 }
 
-int persian_month_days(int year, int month)
+/* DC_LUNATIONS  --  Generate all lunations whose new moon falls in
+                     the Gregorian years first_year through last_year
+                     (inclusive).  At most max_count lunations are
+                     stored; the return value is the total number in
+                     the range, so passing a NULL result with a zero
+                     max_count sizes the buffer. */
+
+int dc_lunations(int first_year, int last_year, dc_lunation_t result[], int max_count)
 {
-    switch(month)
+    double start, end;
+    int k, count = 0;
+
+    start = gregorian_to_jd(first_year, 1, 1);
+    end = gregorian_to_jd(last_year + 1, 1, 1);
+
+    for(k = dc_lunation_of(start); dc_new_moon(k) < end; k++)
     {
-        case 1:
-        case 2:
-        case 3:
-        case 4:
-        case 5:
-        case 6:
-            return 31;
-        case 7:
-        case 8:
-        case 9:
-        case 10:
-        case 11:
-            return 30;
-        case 12:
-            break;
-        default:
-            return -1;  // ERROR: The month must be between 1-12
+        if(dc_new_moon(k) < start)
+            continue;
+        if(count < max_count)
+            dc_lunation(k, &result[count]);
+        count++;
     }
 
-    return leap_persian(year) ? 30 : 29;
+    return count;
 }
 
-// PERSIANB_TO_JD: Determine Julian day from Birashk's Persian date
+// /////////////////////////////////          MOON          ///////////////////////////////// //
+#endif  // DC_EMBEDDED
+// ****************************************************************************************** //
+// /////////////////////////////////   GREGORIAN CALENDAR   ///////////////////////////////// //
 
-double persianb_to_jd(int year, int month, int day)
-{
-    double epbase, epyear;
+#ifndef DC_EMBEDDED
+static const double GREGORIAN_EPOCH = 1721425.5;
+#endif
 
-    epbase = year - ((year >= 0) ? 474 : 473);
-    epyear = 474 + mod(epbase, 2820);
+/* GREGORIAN_TO_JDN  --  gregorian_to_jd() on integers: the Julian day
+                         number (the Julian day + 0.5) of a date within
+                         DC_JDN_YMD_OK(). */
 
-    return day + ((month <= 7) ? ((month - 1) * 31) : (((month - 1) * 30) + 6)) +
-           floor(((epyear * 682) - 110) / 2816) + (epyear - 1) * 365 + floor(epbase / 2820) * 1029983 +
-           (PERSIAN_EPOCH - 1);
+static int gregorian_to_jdn(int year, int month, int day)
+{
+    return 1721425 + (365 * (year - 1)) + floor_div(year - 1, 4) - floor_div(year - 1, 100) + floor_div(year - 1, 400) +
+           floor_div(((367 * month) - 362) + (12 * (((month <= 2) ? 0 : (leap_gregorian(year) ? -1 : -2)) + day)), 12);
 }
 
-// JD_TO_PERSIANB: Calculate Birashk's Persian date from Julian day
+/* JDN_TO_GREGORIAN  --  jd_to_gregorian() on integers, with the first
+                         of January computed once and the other month
+                         starts derived from it. */
 
-void jd_to_persianb(double jd, int *year, int *month, int *day)
+static void jdn_to_gregorian(int jdn, int *year, int *month, int *day)
 {
-    double depoch, cycle, cyear, ycycle, aux1, aux2, yday;
+    int depoch, quadricent, dqc, cent, dcent, quad, dquad, yindex, y, m, leap, jan1, yearday;
 
-    jd = floor(jd) + 0.5;
+    depoch = jdn - 1721426;
+    quadricent = floor_div(depoch, 146097);
+    dqc = depoch - (quadricent * 146097);
+    cent = dqc / 36524;
+    dcent = dqc % 36524;
+    quad = dcent / 1461;
+    dquad = dcent % 1461;
+    yindex = dquad / 365;
 
-    depoch = jd - persianb_to_jd(475, 1, 1);
-    cycle = floor(depoch / 1029983);
-    cyear = mod(depoch, 1029983);
-    if(cyear == 1029982)
-    {
-        ycycle = 2820;
-    }
-    else
-    {
-        aux1 = floor(cyear / 366);
-        aux2 = mod(cyear, 366);
-        ycycle = floor(((2134 * aux1) + (2816 * aux2) + 2815) / 1028522) + aux1 + 1;
-    }
+    y = (quadricent * 400) + (cent * 100) + (quad * 4) + yindex;
+    if(!((cent == 4) || (yindex == 4)))
+        y++;
 
-    *year = (int)(ycycle + (2820 * cycle) + 474);
-    if(*year <= 0)
-        (*year)--;
+    leap = leap_gregorian(y);
+    jan1 = gregorian_to_jdn(y, 1, 1);
+    yearday = jdn - jan1;
+    m = floor_div(((yearday + ((yearday < 59 + leap) ? 0 : (leap ? 1 : 2))) * 12) + 373, 367);
 
-    yday = (jd - persianb_to_jd(*year, 1, 1)) + 1;
-    *month = (int)((yday <= 186) ? ceil(yday / 31) : ceil((yday - 6) / 30));
-    *day = (int)(jd - persianb_to_jd(*year, *month, 1)) + 1;
+    *year = y;
+    *month = m;
+    *day = yearday - (floor_div(((367 * m) - 362) + (12 * (((m <= 2) ? 0 : (leap ? -1 : -2)) + 1)), 12) - 1) + 1;
 }
 
-int *jd_to_persianb_arr(double jd, int result_ymd[])
-{
-    jd_to_persianb(jd, &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
-}
-
-// LEAP_PERSIANB: Is a given year a leap year in the Birashk's Persian calendar?
-
-int leap_persianb(int year)
-{
-    int y1, y2, m1, m2, d1, d2;
-
-    jd_to_gregorian(persianb_to_jd(year, 12, 30), &y1, &m1, &d1);
-    jd_to_gregorian(persianb_to_jd((year + 1), 1, 1), &y2, &m2, &d2);
-
-    // return !((d1 == d2) && (m1 == m2) && (y1 == y2));
-    return (d1 != d2) || (m1 != m2) || (y1 != y2);
-}
+#ifndef DC_EMBEDDED
 
-int leap_persianb2(int year)
-{
-    return ((((((year - ((year > 0) ? 474 : 473)) % 2820) + 474) + 38) * 682) % 2816) < 682;
-}
+// JD_TO_GREGORIAN: Calculate Gregorian calendar date from Julian day
 
-const char *persianb_month_name(int month)
+void jd_to_gregorian(double jd, int *year, int *month, int *day)
 {
-    return persian_month_name(month);
-}
+    double wjd, depoch, quadricent, dqc, cent, dcent, quad, dquad, yindex, yearday, leapadj;
 
-int persianb_month_days(int year, int month)
-{
-    switch(month)
+    if(DC_JDN_JD_OK(jd))
     {
-        case 1:
-        case 2:
-        case 3:
-        case 4:
-        case 5:
-        case 6:
-            return 31;
-        case 7:
-        case 8:
-        case 9:
-        case 10:
-        case 11:
-            return 30;
-        case 12:
-            break;
-        default:
-            return -1;  // ERROR: The month must be between 1-12
+        jdn_to_gregorian((int)floor(jd - 0.5) + 1, year, month, day);
+        return;
     }
 
-    return leap_persianb(year) ? 30 : 29;
-}
-
-// /////////////////////////////////    PERSIAN CALENDAR    ///////////////////////////////// //
-// ****************************************************************************************** //
-// /////////////////////////////////    ISLAMIC CALENDAR    ///////////////////////////////// //
-
-static const double ISLAMIC_EPOCH = 1948439.5;
+    wjd = floor(jd - 0.5) + 0.5;
+    depoch = wjd - GREGORIAN_EPOCH;
+    quadricent = floor(depoch / 146097);
+    dqc = mod(depoch, 146097);
+    cent = floor(dqc / 36524);
+    dcent = mod(dqc, 36524);
+    quad = floor(dcent / 1461);
+    dquad = mod(dcent, 1461);
+    yindex = floor(dquad / 365);
 
-// LEAP_ISLAMIC: Is a given year a leap year in the Islamic calendar?
+    *year = (int)((quadricent * 400) + (cent * 100) + (quad * 4) + yindex);
+    if(!((cent == 4) || (yindex == 4)))
+        (*year)++;
 
-int leap_islamic(int year)
-{
-    // return (((year * 11) + 14) % 30) < 11;  // Negative years -> ERROR
-    return mod(((year * 11) + 14), 30) < 11;
+    yearday = wjd - gregorian_to_jd(*year, 1, 1);
+    leapadj = ((wjd < gregorian_to_jd(*year, 3, 1)) ? 0 : (leap_gregorian(*year) ? 1 : 2));
+    *month = (int)floor((((yearday + leapadj) * 12) + 373) / 367);
+    *day = (int)(wjd - gregorian_to_jd(*year, *month, 1)) + 1;
 }
 
-// ISLAMIC_TO_JD: Determine Julian day from Islamic date
+#else
 
-double islamic_to_jd(int year, int month, int day)
+// GREGORIAN_TO_JD, JD_TO_GREGORIAN: The integer paths alone, for dates within DC_JDN_YMD_OK()
+
+double gregorian_to_jd(int year, int month, int day)
 {
-    return (day + ceil(29.5 * (month - 1)) + (year - 1) * 354 + floor((3 + (11 * year)) / (double)30) + ISLAMIC_EPOCH) - 1;
+    return gregorian_to_jdn(year, month, day) - 0.5;
 }
 
-// JD_TO_ISLAMIC: Calculate Islamic date from Julian day
-
-void jd_to_islamic(double jd, int *year, int *month, int *day)
+void jd_to_gregorian(double jd, int *year, int *month, int *day)
 {
-    int tm;
-    jd = floor(jd) + 0.5;
-    *year = (int)floor(((30 * (jd - ISLAMIC_EPOCH)) + 10646) / 10631);
-    tm = (int)ceil((jd - (29 + islamic_to_jd(*year, 1, 1))) / 29.5) + 1;
-    *month = (tm < 12) ? tm : 12;
-    *day = (int)(jd - islamic_to_jd(*year, *month, 1)) + 1;
+    jdn_to_gregorian(jd_floor(jd - 0.5) + 1, year, month, day);
 }
 
-int *jd_to_islamic_arr(double jd, int result_ymd[])
+#endif  // DC_EMBEDDED
+
+int *jd_to_gregorian_arr(double jd, int result_ymd[])
 {
-    jd_to_islamic(jd, &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    jd_to_gregorian(jd, &result_ymd[0], &result_ymd[1], &result_ymd[2]);
     return result_ymd;
 }
 
-const char *islamic_month_name(int month)
+const char *gregorian_month_name(int month)
 {
     if(month < 1 || month > 12)
         return NULL;
-    static const char *im_name[] = {"Muharram", "Safar", "Rabi' al-Awwal", "Rabi' al-Thani", "Jumada al-Awwal", "Jumada al-Thani",
-                                    "Rajab", "Sha'ban", "Ramadan", "Shawwal", "Dhu al-Qadah", "Dhu al-Hijjah"};
-    return im_name[month - 1];
+    static const char *gm_name[] = {"January", "February", "March", "April", "May", "June",
+                                    "July", "August", "September", "October", "November", "December"};
+    return gm_name[month - 1];
 }
 
-int islamic_month_days(int year, int month)
-{
-    int y1, y2, m1, m2, d1, d2;
+// /////////////////////////////////   GREGORIAN CALENDAR   ///////////////////////////////// //
+// ****************************************************************************************** //
+// /////////////////////////////////    PERSIAN CALENDAR    ///////////////////////////////// //
 
-    switch(month)
-    {
-        case 1:
-        case 2:
-        case 3:
-        case 4:
-        case 5:
-        case 6:
-        case 7:
-        case 8:
-        case 9:
-        case 10:
-        case 11:
-            jd_to_gregorian(islamic_to_jd(year, month, 30), &y1, &m1, &d1);
-            jd_to_gregorian(islamic_to_jd(year, (month + 1), 1), &y2, &m2, &d2);
-            break;
-        case 12:
-            jd_to_gregorian(islamic_to_jd(year, month, 30), &y1, &m1, &d1);
-            jd_to_gregorian(islamic_to_jd((year + 1), 1, 1), &y2, &m2, &d2);
-            break;
-        default:
-            return -1;  // ERROR: The month must be between 1-12
-    }
+#ifndef DC_EMBEDDED
 
-    return ((y1 == y2) && (m1 == m2) && (d1 == d2)) ? 29 : 30;
-}
+static const double PERSIAN_EPOCH = 1948320.5;
 
-// /////////////////////////////////    ISLAMIC CALENDAR    ///////////////////////////////// //
-// ****************************************************************************************** //
-// /////////////////////////////////    HEBREW CALENDAR     ///////////////////////////////// //
+// Reference meridians of the solar Hijri calendars, in degrees east of Greenwich
 
-static const double HEBREW_EPOCH = 347995.5;
+static dc_solar_hijri_t tehran_ctx = {52 + (30 / 60.0), {0}};  // Iran Standard Time, UTC+3:30
+static dc_solar_hijri_t kabul_ctx  = {67 + (30 / 60.0), {0}};  // Afghanistan Time, UTC+4:30
 
-int hebrew_year_days(int year);
+/* Ephemeris backends of the March equinox.  Each gives the Julian
+   Ephemeris Day of the equinox of a Gregorian year; the truncated
+   VSOP87 solver costs about ten short Meeus series, so its results
+   are memoized per year of the equinox cache window.  In
+   DC_EPHEM_AUTO the short series decides the day, and VSOP87 is
+   consulted only for the years whose equinox falls within the margin
+   of a day boundary. */
 
-// Is a given Hebrew year a leap year?
+typedef struct EphemerisBackend
+{
+    double (*march_equinox)(int year);
+} ephemeris_backend_t;
 
-int leap_hebrew(int year)
+static double march_equinox_meeus(int year)
 {
-    return mod(((year * 7) + 1), 19) < 7;
+    return equinox(year, 0);
 }
 
-// Test for delay of start of new year and to avoid
-// Sunday, Wednesday, and Friday as start of the new year.
-
-int hebrew_delay_1(int year)
+static double march_equinox_vsop87(int year)
 {
-    double months, days, parts;
+    static long long memo[DC_EQUINOX_CACHE_YEARS];  // Bits of the JDE, 0 = not yet computed
+    long long bits;
+    double jde;
+    int i;
 
-    months = floor(((235 * year) - 234) / (double)19);
-    parts = 12084 + (13753 * months);
-    days = (months * 29) + floor(parts / 25920);
+    i = year - DC_EQUINOX_CACHE_FIRST;
+    if(i < 0 || i >= DC_EQUINOX_CACHE_YEARS)
+        return equinox_vsop87(year, 0);
 
-    if(mod((3 * (days + 1)), 7) < 3)
-        days++;
+    if(!(bits = DC_LOAD_RELAXED(&memo[i])))
+    {
+        jde = equinox_vsop87(year, 0);
+        memcpy(&bits, &jde, sizeof(bits));
+        DC_STORE_RELAXED(&memo[i], bits);
+        return jde;
+    }
 
-    return (int)days;
+    memcpy(&jde, &bits, sizeof(jde));
+    return jde;
 }
 
-// Check for delay in start of new year due to length of adjacent years
+static const ephemeris_backend_t ephemeris_meeus = {march_equinox_meeus};
+static const ephemeris_backend_t ephemeris_vsop87 = {march_equinox_vsop87};
 
-int hebrew_delay_2(int year)
+static struct
 {
-    int last, present, next;
+    dc_ephemeris_t kind;
+    const ephemeris_backend_t *primary;  // Decides the equinox
+    const ephemeris_backend_t *refine;   // Replaces it within margin of a day boundary, or NULL
+    double margin;                       // Days
+} ephemeris = {DC_EPHEM_MEEUS, &ephemeris_meeus, NULL, DC_EPHEM_MARGIN};
 
-    last = hebrew_delay_1(year - 1);
-    present = hebrew_delay_1(year);
-    next = hebrew_delay_1(year + 1);
+// NEAR_DAY_BOUNDARY: Does a Julian day and fraction lie within margin days of a day boundary?
 
-    return ((next - present) == 356) ? 2 : (((present - last) == 382) ? 1 : 0);
+static inline int near_day_boundary(double jd, double margin)
+{
+    return (jd - floor(jd)) <= margin || (ceil(jd) - jd) <= margin;
 }
 
-// How many months are there in a Hebrew year (12 = normal, 13 = leap)
+/* DC_SET_EPHEMERIS  --  Select the ephemeris behind the March equinoxes
+                         of the astronomical solar Hijri calendars, and
+                         for DC_EPHEM_AUTO the margin (days) within
+                         which the short series defers to VSOP87;
+                         margin <= 0 selects DC_EPHEM_MARGIN.  Not
+                         thread-safe: select before converting dates,
+                         and re-initialize solar_hijri_init() contexts
+                         that cached days under the previous one. */
 
-int hebrew_year_months(int year)
+void dc_set_ephemeris(dc_ephemeris_t kind, double margin)
 {
-    return leap_hebrew(year) ? 13 : 12;
+    ephemeris.kind = kind;
+    ephemeris.primary = (kind == DC_EPHEM_VSOP87) ? &ephemeris_vsop87 : &ephemeris_meeus;
+    ephemeris.refine = (kind == DC_EPHEM_AUTO) ? &ephemeris_vsop87 : NULL;
+    ephemeris.margin = (margin > 0) ? margin : DC_EPHEM_MARGIN;
+
+    memset(tehran_ctx.equinox_jd, 0, sizeof(tehran_ctx.equinox_jd));
+    memset(kabul_ctx.equinox_jd, 0, sizeof(kabul_ctx.equinox_jd));
+    year_cache_drop(DC_PER);
+    year_cache_drop(DC_PER_AF);
+    month_index_drop(DC_PER);
+    badi_table_drop();
 }
 
-const char *hebrew_month_name(int year, int month)
+dc_ephemeris_t dc_get_ephemeris(double *margin)
 {
-    if(month < 1 || month > 13)
-        return NULL;
-    static const char *adar_i = "Adar I";
-    static const char *hm_name[] = {"Nisan", "Iyar", "Sivan", "Tammuz", "Av", "Elul",
-                                    "Tishrei", "Cheshvan", "Kislev", "Tevet", "Shevat", "Adar", "Adar II"};
-    if(month == 12 && leap_hebrew(year))
-        return adar_i;
-    return hm_name[month - 1];
+    if(margin)
+        *margin = ephemeris.margin;
+    return ephemeris.kind;
 }
 
-// How many days are in a given month of a given year
+// MERIDIAN_EQUINOX_AT: Julian day and fraction at a reference meridian of the March equinox at a given JDE
 
-int hebrew_month_days(int year, int month)
+static double meridian_equinox_at(double equJED, int year, double meridian)
 {
-    if(month < 1 || month > 13)
-        return -1;  // ERROR: The month must be between 1-13
+    double equJD, equAPP;
 
-    switch(month)
-    {
-        case 2:
-        case 4:
-        case 6:
-        case 10:
-        case 13:
-            return 29;  // First of all, dispose of fixed-length 29 day months
-        case 8:
-            if(!(mod(hebrew_year_days(year), 10) == 5))
-                return 29;  // If it's Cheshvan, days depend on length of year
-            break;
-        case 9:
-            if(mod(hebrew_year_days(year), 10) == 3)
-                return 29;  // Similarly, Kislev varies with the length of year
-            break;
-        case 12:
-            if(!leap_hebrew(year))
-                return 29;  // If it's not a leap year, Adar has 29 days
-            break;
-    }
+    // Correct for delta T to obtain Universal time
+    equJD = equJED - (deltat(year) / (24 * 60 * 60));
 
-    return 30;  // Nope, it's a 30 day month
+    // Apply the equation of time to yield the apparent time at Greenwich
+    equAPP = equJD + equationOfTime(equJED);
+
+    /* Finally, we must correct for the constant difference between
+       the Greenwich meridian and the reference meridian. */
+
+    return equAPP + (meridian / 360);
 }
 
-// HEBREW_TO_JD: Determine Julian day from Hebrew date
+/* MERIDIAN_EQUINOX  --  Determine Julian day and fraction of the
+                         March equinox at a given reference meridian
+                         (degrees east of Greenwich) in a given
+                         Gregorian year, from the selected ephemeris. */
 
-double hebrew_to_jd(int year, int month, int day)
+double meridian_equinox(int year, double meridian)
 {
-    double jd;
-    int mon, months;
+    double eq;
 
-    months = hebrew_year_months(year);
-    jd = HEBREW_EPOCH + hebrew_delay_1(year) + hebrew_delay_2(year) + day + 1;
-
-    if(month < 7)
-    {
-        for(mon = 7; mon <= months; mon++)
-            jd += hebrew_month_days(year, mon);
-        for(mon = 1; mon < month; mon++)
-            jd += hebrew_month_days(year, mon);
-    }
-    else
-    {
-        for(mon = 7; mon < month; mon++)
-            jd += hebrew_month_days(year, mon);
-    }
+    eq = meridian_equinox_at(ephemeris.primary->march_equinox(year), year, meridian);
+    if(ephemeris.refine && near_day_boundary(eq, ephemeris.margin))
+        eq = meridian_equinox_at(ephemeris.refine->march_equinox(year), year, meridian);
 
-    return jd;
+    return eq;
 }
 
-/* JD_TO_HEBREW  --  Convert Julian date to Hebrew date
-                     This works by making multiple calls to
-                     the inverse function, and is this very
-                     slow. */
+// MERIDIAN_EQUINOX_REDUCED: Reduced-precision counterpart of meridian_equinox()
 
-void jd_to_hebrew(double jd, int *year, int *month, int *day)
+double meridian_equinox_reduced(int year, double meridian)
 {
-    int i, count, first;
+    double equJED;
 
-    jd = floor(jd) + 0.5;
-    count = (int)floor(((jd - HEBREW_EPOCH) * 98496.0) / 35975351.0);
+    equJED = equinox_reduced(year);
+    return (equJED - (deltat(year) / (24 * 60 * 60))) + equationOfTime_reduced(equJED) + (meridian / 360);
+}
 
-    *year = count - 1;
-    for(i = count; jd >= hebrew_to_jd(i, 7, 1); i++)
-        (*year)++;
+/* EQUINOX_DAY  --  Julian day during which the March equinox,
+                    reckoned from a given meridian, occurs.  In
+                    reduced precision the cheap estimate of the short
+                    series decides the day unless it falls within its
+                    error bound (plus the ephemeris margin in
+                    DC_EPHEM_AUTO) of a day boundary, in which case
+                    the full double evaluation is used. */
 
-    first = (jd < hebrew_to_jd(*year, 1, 1)) ? 7 : 1;
-    *month = first;
-    for(i = first; jd > hebrew_to_jd(*year, i, hebrew_month_days(*year, i)); i++)
-        (*month)++;
+double equinox_day(int year, double meridian)
+{
+    double eq;
 
-    *day = (int)(jd - hebrew_to_jd(*year, *month, 1)) + 1;
+    if(astro_precision == DC_ASTRO_REDUCED && ephemeris.primary == &ephemeris_meeus &&
+       year >= DC_EQUINOX_CACHE_FIRST && year < DC_EQUINOX_CACHE_FIRST + DC_EQUINOX_CACHE_YEARS)
+    {
+        eq = meridian_equinox_reduced(year, meridian);
+        if(!near_day_boundary(eq, EQUINOX_REDUCED_ERROR + (ephemeris.refine ? ephemeris.margin : 0)))
+            return floor(eq);
+    }
+
+    return floor(meridian_equinox(year, meridian));
 }
 
-int *jd_to_hebrew_arr(double jd, int result_ymd[])
+/* TEHRAN_EQUINOX  --  Determine Julian day and fraction of the
+                       March equinox at the Tehran meridian in
+                       a given Gregorian year. */
+
+double tehran_equinox(int year)
 {
-    jd_to_hebrew(jd, &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    // Iran Standard time, 52°30' to the East.
+    return meridian_equinox(year, tehran_ctx.meridian);
 }
 
-// How many days are in a Hebrew year?
+/* TEHRAN_EQUINOX_JD  --  Calculate Julian day during which the
+                          March equinox, reckoned from the Tehran
+                          meridian, occurred for a given Gregorian
+                          year. */
 
-int hebrew_year_days(int year)
+double tehran_equinox_jd(int year)
 {
-    return (int)(hebrew_to_jd(year + 1, 7, 1) - hebrew_to_jd(year, 7, 1));
+    return solar_hijri_equinox_jd(&tehran_ctx, year);
 }
 
-// /////////////////////////////////    HEBREW CALENDAR     ///////////////////////////////// //
-// ****************************************************************************************** //
-// /////////////////////////////////    JULIAN CALENDAR     ///////////////////////////////// //
-
-// static const double JULIAN_EPOCH = 1721423.5;
+/* SOLAR_HIJRI_INIT  --  Prepare a solar Hijri calendar reckoned from
+                         the given meridian (degrees east of Greenwich).
+                         The context caches the equinox day of every
+                         Gregorian year in the DC_EQUINOX_CACHE_* window
+                         as it is first requested. */
 
-int leap_julian(int year)
+void solar_hijri_init(dc_solar_hijri_t *ctx, double meridian)
 {
-    return mod(year, 4) == ((year > 0) ? 0 : 3);
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->meridian = meridian;
 }
 
-// JULIAN_TO_JD: Determine Julian day number from Julian calendar date
+/* SOLAR_HIJRI_EQUINOX_JD  --  Calculate Julian day during which the
+                               March equinox, reckoned from the
+                               context's meridian, occurred for a
+                               given Gregorian year. */
 
-double julian_to_jd(int year, int month, int day)
+double solar_hijri_equinox_jd(dc_solar_hijri_t *ctx, int year)
 {
-    // Adjust negative common era years to the zero-based notation we use.
+    int i, eqjd;
 
-    if(year < 1)
-        year++;
+    i = year - DC_EQUINOX_CACHE_FIRST;
+    if(i < 0 || i >= DC_EQUINOX_CACHE_YEARS)
+    {
+        // The built-in calendars keep the other years in the shared cache
+        if(ctx != &tehran_ctx && ctx != &kabul_ctx)
+            return equinox_day(year, ctx->meridian);
+        if(!year_cache_get((ctx == &tehran_ctx) ? DC_PER : DC_PER_AF, year, &eqjd))
+        {
+            eqjd = (int)equinox_day(year, ctx->meridian);
+            year_cache_put((ctx == &tehran_ctx) ? DC_PER : DC_PER_AF, year, eqjd);
+        }
+        return eqjd;
+    }
+
+    if(!(eqjd = DC_LOAD_RELAXED(&ctx->equinox_jd[i])))
+    {
+        eqjd = (int)equinox_day(year, ctx->meridian);
+        DC_STORE_RELAXED(&ctx->equinox_jd[i], eqjd);
+    }
 
-    // Algorithm as given in Meeus, Astronomical Algorithms, Chapter 7, page 61
+    return eqjd;
+}
 
-    if(month <= 2)
+/* SOLAR_HIJRI_YEAR  --  Determine the year in the solar Hijri
+                         astronomical calendar in which a given
+                         Julian day falls.  Returns an array of
+                         two elements:
+
+                               [0]  Solar Hijri year
+                               [1]  Julian day number containing
+                                    equinox for this year.
+*/
+
+double *solar_hijri_year(dc_solar_hijri_t *ctx, double jd, double result[])
+{
+    double lasteq, nexteq, adr;
+    int guess;
+    int y, m, d;
+
+    jd_to_gregorian(jd, &y, &m, &d);
+    guess = y - 2;
+
+    lasteq = solar_hijri_equinox_jd(ctx, guess);
+    while(lasteq > jd)
     {
-        year--;
-        month += 12;
+        guess--;
+        lasteq = solar_hijri_equinox_jd(ctx, guess);
+    }
+
+    nexteq = lasteq - 1;
+    while(!((lasteq <= jd) && (jd < nexteq)))
+    {
+        lasteq = nexteq;
+        guess++;
+        nexteq = solar_hijri_equinox_jd(ctx, guess);
     }
+    adr = round((lasteq - PERSIAN_EPOCH) / TropicalYear) + 1;
+
+    result[0] = adr;
+    result[1] = lasteq;
 
-    return ((floor((365.25 * (year + 4716))) + floor((30.6001 * (month + 1))) + day) - 1524.5);
+    return result;
 }
 
-// JD_TO_JULIAN: Calculate Julian calendar date from Julian day
+/* SOLAR_HIJRI_TO_JD  --  Obtain Julian day from a given solar Hijri
+                          astronomical calendar date. */
 
-void jd_to_julian(double jd, int *year, int *month, int *day)
+double solar_hijri_to_jd(dc_solar_hijri_t *ctx, int year, int month, int day)
 {
-    double z, a, b, c, d, e;
+    double equinox, guess, jd;
+    double adr[2];
 
-    jd += 0.5;
-    z = floor(jd);
-    a = z;
-    b = a + 1524;
-    c = floor((b - 122.1) / 365.25);
-    d = floor(365.25 * c);
-    e = floor((b - d) / 30.6001);
+    /* The year starts on the equinox day of the Gregorian year 621
+       later; search for it only when the numbering of that equinox
+       by solar_hijri_year() disagrees. */
 
-    *month = (int)floor((e < 14) ? (e - 1) : (e - 13));
-    *year = (int)floor((*month > 2) ? (c - 4716) : (c - 4715));
-    *day = (int)(b - d - floor(30.6001 * e));
+    equinox = solar_hijri_equinox_jd(ctx, year + 621);
+    if(round((equinox - PERSIAN_EPOCH) / TropicalYear) + 1 != year)
+    {
+        guess = (PERSIAN_EPOCH - 1) + (TropicalYear * ((year - 1) - 1));
+        adr[0] = year - 1;
+        adr[1] = 0;
 
-    /* If year is less than 1, subtract one to convert from
-       a zero based date system to the common era system in
-       which the year -1 (1 B.C.E) is followed by year 1 (1 C.E.). */
+        while(adr[0] < year)
+            guess = solar_hijri_year(ctx, guess, adr)[1] + (TropicalYear + 2);
+        equinox = adr[1];
+    }
 
-    if(*year < 1)
-        (*year)--;
+    jd = equinox + ((month <= 7) ? ((month - 1) * 31) : (((month - 1) * 30) + 6)) + (day - 1) + 0.5;
+    return jd;
 }
 
-int *jd_to_julian_arr(double jd, int result_ymd[])
+/* JD_TO_SOLAR_HIJRI  --  Calculate date in the solar Hijri
+                          astronomical calendar from Julian day. */
+
+void jd_to_solar_hijri(dc_solar_hijri_t *ctx, double jd, int *year, int *month, int *day)
 {
-    jd_to_julian(jd, &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    double equinox, yday;
+    double adr[2];
+
+    jd = floor(jd) + 0.5;
+    *year = (int)solar_hijri_year(ctx, jd, adr)[0];
+    equinox = adr[1];
+
+    /* The year's first day starts at the equinox day, so the month
+       and day follow from the offset without another year search. */
+
+    yday = (floor(jd) - equinox) + 1;
+    *month = (int)((yday <= 186) ? ceil(yday / 31) : ceil((yday - 6) / 30));
+    *day = (int)(yday - ((*month <= 7) ? ((*month - 1) * 31) : (((*month - 1) * 30) + 6)));
 }
 
-const char *julian_month_name(int month)
+/* LEAP_SOLAR_HIJRI  --  Is a given year a leap year in the solar
+                         Hijri astronomical calendar? */
+
+int leap_solar_hijri(dc_solar_hijri_t *ctx, int year)
 {
-    return gregorian_month_name(month);
+    return (solar_hijri_to_jd(ctx, year + 1, 1, 1) - solar_hijri_to_jd(ctx, year, 1, 1)) > 365;
 }
 
-int julian_month_days(int year, int month)
+int solar_hijri_month_days(dc_solar_hijri_t *ctx, int year, int month)
 {
     switch(month)
     {
         case 1:
+        case 2:
         case 3:
+        case 4:
         case 5:
+        case 6:
+            return 31;
         case 7:
         case 8:
-        case 10:
-        case 12:
-            return 31;
-        case 4:
-        case 6:
         case 9:
+        case 10:
         case 11:
             return 30;
-        case 2:
+        case 12:
             break;
         default:
             return -1;  // ERROR: The month must be between 1-12
     }
 
-    return leap_julian(year) ? 29 : 28;
+    return leap_solar_hijri(ctx, year) ? 30 : 29;
 }
 
-// /////////////////////////////////    JULIAN CALENDAR     ///////////////////////////////// //
-// ****************************************************************************************** //
+/* PERSIAN_YEAR  --  Determine the year in the Persian
+                     astronomical calendar in which a
+                     given Julian day falls.  Returns an
+                     array of two elements:
 
-typedef enum DC_CalendarType {DC_PER, DC_GRE, DC_ISM, DC_HEB, DC_JUL, DC_PER_B} dc_calendar_t;
+                           [0]  Persian year
+                           [1]  Julian day number containing
+                                equinox for this year.
+*/
 
-const char *weekday_str(int i)
+double *persian_year(double jd, double result[])
 {
-    static const char *weekdays[] = {"Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"};
-    return weekdays[abs(i) % 7];
+    return solar_hijri_year(&tehran_ctx, jd, result);
 }
 
-int weekday_jd(double jd)
-{
-    return jwday(jd);
-}
+/* PERSIAN_TO_JD  --  Obtain Julian day from a given Persian
+                      astronomical calendar date. */
 
-const char *weekday_jd_str(double jd)
+double persian_to_jd(int year, int month, int day)
 {
-    return weekday_str(weekday_jd(jd));
+    return solar_hijri_to_jd(&tehran_ctx, year, month, day);
 }
 
-int weekday_ymd(int year, int month, int day, dc_calendar_t calendar_type)
+/* JD_TO_PERSIAN  --  Calculate date in the Persian astronomical
+                      calendar from Julian day. */
+
+void jd_to_persian(double jd, int *year, int *month, int *day)
 {
-    double jd;
-    switch(calendar_type)
-    {
-        case DC_PER: jd = persian_to_jd(year, month, day); break;
-        case DC_ISM: jd = islamic_to_jd(year, month, day); break;
-        case DC_HEB: jd = hebrew_to_jd(year, month, day); break;
-        case DC_JUL: jd = julian_to_jd(year, month, day); break;
-        case DC_PER_B: jd = persianb_to_jd(year, month, day); break;
-        default: jd = gregorian_to_jd(year, month, day); break;
-    }
-    return weekday_jd(jd);
+    if(!month_index_ymd(DC_PER, jd, year, month, day))
+        jd_to_solar_hijri(&tehran_ctx, jd, year, month, day);
 }
 
-const char *weekday_ymd_str(int year, int month, int day, dc_calendar_t calendar_type)
+int *jd_to_persian_arr(double jd, int result_ymd[])
 {
-    return weekday_str(weekday_ymd(year, month, day, calendar_type));
+    jd_to_persian(jd, &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
 }
 
-// check_date_ldom() returns:
-// 0: Successful
-// 1: Error: Select the type of the calendar correctly.
-// 2: Error: Enter the year correctly (between -81739 and 213719).
-// 3: Error: This calendar has no year zero (0).
-// 4: Error: Enter the month correctly (between 1 and 12).
-// 5: Error: Enter the month correctly (between 1 and 13).
-// 6: Error: This year doesn't have 13 months (in Hebrew calendar).
-// 7: Error: Enter the day correctly (greater than 0).
-// 8: Error: This month of this year has *last_day_of_month days.
-// 9: Error: This month has *last_day_of_month days.
+/* LEAP_PERSIAN  --  Is a given year a leap year in the Persian
+                     astronomical calendar? */
 
-int check_date_ldom(int year, int month, int day, dc_calendar_t calendar_type, int *last_day_of_month)
+int leap_persian(int year)
 {
-    int hym = 0;
-
-    *last_day_of_month = 0;
-
-    switch(calendar_type)
-    {
-        case DC_PER:
-        case DC_GRE:
-        case DC_ISM:
-        case DC_HEB:
-        case DC_JUL:
-        case DC_PER_B:
-            break;
-        default:
-            return 1;  // 1: Error: Select the type of the calendar correctly.
-    }
+    return leap_solar_hijri(&tehran_ctx, year);
+}
 
-    if(year < -81739 || year > 213719)
-        return 2;  // 2: Error: Enter the year correctly (between -81739 and 213719).
+#else
 
-    if(year == 0 && (calendar_type == DC_PER_B || calendar_type == DC_JUL))
-        return 3;  // 3: Error: This calendar has no year zero (0).
+/* The astronomical Persian calendar of the embedded profile: the
+   years DC_PERSIAN_TABLE_FIRST to DC_PERSIAN_TABLE_LAST as calculated
+   by the full library, kept as the day number of the first Farvardin
+   of the first year and one leap bit per year.  Dates outside the
+   table convert to Julian day 0 and to the date 0/0/0, and
+   check_date() rejects their years. */
 
-    switch(calendar_type)
-    {
-        case DC_PER:
-        case DC_GRE:
-        case DC_ISM:
-        case DC_JUL:
-        case DC_PER_B:
-            if(month < 1 || month > 12)
-                return 4;  // 4: Error: Enter the month correctly (between 1 and 12).
-            break;
-        case DC_HEB:
-            hym = hebrew_year_months(year);
-            if(month == 13)
-            {
-                if(month != hym)
-                    return 6;  // 6: Error: This year doesn't have 13 months (in Hebrew calendar).
-            }
-            else if(month < 1 || month > 13)
-            {
-                if(hym == 13)
-                    return 5;  // 5: Error: Enter the month correctly (between 1 and 13).
-                else
-                    return 4;  // 4: Error: Enter the month correctly (between 1 and 12).
-            }
-            break;
-    }
+static int persian_table_has(int year)
+{
+    return year >= DC_PERSIAN_TABLE_FIRST && year <= DC_PERSIAN_TABLE_LAST;
+}
 
-    if(day < 1)
-        return 7;  // 7: Error: Enter the day correctly (greater than 0).
+// PERSIAN_TABLE_START: Julian day number of 1 Farvardin of a year of the table, or of the year after it
 
-    switch(calendar_type)
-    {
-        case DC_PER:
-            *last_day_of_month = persian_month_days(year, month);
-            if(month == 12 && day > *last_day_of_month)
-                return 8;  // 8: Error: This month of this year has *last_day_of_month days.
-            break;
-        case DC_GRE:
-            *last_day_of_month = gregorian_month_days(year, month);
-            if(month == 2 && day > *last_day_of_month)
-                return 8;  // 8: Error: This month of this year has *last_day_of_month days.
-            break;
-        case DC_ISM:
-            *last_day_of_month = islamic_month_days(year, month);
-            if(day > *last_day_of_month)
-                return 8;  // 8: Error: This month of this year has *last_day_of_month days.
-            break;
-        case DC_HEB:
-            *last_day_of_month = hebrew_month_days(year, month);
-            if((month == 8 || month == 9 || month == 12 ) && day > *last_day_of_month)
-                return 8;  // 8: Error: This month of this year has *last_day_of_month days.
-            break;
-        case DC_JUL:
-            *last_day_of_month = julian_month_days(year, month);
-            if(month == 2 && day > *last_day_of_month)
-                return 8;  // 8: Error: This month of this year has *last_day_of_month days.
-            break;
-        case DC_PER_B:
-            *last_day_of_month = persianb_month_days(year, month);
-            if(month == 12 && day > *last_day_of_month)
-                return 8;  // 8: Error: This month of this year has *last_day_of_month days.
-            break;
-    }
+static int persian_table_start(int year)
+{
+    unsigned char bits;
+    int i, n, leaps;
 
-    if(day > *last_day_of_month)
-        return 9;  // 9: Error: This month has *last_day_of_month days.
+    n = year - DC_PERSIAN_TABLE_FIRST;
+    leaps = 0;
+    for(i = 0; i < (n >> 3); i++)
+        for(bits = persian_table_leap[i]; bits; bits &= bits - 1)
+            leaps++;
+    for(bits = persian_table_leap[n >> 3] & ((1u << (n & 7)) - 1); bits; bits &= bits - 1)
+        leaps++;
 
-    return 0;  // 0: Successful
+    return DC_PERSIAN_TABLE_START + (365 * n) + leaps;
 }
 
-int check_date_ldom_str(int year, int month, int day, dc_calendar_t calendar_type, int *last_day_of_month, char **error_str)
+double persian_to_jd(int year, int month, int day)
 {
-    int error_code;
+    if(!persian_table_has(year))
+        return 0;  // ERROR: The year is outside the table
 
-    if(!(error_code = check_date_ldom(year, month, day, calendar_type, last_day_of_month)))
-    {
-        *error_str = NULL;
-        return error_code;  // 0: Successful
-    }
+    return persian_table_start(year) + ((month <= 7) ? ((month - 1) * 31) : (((month - 1) * 30) + 6)) + (day - 1) - 0.5;
+}
 
-    const char *error_msg = NULL;
-    static const char *e1 = "Error: Select the type of the calendar correctly.";
-    static const char *e2 = "Error: Enter the year correctly (between -81739 and 213719).";
-    static const char *e3 = "Error: This calendar has no year zero (0).";
-    static const char *e4 = "Error: Enter the month correctly (between 1 and 12).";
-    static const char *e5 = "Error: Enter the month correctly (between 1 and 13).";
-    static const char *e6 = "Error: This year doesn't have 13 months (in Hebrew calendar).";
-    static const char *e7 = "Error: Enter the day correctly (greater than 0).";
-    static const char *e8 = "Error: This month of this year has dd days.";
-    static const char *e9 = "Error: This month has dd days.";
+void jd_to_persian(double jd, int *year, int *month, int *day)
+{
+    int jdn, y, m, start, yday;
 
-    switch(error_code)
-    {
-        case 1: error_msg = e1; break;
-        case 2: error_msg = e2; break;
-        case 3: error_msg = e3; break;
-        case 4: error_msg = e4; break;
-        case 5: error_msg = e5; break;
-        case 6: error_msg = e6; break;
-        case 7: error_msg = e7; break;
-        case 8: error_msg = e8; break;
-        case 9: error_msg = e9; break;
-    }
+    *year = *month = *day = 0;
 
-    if(!(*error_str = (char *)malloc((strlen(error_msg) + 1) * sizeof(char))))
-        return error_code;
+    jdn = jd_floor(jd) + 1;
+    if(jdn < DC_PERSIAN_TABLE_START || jdn >= persian_table_start(DC_PERSIAN_TABLE_LAST + 1))
+        return;  // ERROR: The day is outside the table
 
-    // strcpy(*error_str, error_msg);
-    str_copy_unsafe(*error_str, error_msg);
+    // A year of 366 days never overshoots; step forward to the year holding the day
+    y = DC_PERSIAN_TABLE_FIRST + (jdn - DC_PERSIAN_TABLE_START) / 366;
+    while(y < DC_PERSIAN_TABLE_LAST && persian_table_start(y + 1) <= jdn)
+        y++;
 
-    if(error_code == 8)
-    {
-        (*error_str)[35] = '0' + *last_day_of_month / 10;
-        (*error_str)[36] = '0' + *last_day_of_month % 10;
-    }
-    else if(error_code == 9)
-    {
-        (*error_str)[22] = '0' + *last_day_of_month / 10;
-        (*error_str)[23] = '0' + *last_day_of_month % 10;
-    }
+    start = persian_table_start(y);
+    yday = (jdn - start) + 1;
+    m = (yday <= 186) ? ceil_div(yday, 31) : ceil_div(yday - 6, 30);
 
-    return error_code;
+    *year = y;
+    *month = m;
+    *day = yday - ((m <= 7) ? ((m - 1) * 31) : (((m - 1) * 30) + 6));
 }
 
-int check_date_str(int year, int month, int day, dc_calendar_t calendar_type, char **error_str)
+int *jd_to_persian_arr(double jd, int result_ymd[])
 {
-    int last_day_of_month;
-    return check_date_ldom_str(year, month, day, calendar_type, &last_day_of_month, error_str);
+    jd_to_persian(jd, &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
 }
 
-int check_date(int year, int month, int day, dc_calendar_t calendar_type)
+int leap_persian(int year)
 {
-    int last_day_of_month;
-    return check_date_ldom(year, month, day, calendar_type, &last_day_of_month);
+    int n = year - DC_PERSIAN_TABLE_FIRST;
+    return persian_table_has(year) && ((persian_table_leap[n >> 3] >> (n & 7)) & 1);
 }
 
-const char *norm_leap_str(int is_leap_year)
+int persian_month_days(int year, int month)
 {
-    static const char *nl[] = {"Normal Year", "Leap Year"};
-    return nl[!!is_leap_year];
+    if(month < 1 || month > 12 || !persian_table_has(year))
+        return -1;  // ERROR: The month must be between 1-12, in a year of the table
+
+    return (month <= 6) ? 31 : ((month <= 11) ? 30 : (leap_persian(year) ? 30 : 29));
 }
 
-// ****************************************************************************************** //
+#endif  // DC_EMBEDDED
 
-void persian_to_gregorian(int *year, int *month, int *day)
+const char *persian_month_name(int month)
 {
-    jd_to_gregorian(persian_to_jd(*year, *month, *day), year, month, day);
+    if(month < 1 || month > 12)
+        return NULL;
+    static const char *pm_name[] = {"Farvardin", "Ordibehesht", "Khordad", "Tir", "Mordad", "Shahrivar",
+                                    "Mehr", "Aban", "Azar", "Dey", "Bahman", "Esfand"};
+    return pm_name[month - 1];
 }
 
-void persian_to_islamic(int *year, int *month, int *day)
+#ifndef DC_EMBEDDED
+
+int persian_month_days(int year, int month)
 {
-    jd_to_islamic(persian_to_jd(*year, *month, *day), year, month, day);
+    return solar_hijri_month_days(&tehran_ctx, year, month);
 }
 
-void persian_to_hebrew(int *year, int *month, int *day)
+/* AFGHAN_TO_JD  --  Obtain Julian day from a given date in the
+                     solar Hijri calendar of Afghanistan, whose
+                     equinox is reckoned from the Kabul meridian. */
+
+double afghan_to_jd(int year, int month, int day)
 {
-    jd_to_hebrew(persian_to_jd(*year, *month, *day), year, month, day);
+    return solar_hijri_to_jd(&kabul_ctx, year, month, day);
 }
 
-void persian_to_julian(int *year, int *month, int *day)
+/* JD_TO_AFGHAN  --  Calculate date in the solar Hijri calendar
+                     of Afghanistan from Julian day. */
+
+void jd_to_afghan(double jd, int *year, int *month, int *day)
 {
-    jd_to_julian(persian_to_jd(*year, *month, *day), year, month, day);
+    jd_to_solar_hijri(&kabul_ctx, jd, year, month, day);
 }
 
-void persian_to_persianb(int *year, int *month, int *day)
+int *jd_to_afghan_arr(double jd, int result_ymd[])
 {
-    jd_to_persianb(persian_to_jd(*year, *month, *day), year, month, day);
+    jd_to_afghan(jd, &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
 }
 
-void gregorian_to_persian(int *year, int *month, int *day)
+int leap_afghan(int year)
 {
-    jd_to_persian(gregorian_to_jd(*year, *month, *day), year, month, day);
+    return leap_solar_hijri(&kabul_ctx, year);
 }
 
-void gregorian_to_islamic(int *year, int *month, int *day)
+const char *afghan_month_name(int month)
 {
-    jd_to_islamic(gregorian_to_jd(*year, *month, *day), year, month, day);
+    if(month < 1 || month > 12)
+        return NULL;
+    static const char *am_name[] = {"Hamal", "Sawr", "Jawza", "Saratan", "Asad", "Sonbola",
+                                    "Mizan", "Aqrab", "Qaws", "Jadi", "Dalw", "Hut"};
+    return am_name[month - 1];
 }
 
-void gregorian_to_hebrew(int *year, int *month, int *day)
+int afghan_month_days(int year, int month)
 {
-    jd_to_hebrew(gregorian_to_jd(*year, *month, *day), year, month, day);
+    return solar_hijri_month_days(&kabul_ctx, year, month);
 }
 
-void gregorian_to_julian(int *year, int *month, int *day)
-{
-    jd_to_julian(gregorian_to_jd(*year, *month, *day), year, month, day);
-}
+// PERSIANB_TO_JD: Determine Julian day from Birashk's Persian date
 
-void gregorian_to_persianb(int *year, int *month, int *day)
+double persianb_to_jd(int year, int month, int day)
 {
-    jd_to_persianb(gregorian_to_jd(*year, *month, *day), year, month, day);
-}
+    double epbase, epyear;
 
-void islamic_to_persian(int *year, int *month, int *day)
-{
-    jd_to_persian(islamic_to_jd(*year, *month, *day), year, month, day);
-}
+    epbase = year - ((year >= 0) ? 474 : 473);
+    epyear = 474 + mod(epbase, 2820);
 
-void islamic_to_gregorian(int *year, int *month, int *day)
-{
-    jd_to_gregorian(islamic_to_jd(*year, *month, *day), year, month, day);
+    return day + ((month <= 7) ? ((month - 1) * 31) : (((month - 1) * 30) + 6)) +
+           floor(((epyear * 682) - 110) / 2816) + (epyear - 1) * 365 + floor(epbase / 2820) * 1029983 +
+           (PERSIAN_EPOCH - 1);
 }
 
-void islamic_to_hebrew(int *year, int *month, int *day)
-{
-    jd_to_hebrew(islamic_to_jd(*year, *month, *day), year, month, day);
-}
+#endif
 
-void islamic_to_julian(int *year, int *month, int *day)
-{
-    jd_to_julian(islamic_to_jd(*year, *month, *day), year, month, day);
-}
+// PERSIANB_TO_JDN: persianb_to_jd() on integers, for a date within DC_JDN_YMD_OK()
 
-void islamic_to_persianb(int *year, int *month, int *day)
+static int persianb_to_jdn(int year, int month, int day)
 {
-    jd_to_persianb(islamic_to_jd(*year, *month, *day), year, month, day);
-}
+    int epbase, epyear;
 
-void hebrew_to_persian(int *year, int *month, int *day)
-{
-    jd_to_persian(hebrew_to_jd(*year, *month, *day), year, month, day);
-}
+    epbase = year - ((year >= 0) ? 474 : 473);
+    epyear = 474 + floor_mod(epbase, 2820);
 
-void hebrew_to_gregorian(int *year, int *month, int *day)
-{
-    jd_to_gregorian(hebrew_to_jd(*year, *month, *day), year, month, day);
+    return day + ((month <= 7) ? ((month - 1) * 31) : (((month - 1) * 30) + 6)) +
+           floor_div((epyear * 682) - 110, 2816) + (epyear - 1) * 365 + floor_div(epbase, 2820) * 1029983 + 1948320;
 }
 
-void hebrew_to_islamic(int *year, int *month, int *day)
-{
-    jd_to_islamic(hebrew_to_jd(*year, *month, *day), year, month, day);
-}
+// JDN_TO_PERSIANB: jd_to_persianb() on integers, with the start of the year computed once
 
-void hebrew_to_julian(int *year, int *month, int *day)
+static void jdn_to_persianb(int jdn, int *year, int *month, int *day)
 {
-    jd_to_julian(hebrew_to_jd(*year, *month, *day), year, month, day);
-}
+    int depoch, cycle, cyear, ycycle, aux1, aux2, y, m, start, yday;
 
-void hebrew_to_persianb(int *year, int *month, int *day)
-{
-    jd_to_persianb(hebrew_to_jd(*year, *month, *day), year, month, day);
-}
+    depoch = jdn - persianb_to_jdn(475, 1, 1);
+    cycle = floor_div(depoch, 1029983);
+    cyear = depoch - (cycle * 1029983);
+    if(cyear == 1029982)
+    {
+        ycycle = 2820;
+    }
+    else
+    {
+        aux1 = cyear / 366;
+        aux2 = cyear % 366;
+        ycycle = (((2134 * aux1) + (2816 * aux2) + 2815) / 1028522) + aux1 + 1;
+    }
 
-void julian_to_persian(int *year, int *month, int *day)
-{
-    jd_to_persian(julian_to_jd(*year, *month, *day), year, month, day);
-}
+    y = ycycle + (2820 * cycle) + 474;
+    if(y <= 0)
+        y--;
 
-void julian_to_gregorian(int *year, int *month, int *day)
-{
-    jd_to_gregorian(julian_to_jd(*year, *month, *day), year, month, day);
+    start = persianb_to_jdn(y, 1, 1);
+    yday = (jdn - start) + 1;
+    m = (yday <= 186) ? ceil_div(yday, 31) : ceil_div(yday - 6, 30);
+
+    *year = y;
+    *month = m;
+    *day = yday - ((m <= 7) ? ((m - 1) * 31) : (((m - 1) * 30) + 6));
 }
 
-void julian_to_islamic(int *year, int *month, int *day)
+#ifndef DC_EMBEDDED
+
+// JD_TO_PERSIANB: Calculate Birashk's Persian date from Julian day
+
+void jd_to_persianb(double jd, int *year, int *month, int *day)
 {
-    jd_to_islamic(julian_to_jd(*year, *month, *day), year, month, day);
+    double depoch, cycle, cyear, ycycle, aux1, aux2, yday;
+
+    if(DC_JDN_JD_OK(jd))
+    {
+        jdn_to_persianb((int)floor(jd) + 1, year, month, day);
+        return;
+    }
+
+    jd = floor(jd) + 0.5;
+
+    depoch = jd - persianb_to_jd(475, 1, 1);
+    cycle = floor(depoch / 1029983);
+    cyear = mod(depoch, 1029983);
+    if(cyear == 1029982)
+    {
+        ycycle = 2820;
+    }
+    else
+    {
+        aux1 = floor(cyear / 366);
+        aux2 = mod(cyear, 366);
+        ycycle = floor(((2134 * aux1) + (2816 * aux2) + 2815) / 1028522) + aux1 + 1;
+    }
+
+    *year = (int)(ycycle + (2820 * cycle) + 474);
+    if(*year <= 0)
+        (*year)--;
+
+    yday = (jd - persianb_to_jd(*year, 1, 1)) + 1;
+    *month = (int)((yday <= 186) ? ceil(yday / 31) : ceil((yday - 6) / 30));
+    *day = (int)(jd - persianb_to_jd(*year, *month, 1)) + 1;
 }
 
-void julian_to_hebrew(int *year, int *month, int *day)
+#else
+
+// PERSIANB_TO_JD, JD_TO_PERSIANB: The integer paths alone, for dates within DC_JDN_YMD_OK()
+
+double persianb_to_jd(int year, int month, int day)
 {
-    jd_to_hebrew(julian_to_jd(*year, *month, *day), year, month, day);
+    return persianb_to_jdn(year, month, day) - 0.5;
 }
 
-void julian_to_persianb(int *year, int *month, int *day)
+void jd_to_persianb(double jd, int *year, int *month, int *day)
 {
-    jd_to_persianb(julian_to_jd(*year, *month, *day), year, month, day);
+    jdn_to_persianb(jd_floor(jd) + 1, year, month, day);
 }
 
-void persianb_to_persian(int *year, int *month, int *day)
+#endif  // DC_EMBEDDED
+
+int *jd_to_persianb_arr(double jd, int result_ymd[])
 {
-    jd_to_persian(persianb_to_jd(*year, *month, *day), year, month, day);
+    jd_to_persianb(jd, &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
 }
 
-void persianb_to_gregorian(int *year, int *month, int *day)
+// LEAP_PERSIANB: Is a given year a leap year in the Birashk's Persian calendar?
+
+int leap_persianb(int year)
 {
-    jd_to_gregorian(persianb_to_jd(*year, *month, *day), year, month, day);
+    int y1, y2, m1, m2, d1, d2;
+
+    jd_to_gregorian(persianb_to_jd(year, 12, 30), &y1, &m1, &d1);
+    jd_to_gregorian(persianb_to_jd((year + 1), 1, 1), &y2, &m2, &d2);
+
+    // return !((d1 == d2) && (m1 == m2) && (y1 == y2));
+    return (d1 != d2) || (m1 != m2) || (y1 != y2);
 }
 
-void persianb_to_islamic(int *year, int *month, int *day)
+int leap_persianb2(int year)
 {
-    jd_to_islamic(persianb_to_jd(*year, *month, *day), year, month, day);
+    return ((((((year - ((year > 0) ? 474 : 473)) % 2820) + 474) + 38) * 682) % 2816) < 682;
 }
 
-void persianb_to_hebrew(int *year, int *month, int *day)
+const char *persianb_month_name(int month)
 {
-    jd_to_hebrew(persianb_to_jd(*year, *month, *day), year, month, day);
+    return persian_month_name(month);
 }
 
-void persianb_to_julian(int *year, int *month, int *day)
+int persianb_month_days(int year, int month)
 {
-    jd_to_julian(persianb_to_jd(*year, *month, *day), year, month, day);
+    switch(month)
+    {
+        case 1:
+        case 2:
+        case 3:
+        case 4:
+        case 5:
+        case 6:
+            return 31;
+        case 7:
+        case 8:
+        case 9:
+        case 10:
+        case 11:
+            return 30;
+        case 12:
+            break;
+        default:
+            return -1;  // ERROR: The month must be between 1-12
+    }
+
+    return leap_persianb(year) ? 30 : 29;
 }
 
+// /////////////////////////////////    PERSIAN CALENDAR    ///////////////////////////////// //
 // ****************************************************************************************** //
+// /////////////////////////////////    ISLAMIC CALENDAR    ///////////////////////////////// //
 
-int *persian_to_gregorian_arr(int year, int month, int day, int result_ymd[])
-{
-    jd_to_gregorian(persian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
-}
+#ifndef DC_EMBEDDED
+static const double ISLAMIC_EPOCH = 1948439.5;
+#endif
 
-int *persian_to_islamic_arr(int year, int month, int day, int result_ymd[])
-{
-    jd_to_islamic(persian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
-}
+// ISLAMIC_TO_JDN: islamic_to_jd() on integers, for a date within DC_JDN_YMD_OK()
 
-int *persian_to_hebrew_arr(int year, int month, int day, int result_ymd[])
+static int islamic_to_jdn(int year, int month, int day)
 {
-    jd_to_hebrew(persian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    return day + ceil_div(59 * (month - 1), 2) + (year - 1) * 354 + floor_div(3 + (11 * year), 30) + 1948439;
 }
 
-int *persian_to_julian_arr(int year, int month, int day, int result_ymd[])
+// JDN_TO_ISLAMIC: jd_to_islamic() on integers, with the start of the year computed once
+
+static void jdn_to_islamic(int jdn, int *year, int *month, int *day)
 {
-    jd_to_julian(persian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    long long x = 30LL * (jdn - 1948440) + 10646;
+    int y, m, start;
+
+    y = (int)((x >= 0) ? x / 10631 : -((10630 - x) / 10631));
+    start = islamic_to_jdn(y, 1, 1);
+    m = ceil_div(2 * (jdn - 29 - start), 59) + 1;
+    m = (m < 12) ? m : 12;
+
+    *year = y;
+    *month = m;
+    *day = jdn - (start + ceil_div(59 * (m - 1), 2)) + 1;
 }
 
-int *persian_to_persianb_arr(int year, int month, int day, int result_ymd[])
+#ifndef DC_EMBEDDED
+
+// JD_TO_ISLAMIC: Calculate Islamic date from Julian day
+
+void jd_to_islamic(double jd, int *year, int *month, int *day)
 {
-    jd_to_persianb(persian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    int tm;
+
+    if(DC_JDN_JD_OK(jd))
+    {
+        jdn_to_islamic((int)floor(jd) + 1, year, month, day);
+        return;
+    }
+
+    jd = floor(jd) + 0.5;
+    *year = (int)floor(((30 * (jd - ISLAMIC_EPOCH)) + 10646) / 10631);
+    tm = (int)ceil((jd - (29 + islamic_to_jd(*year, 1, 1))) / 29.5) + 1;
+    *month = (tm < 12) ? tm : 12;
+    *day = (int)(jd - islamic_to_jd(*year, *month, 1)) + 1;
 }
 
-int *gregorian_to_persian_arr(int year, int month, int day, int result_ymd[])
+#else
+
+// ISLAMIC_TO_JD, JD_TO_ISLAMIC: The integer paths alone, for dates within DC_JDN_YMD_OK()
+
+double islamic_to_jd(int year, int month, int day)
 {
-    jd_to_persian(gregorian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    return islamic_to_jdn(year, month, day) - 0.5;
 }
 
-int *gregorian_to_islamic_arr(int year, int month, int day, int result_ymd[])
+void jd_to_islamic(double jd, int *year, int *month, int *day)
 {
-    jd_to_islamic(gregorian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    jdn_to_islamic(jd_floor(jd) + 1, year, month, day);
 }
 
-int *gregorian_to_hebrew_arr(int year, int month, int day, int result_ymd[])
+#endif  // DC_EMBEDDED
+
+int *jd_to_islamic_arr(double jd, int result_ymd[])
 {
-    jd_to_hebrew(gregorian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    jd_to_islamic(jd, &result_ymd[0], &result_ymd[1], &result_ymd[2]);
     return result_ymd;
 }
 
-int *gregorian_to_julian_arr(int year, int month, int day, int result_ymd[])
+const char *islamic_month_name(int month)
 {
-    jd_to_julian(gregorian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    if(month < 1 || month > 12)
+        return NULL;
+    static const char *im_name[] = {"Muharram", "Safar", "Rabi' al-Awwal", "Rabi' al-Thani", "Jumada al-Awwal", "Jumada al-Thani",
+                                    "Rajab", "Sha'ban", "Ramadan", "Shawwal", "Dhu al-Qadah", "Dhu al-Hijjah"};
+    return im_name[month - 1];
 }
 
-int *gregorian_to_persianb_arr(int year, int month, int day, int result_ymd[])
-{
-    jd_to_persianb(gregorian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+// /////////////////////////////////    ISLAMIC CALENDAR    ///////////////////////////////// //
+#ifndef DC_EMBEDDED
+// ****************************************************************************************** //
+// /////////////////////////////////  UMM AL-QURA CALENDAR  ///////////////////////////////// //
+
+/* The Umm al-Qura calendar of Saudi Arabia is defined by published
+   tables rather than by arithmetic.  For the years 1300-1600 AH each
+   year is stored as a 12-bit mask (bit m-1 set when month m has 30
+   days) together with the offset of its first day from 1 Muharram
+   1300 AH.  Both edges of the table coincide with the tabular Islamic
+   calendar, which is used outside of it. */
+
+static const int UMMALQURA_FIRST_YEAR = 1300;
+static const int UMMALQURA_LAST_YEAR  = 1600;
+static const int UMMALQURA_EPOCH      = 2408762;  // Julian day number of 1 Muharram 1300 AH
+
+static const unsigned short ummalqura_months[] = {
+    0x555, 0x2ab, 0x937, 0x2b6, 0x576, 0x36c, 0xb55, 0xaaa, 0x956, 0x49e,  /* 1300-1309 */
+    0x95d, 0x2ba, 0x5b5, 0x3aa, 0xb4b, 0xa96, 0x52e, 0x2ad, 0x56d, 0xb5a,  /* 1310-1319 */
+    0x752, 0xf25, 0xe8a, 0xd16, 0xa56, 0xab5, 0x6b4, 0xda9, 0xb92, 0xb25,  /* 1320-1329 */
+    0x64b, 0xa9b, 0x35a, 0x6d9, 0x5d4, 0xda5, 0xd4a, 0xa95, 0x536, 0x975,  /* 1330-1339 */
+    0x2f4, 0x6e9, 0x6d4, 0x6a9, 0x535, 0x25d, 0x4bd, 0x9ba, 0x3b4, 0xb69,  /* 1340-1349 */
+    0xb2a, 0xa55, 0x4ad, 0xa5d, 0x2da, 0x6d9, 0xeaa, 0xe94, 0xd2a, 0xc56,  /* 1350-1359 */
+    0x4ae, 0xa6d, 0x56a, 0xd55, 0xd4a, 0xa93, 0x52b, 0xa5b, 0x53a, 0x6b5,  /* 1360-1369 */
+    0xea9, 0xd52, 0xd29, 0xa55, 0x4ad, 0x56d, 0xaea, 0x6e4, 0xed1, 0xda2,  /* 1370-1379 */
+    0xaaa, 0x95a, 0x2da, 0x5b9, 0xbb2, 0x764, 0x6c9, 0x555, 0x2ab, 0x4db,  /* 1380-1389 */
+    0xaba, 0x5b4, 0xda9, 0xd52, 0xaa5, 0x92d, 0x26d, 0x8ed, 0x2da, 0xad5,  /* 1390-1399 */
+    0xaa5, 0xa4b, 0x497, 0x937, 0x2b6, 0x975, 0xd69, 0xd52, 0xc95, 0x92b,  /* 1400-1409 */
+    0x25b, 0x4db, 0x9d5, 0x5d2, 0xda5, 0xd4a, 0xa95, 0x54d, 0xaad, 0x3aa,  /* 1410-1419 */
+    0xbd2, 0xbc4, 0xb89, 0xa95, 0x52d, 0x5ad, 0xb6a, 0x6d4, 0xdc9, 0xd92,  /* 1420-1429 */
+    0xaa6, 0x956, 0x2ae, 0x56d, 0x36a, 0xb55, 0xaaa, 0x94d, 0x49d, 0x95d,  /* 1430-1439 */
+    0x2ba, 0x5b5, 0x5aa, 0xd55, 0xa9a, 0x92e, 0x26e, 0x55d, 0xada, 0x6d4,  /* 1440-1449 */
+    0x6a5, 0xb27, 0xa4d, 0x4ad, 0x56d, 0xb5a, 0x754, 0xf49, 0xe92, 0xd26,  /* 1450-1459 */
+    0xa56, 0x356, 0x6b5, 0xbaa, 0xb92, 0xb25, 0x68b, 0xa9b, 0x55a, 0xada,  /* 1460-1469 */
+    0x5b4, 0xda9, 0xb52, 0xa9a, 0x536, 0x276, 0x575, 0xaf2, 0x6d4, 0x6a9,  /* 1470-1479 */
+    0x555, 0x2ad, 0x4bd, 0x9ba, 0x574, 0xb69, 0xb52, 0xa95, 0x52d, 0xa5d,  /* 1480-1489 */
+    0x4da, 0xad9, 0x6b2, 0xe95, 0xe2a, 0xc96, 0x92e, 0xaad, 0x56a, 0xd65,  /* 1490-1499 */
+    0xd4a, 0xd15, 0x62b, 0xc5b, 0x53a, 0x6b5, 0xdb2, 0xd64, 0xd29, 0xa55,  /* 1500-1509 */
+    0x4ad, 0x96d, 0xaea, 0x6e8, 0xed1, 0xda4, 0xd4a, 0xa6a, 0x2da, 0x5b9,  /* 1510-1519 */
+    0xb72, 0xb68, 0x6d1, 0x655, 0x4ab, 0x95b, 0x2ba, 0x5b5, 0xda9, 0xd52,  /* 1520-1529 */
+    0xca6, 0x94e, 0x46e, 0x95d, 0x4da, 0xad5, 0xaaa, 0xa4d, 0x49b, 0x937,  /* 1530-1539 */
+    0x4b6, 0x975, 0xd6a, 0xd52, 0xaa5, 0x94b, 0x2ab, 0x55b, 0xad9, 0x5d2,  /* 1540-1549 */
+    0xdc5, 0xd92, 0xb25, 0x555, 0xab5, 0x5b4, 0xba9, 0x7a2, 0x745, 0x593,  /* 1550-1559 */
+    0xaab, 0x4d6, 0x9d6, 0x5d2, 0xba5, 0xb4a, 0xa95, 0x4ad, 0x15d, 0x2dd,  /* 1560-1569 */
+    0x9da, 0x5b4, 0x5a9, 0x52d, 0x25b, 0x8b7, 0x176, 0x56d, 0xb6a, 0xaca,  /* 1570-1579 */
+    0xa96, 0x52b, 0x15b, 0x2bb, 0x5b6, 0xdaa, 0xb94, 0xd46, 0xa8d, 0x52d,  /* 1580-1589 */
+    0xa9d, 0x55a, 0x755, 0x749, 0xf13, 0xe4a, 0xa96, 0x556, 0x6b5, 0xbaa,  /* 1590-1599 */
+    0xb94   /* 1600-1600 */
+};
+
+static const int ummalqura_year_start[] = {
+         0,    354,    708,   1063,   1417,   1772,   2126,   2481,   2835,   3189,  /* 1300-1309 */
+      3543,   3898,   4252,   4607,   4961,   5316,   5670,   6024,   6378,   6733,  /* 1310-1319 */
+      7088,   7442,   7797,   8151,   8505,   8859,   9214,   9568,   9923,  10277,  /* 1320-1329 */
+     10631,  10985,  11340,  11694,  12049,  12403,  12758,  13112,  13466,  13820,  /* 1330-1339 */
+     14175,  14529,  14884,  15238,  15592,  15946,  16300,  16655,  17010,  17364,  /* 1340-1349 */
+     17719,  18073,  18427,  18781,  19136,  19490,  19845,  20200,  20554,  20908,  /* 1350-1359 */
+     21262,  21616,  21971,  22325,  22680,  23034,  23388,  23742,  24097,  24451,  /* 1360-1369 */
+     24806,  25161,  25515,  25869,  26223,  26577,  26932,  27287,  27641,  27996,  /* 1370-1379 */
+     28350,  28704,  29058,  29412,  29767,  30122,  30476,  30830,  31184,  31538,  /* 1380-1389 */
+     31893,  32248,  32602,  32957,  33311,  33665,  34019,  34373,  34728,  35082,  /* 1390-1399 */
+     35437,  35791,  36145,  36499,  36854,  37208,  37563,  37918,  38272,  38626,  /* 1400-1409 */
+     38980,  39334,  39689,  40044,  40398,  40753,  41107,  41461,  41815,  42170,  /* 1410-1419 */
+     42524,  42879,  43233,  43587,  43941,  44295,  44650,  45005,  45359,  45714,  /* 1420-1429 */
+     46068,  46422,  46776,  47130,  47485,  47839,  48194,  48548,  48902,  49256,  /* 1430-1439 */
+     49611,  49965,  50320,  50674,  51029,  51383,  51737,  52091,  52446,  52801,  /* 1440-1449 */
+     53155,  53509,  53864,  54218,  54572,  54927,  55282,  55636,  55991,  56345,  /* 1450-1459 */
+     56699,  57053,  57407,  57762,  58117,  58471,  58825,  59179,  59534,  59888,  /* 1460-1469 */
+     60243,  60597,  60952,  61306,  61660,  62014,  62368,  62723,  63078,  63432,  /* 1470-1479 */
+     63786,  64140,  64494,  64849,  65204,  65558,  65913,  66267,  66621,  66975,  /* 1480-1489 */
+     67330,  67684,  68039,  68393,  68748,  69102,  69456,  69810,  70165,  70519,  /* 1490-1499 */
+     70874,  71228,  71582,  71936,  72291,  72645,  73000,  73355,  73709,  74063,  /* 1500-1509 */
+     74417,  74771,  75126,  75481,  75835,  76190,  76544,  76898,  77252,  77606,  /* 1510-1519 */
+     77961,  78316,  78670,  79024,  79378,  79732,  80087,  80441,  80796,  81151,  /* 1520-1529 */
+     81505,  81859,  82213,  82567,  82922,  83276,  83631,  83985,  84339,  84693,  /* 1530-1539 */
+     85048,  85402,  85757,  86112,  86466,  86820,  87174,  87528,  87883,  88238,  /* 1540-1549 */
+     88592,  88947,  89301,  89655,  90009,  90364,  90718,  91073,  91427,  91781,  /* 1550-1559 */
+     92135,  92490,  92844,  93199,  93553,  93908,  94262,  94616,  94970,  95324,  /* 1560-1569 */
+     95679,  96034,  96388,  96742,  97096,  97450,  97805,  98159,  98514,  98869,  /* 1570-1579 */
+     99223,  99577,  99931, 100285, 100640, 100995, 101350, 101704, 102058, 102412,  /* 1580-1589 */
+    102766, 103121, 103475, 103830, 104184, 104539, 104893, 105247, 105601, 105956,  /* 1590-1599 */
+    106311, 106665   /* 1600-1601 */
+};
+
+// Number of days before a given month of a tabulated Umm al-Qura year
+
+static int ummalqura_month_offset(int year, int month)
+{
+    unsigned mask = ummalqura_months[year - UMMALQURA_FIRST_YEAR] & ((1u << (month - 1)) - 1);
+    return (29 * (month - 1)) + __builtin_popcount(mask);
+}
+
+// UMMALQURA_TO_JD: Determine Julian day from Umm al-Qura date
+
+double ummalqura_to_jd(int year, int month, int day)
+{
+    if(year < UMMALQURA_FIRST_YEAR || year > UMMALQURA_LAST_YEAR || month < 1 || month > 12)
+        return islamic_to_jd(year, month, day);
+
+    return (UMMALQURA_EPOCH - 0.5) + ummalqura_year_start[year - UMMALQURA_FIRST_YEAR] +
+           ummalqura_month_offset(year, month) + (day - 1);
+}
+
+// JD_TO_UMMALQURA: Calculate Umm al-Qura date from Julian day
+
+void jd_to_ummalqura(double jd, int *year, int *month, int *day)
+{
+    int lo, hi, mid, yday, mdays, i;
+    unsigned bits;
+
+    yday = (int)floor(jd + 0.5) - UMMALQURA_EPOCH;
+    hi = UMMALQURA_LAST_YEAR - UMMALQURA_FIRST_YEAR;
+    if(yday < 0 || yday >= ummalqura_year_start[hi + 1])
+    {
+        jd_to_islamic(jd, year, month, day);
+        return;
+    }
+
+    // Binary search for the last year starting on or before the day
+
+    lo = 0;
+    while(lo < hi)
+    {
+        mid = (lo + hi + 1) / 2;
+        if(ummalqura_year_start[mid] <= yday)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    *year = UMMALQURA_FIRST_YEAR + lo;
+    yday -= ummalqura_year_start[lo];
+    bits = ummalqura_months[lo];
+
+    for(i = 0; i < 11; i++)
+    {
+        mdays = 29 + ((bits >> i) & 1);
+        if(yday < mdays)
+            break;
+        yday -= mdays;
+    }
+
+    *month = i + 1;
+    *day = yday + 1;
 }
 
-int *islamic_to_persian_arr(int year, int month, int day, int result_ymd[])
+int *jd_to_ummalqura_arr(double jd, int result_ymd[])
 {
-    jd_to_persian(islamic_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    jd_to_ummalqura(jd, &result_ymd[0], &result_ymd[1], &result_ymd[2]);
     return result_ymd;
 }
 
-int *islamic_to_gregorian_arr(int year, int month, int day, int result_ymd[])
+// LEAP_UMMALQURA: Is a given Umm al-Qura year 355 days long?
+
+int leap_ummalqura(int year)
 {
-    jd_to_gregorian(islamic_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    int i;
+
+    if(year < UMMALQURA_FIRST_YEAR || year > UMMALQURA_LAST_YEAR)
+        return leap_islamic(year);
+
+    i = year - UMMALQURA_FIRST_YEAR;
+    return (ummalqura_year_start[i + 1] - ummalqura_year_start[i]) == 355;
 }
 
-int *islamic_to_hebrew_arr(int year, int month, int day, int result_ymd[])
+const char *ummalqura_month_name(int month)
 {
-    jd_to_hebrew(islamic_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    return islamic_month_name(month);
 }
 
-int *islamic_to_julian_arr(int year, int month, int day, int result_ymd[])
+int ummalqura_month_days(int year, int month)
 {
-    jd_to_julian(islamic_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    if(month < 1 || month > 12)
+        return -1;  // ERROR: The month must be between 1-12
+
+    if(year < UMMALQURA_FIRST_YEAR || year > UMMALQURA_LAST_YEAR)
+        return islamic_month_days(year, month);
+
+    return 29 + ((ummalqura_months[year - UMMALQURA_FIRST_YEAR] >> (month - 1)) & 1);
 }
 
-int *islamic_to_persianb_arr(int year, int month, int day, int result_ymd[])
+// /////////////////////////////////  UMM AL-QURA CALENDAR  ///////////////////////////////// //
+// ****************************************************************************************** //
+// /////////////////////////////////    HEBREW CALENDAR     ///////////////////////////////// //
+
+static const double HEBREW_EPOCH = 347995.5;
+
+int hebrew_year_days(int year);
+
+// Test for delay of start of new year and to avoid
+// Sunday, Wednesday, and Friday as start of the new year.
+
+int hebrew_delay_1(int year)
 {
-    jd_to_persianb(islamic_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    double months, days, parts;
+
+    months = floor(((235 * year) - 234) / (double)19);
+    parts = 12084 + (13753 * months);
+    days = (months * 29) + floor(parts / 25920);
+
+    if(mod((3 * (days + 1)), 7) < 3)
+        days++;
+
+    return (int)days;
 }
 
-int *hebrew_to_persian_arr(int year, int month, int day, int result_ymd[])
+// Check for delay in start of new year due to length of adjacent years
+
+int hebrew_delay_2(int year)
 {
-    jd_to_persian(hebrew_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    int last, present, next;
+
+    last = hebrew_delay_1(year - 1);
+    present = hebrew_delay_1(year);
+    next = hebrew_delay_1(year + 1);
+
+    return ((next - present) == 356) ? 2 : (((present - last) == 382) ? 1 : 0);
 }
 
-int *hebrew_to_gregorian_arr(int year, int month, int day, int result_ymd[])
+// HEBREW_NEW_YEAR: Days from the epoch to 1 Tishrei of a year, kept in the shared year cache
+
+static int hebrew_new_year(int year)
 {
-    jd_to_gregorian(hebrew_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    int days;
+
+    if(!year_cache_get(DC_HEB, year, &days))
+    {
+        days = hebrew_delay_1(year) + hebrew_delay_2(year);
+        year_cache_put(DC_HEB, year, days);
+    }
+
+    return days;
 }
 
-int *hebrew_to_islamic_arr(int year, int month, int day, int result_ymd[])
+const char *hebrew_month_name(int year, int month)
 {
-    jd_to_islamic(hebrew_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    if(month < 1 || month > 13)
+        return NULL;
+    static const char *adar_i = "Adar I";
+    static const char *hm_name[] = {"Nisan", "Iyar", "Sivan", "Tammuz", "Av", "Elul",
+                                    "Tishrei", "Cheshvan", "Kislev", "Tevet", "Shevat", "Adar", "Adar II"};
+    if(month == 12 && leap_hebrew(year))
+        return adar_i;
+    return hm_name[month - 1];
 }
 
-int *hebrew_to_julian_arr(int year, int month, int day, int result_ymd[])
+// How many days are in a given month of a given year
+
+int hebrew_month_days(int year, int month)
 {
-    jd_to_julian(hebrew_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    if(month < 1 || month > 13)
+        return -1;  // ERROR: The month must be between 1-13
+
+    switch(month)
+    {
+        case 2:
+        case 4:
+        case 6:
+        case 10:
+        case 13:
+            return 29;  // First of all, dispose of fixed-length 29 day months
+        case 8:
+            if(!(mod(hebrew_year_days(year), 10) == 5))
+                return 29;  // If it's Cheshvan, days depend on length of year
+            break;
+        case 9:
+            if(mod(hebrew_year_days(year), 10) == 3)
+                return 29;  // Similarly, Kislev varies with the length of year
+            break;
+        case 12:
+            if(!leap_hebrew(year))
+                return 29;  // If it's not a leap year, Adar has 29 days
+            break;
+    }
+
+    return 30;  // Nope, it's a 30 day month
 }
 
-int *hebrew_to_persianb_arr(int year, int month, int day, int result_ymd[])
+// HEBREW_TO_JD: Determine Julian day from Hebrew date
+
+double hebrew_to_jd(int year, int month, int day)
 {
-    jd_to_persianb(hebrew_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    double jd;
+    int mon, months;
+
+    months = hebrew_year_months(year);
+    jd = HEBREW_EPOCH + hebrew_new_year(year) + day + 1;
+
+    if(month < 7)
+    {
+        for(mon = 7; mon <= months; mon++)
+            jd += hebrew_month_days(year, mon);
+        for(mon = 1; mon < month; mon++)
+            jd += hebrew_month_days(year, mon);
+    }
+    else
+    {
+        for(mon = 7; mon < month; mon++)
+            jd += hebrew_month_days(year, mon);
+    }
+
+    return jd;
 }
 
-int *julian_to_persian_arr(int year, int month, int day, int result_ymd[])
+/* JD_TO_HEBREW  --  Convert Julian date to Hebrew date
+                     This works by making multiple calls to
+                     the inverse function, and is this very
+                     slow. */
+
+void jd_to_hebrew(double jd, int *year, int *month, int *day)
 {
-    jd_to_persian(julian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    int i, count, first;
+
+    if(month_index_ymd(DC_HEB, jd, year, month, day))
+        return;
+
+    jd = floor(jd) + 0.5;
+    count = (int)floor(((jd - HEBREW_EPOCH) * 98496.0) / 35975351.0);
+
+    *year = count - 1;
+    for(i = count; jd >= hebrew_to_jd(i, 7, 1); i++)
+        (*year)++;
+
+    first = (jd < hebrew_to_jd(*year, 1, 1)) ? 7 : 1;
+    *month = first;
+    for(i = first; jd > hebrew_to_jd(*year, i, hebrew_month_days(*year, i)); i++)
+        (*month)++;
+
+    *day = (int)(jd - hebrew_to_jd(*year, *month, 1)) + 1;
 }
 
-int *julian_to_gregorian_arr(int year, int month, int day, int result_ymd[])
+int *jd_to_hebrew_arr(double jd, int result_ymd[])
 {
-    jd_to_gregorian(julian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    jd_to_hebrew(jd, &result_ymd[0], &result_ymd[1], &result_ymd[2]);
     return result_ymd;
 }
 
-int *julian_to_islamic_arr(int year, int month, int day, int result_ymd[])
+// How many days are in a Hebrew year?
+
+int hebrew_year_days(int year)
 {
-    jd_to_islamic(julian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    return hebrew_new_year(year + 1) - hebrew_new_year(year);
 }
 
-int *julian_to_hebrew_arr(int year, int month, int day, int result_ymd[])
+// /////////////////////////////////    HEBREW CALENDAR     ///////////////////////////////// //
+#endif  // DC_EMBEDDED
+// ****************************************************************************************** //
+// /////////////////////////////////    JULIAN CALENDAR     ///////////////////////////////// //
+
+// static const double JULIAN_EPOCH = 1721423.5;
+
+// JULIAN_TO_JDN: julian_to_jd() on integers, for a date within DC_JDN_YMD_OK()
+
+static int julian_to_jdn(int year, int month, int day)
 {
-    jd_to_hebrew(julian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    if(year < 1)
+        year++;
+
+    if(month <= 2)
+    {
+        year--;
+        month += 12;
+    }
+
+    return floor_div(1461 * (year + 4716), 4) + floor_div(306001 * (month + 1), 10000) + day - 1524;
 }
 
-int *julian_to_persianb_arr(int year, int month, int day, int result_ymd[])
+// JDN_TO_JULIAN: jd_to_julian() on integers
+
+static void jdn_to_julian(int jdn, int *year, int *month, int *day)
 {
-    jd_to_persianb(julian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    long long x;
+    int b, c, d, e, m, y;
+
+    b = jdn + 1524;
+    x = (100LL * b) - 12210;
+    c = (int)((x >= 0) ? x / 36525 : -((36524 - x) / 36525));
+    d = floor_div(1461 * c, 4);
+    e = floor_div(10000 * (b - d), 306001);
+
+    m = (e < 14) ? (e - 1) : (e - 13);
+    y = (m > 2) ? (c - 4716) : (c - 4715);
+
+    *year = (y < 1) ? y - 1 : y;
+    *month = m;
+    *day = b - d - floor_div(306001 * e, 10000);
 }
 
-int *persianb_to_persian_arr(int year, int month, int day, int result_ymd[])
+#ifndef DC_EMBEDDED
+
+// JD_TO_JULIAN: Calculate Julian calendar date from Julian day
+
+void jd_to_julian(double jd, int *year, int *month, int *day)
 {
-    jd_to_persian(persianb_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    double z, a, b, c, d, e;
+
+    if(DC_JDN_JD_OK(jd))
+    {
+        jdn_to_julian((int)floor(jd + 0.5), year, month, day);
+        return;
+    }
+
+    jd += 0.5;
+    z = floor(jd);
+    a = z;
+    b = a + 1524;
+    c = floor((b - 122.1) / 365.25);
+    d = floor(365.25 * c);
+    e = floor((b - d) / 30.6001);
+
+    *month = (int)floor((e < 14) ? (e - 1) : (e - 13));
+    *year = (int)floor((*month > 2) ? (c - 4716) : (c - 4715));
+    *day = (int)(b - d - floor(30.6001 * e));
+
+    /* If year is less than 1, subtract one to convert from
+       a zero based date system to the common era system in
+       which the year -1 (1 B.C.E) is followed by year 1 (1 C.E.). */
+
+    if(*year < 1)
+        (*year)--;
 }
 
-int *persianb_to_gregorian_arr(int year, int month, int day, int result_ymd[])
+#else
+
+// JULIAN_TO_JD, JD_TO_JULIAN: The integer paths alone, for dates within DC_JDN_YMD_OK()
+
+double julian_to_jd(int year, int month, int day)
 {
-    jd_to_gregorian(persianb_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    return julian_to_jdn(year, month, day) - 0.5;
 }
 
-int *persianb_to_islamic_arr(int year, int month, int day, int result_ymd[])
+void jd_to_julian(double jd, int *year, int *month, int *day)
 {
-    jd_to_islamic(persianb_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    jdn_to_julian(jd_floor(jd + 0.5), year, month, day);
 }
 
-int *persianb_to_hebrew_arr(int year, int month, int day, int result_ymd[])
+#endif  // DC_EMBEDDED
+
+int *jd_to_julian_arr(double jd, int result_ymd[])
 {
-    jd_to_hebrew(persianb_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    jd_to_julian(jd, &result_ymd[0], &result_ymd[1], &result_ymd[2]);
     return result_ymd;
 }
 
-int *persianb_to_julian_arr(int year, int month, int day, int result_ymd[])
+const char *julian_month_name(int month)
 {
-    jd_to_julian(persianb_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
-    return result_ymd;
+    return gregorian_month_name(month);
+}
+
+// /////////////////////////////////    JULIAN CALENDAR     ///////////////////////////////// //
+// ****************************************************************************************** //
+// ****************************************************************************************** //
+// /////////////////////////////////  COPTIC AND ETHIOPIAN  ///////////////////////////////// //
+
+/* The Coptic and Ethiopian calendars share the Alexandrian reckoning:
+   twelve months of 30 days and a thirteenth of 5, or of 6 in the year
+   before each year divisible by 4.  Only their epochs differ. */
+
+static const int COPTIC_EPOCH = 1825030;     // Julian day number of 1 Thout 1 (29 August 284, Julian)
+static const int ETHIOPIAN_EPOCH = 1724221;  // Julian day number of 1 Meskerem 1 (29 August 8, Julian)
+
+static int alexandrian_to_jdn(int epoch, int year, int month, int day)
+{
+    return (epoch - 1) + (365 * (year - 1)) + floor_div(year, 4) + (30 * (month - 1)) + day;
+}
+
+static void jdn_to_alexandrian(int epoch, int jdn, int *year, int *month, int *day)
+{
+    int y, yday;
+
+    y = floor_div((4 * (jdn - epoch)) + 1463, 1461);
+    yday = jdn - alexandrian_to_jdn(epoch, y, 1, 1);
+
+    *year = y;
+    *month = (yday / 30) + 1;
+    *day = (yday % 30) + 1;
+}
+
+static int coptic_to_jdn(int year, int month, int day)
+{
+    return alexandrian_to_jdn(COPTIC_EPOCH, year, month, day);
+}
+
+static void jdn_to_coptic(int jdn, int *year, int *month, int *day)
+{
+    jdn_to_alexandrian(COPTIC_EPOCH, jdn, year, month, day);
+}
+
+static int ethiopian_to_jdn(int year, int month, int day)
+{
+    return alexandrian_to_jdn(ETHIOPIAN_EPOCH, year, month, day);
 }
+
+static void jdn_to_ethiopian(int jdn, int *year, int *month, int *day)
+{
+    jdn_to_alexandrian(ETHIOPIAN_EPOCH, jdn, year, month, day);
+}
+
+double coptic_to_jd(int year, int month, int day)
+{
+    return coptic_to_jdn(year, month, day) - 0.5;
+}
+
+void jd_to_coptic(double jd, int *year, int *month, int *day)
+{
+    int jdn;
+
+    if(jd_to_jdn(jd, &jdn))
+        jdn_to_coptic(jdn, year, month, day);
+    else
+        *year = *month = *day = 0;
+}
+
+double ethiopian_to_jd(int year, int month, int day)
+{
+    return ethiopian_to_jdn(year, month, day) - 0.5;
+}
+
+void jd_to_ethiopian(double jd, int *year, int *month, int *day)
+{
+    int jdn;
+
+    if(jd_to_jdn(jd, &jdn))
+        jdn_to_ethiopian(jdn, year, month, day);
+    else
+        *year = *month = *day = 0;
+}
+
+int leap_coptic(int year)
+{
+    return floor_mod(year, 4) == 3;
+}
+
+int leap_ethiopian(int year)
+{
+    return floor_mod(year, 4) == 3;
+}
+
+int coptic_month_days(int year, int month)
+{
+    if(month < 1 || month > 13)
+        return -1;  // ERROR: The month must be between 1-13
+
+    return (month <= 12) ? 30 : 5 + leap_coptic(year);
+}
+
+int ethiopian_month_days(int year, int month)
+{
+    if(month < 1 || month > 13)
+        return -1;  // ERROR: The month must be between 1-13
+
+    return (month <= 12) ? 30 : 5 + leap_ethiopian(year);
+}
+
+const char *coptic_month_name(int month)
+{
+    if(month < 1 || month > 13)
+        return NULL;
+    static const char *cm_name[] = {"Thout", "Paopi", "Hathor", "Koiak", "Tobi", "Meshir", "Paremhat",
+                                    "Parmouti", "Pashons", "Paoni", "Epip", "Mesori", "Pi Kogi Enavot"};
+    return cm_name[month - 1];
+}
+
+const char *ethiopian_month_name(int month)
+{
+    if(month < 1 || month > 13)
+        return NULL;
+    static const char *em_name[] = {"Meskerem", "Tikimt", "Hidar", "Tahsas", "Tir", "Yekatit", "Megabit",
+                                    "Miyazya", "Ginbot", "Sene", "Hamle", "Nehase", "Pagume"};
+    return em_name[month - 1];
+}
+
+// /////////////////////////////////  COPTIC AND ETHIOPIAN  ///////////////////////////////// //
+// ****************************************************************************************** //
+// /////////////////////////////////    INDIAN CALENDAR     ///////////////////////////////// //
+
+/* The Indian national calendar (Saka era) follows the Gregorian leap
+   years: year S begins on 22 March of Gregorian year S + 78, or on 21
+   March in a leap year, with Chaitra of 30 days (31 in a leap year),
+   five months of 31 days and six of 30. */
+
+int leap_indian(int year)
+{
+    return leap_gregorian(year + 78);
+}
+
+static int indian_to_jdn(int year, int month, int day)
+{
+    int leap = leap_indian(year);
+
+    return gregorian_to_jdn(year + 78, 3, 22 - leap) + (day - 1) +
+           ((month <= 1) ? 0 : ((30 + leap) + ((month <= 7) ? (31 * (month - 2)) : (155 + (30 * (month - 7))))));
+}
+
+static void jdn_to_indian(int jdn, int *year, int *month, int *day)
+{
+    int y, m, d, yday, chaitra;
+
+    jdn_to_gregorian(jdn, &y, &m, &d);
+    y -= 78;
+    if(jdn < indian_to_jdn(y, 1, 1))
+        y--;
+
+    yday = jdn - indian_to_jdn(y, 1, 1);
+    chaitra = 30 + leap_indian(y);
+    if(yday < chaitra)
+    {
+        m = 1;
+        d = yday + 1;
+    }
+    else if((yday -= chaitra) < 155)
+    {
+        m = 2 + (yday / 31);
+        d = (yday % 31) + 1;
+    }
+    else
+    {
+        yday -= 155;
+        m = 7 + (yday / 30);
+        d = (yday % 30) + 1;
+    }
+
+    *year = y;
+    *month = m;
+    *day = d;
+}
+
+double indian_to_jd(int year, int month, int day)
+{
+    return indian_to_jdn(year, month, day) - 0.5;
+}
+
+void jd_to_indian(double jd, int *year, int *month, int *day)
+{
+    int jdn;
+
+    if(jd_to_jdn(jd, &jdn))
+        jdn_to_indian(jdn, year, month, day);
+    else
+        *year = *month = *day = 0;
+}
+
+int indian_month_days(int year, int month)
+{
+    if(month < 1 || month > 12)
+        return -1;  // ERROR: The month must be between 1-12
+
+    return (month == 1) ? 30 + leap_indian(year) : ((month <= 6) ? 31 : 30);
+}
+
+const char *indian_month_name(int month)
+{
+    if(month < 1 || month > 12)
+        return NULL;
+    static const char *nm_name[] = {"Chaitra", "Vaishakha", "Jyeshtha", "Ashadha", "Shravana", "Bhadra",
+                                    "Ashvin", "Kartika", "Agrahayana", "Pausha", "Magha", "Phalguna"};
+    return nm_name[month - 1];
+}
+
+// /////////////////////////////////    INDIAN CALENDAR     ///////////////////////////////// //
+// ****************************************************************************************** //
+// /////////////////////////////////   ARMENIAN CALENDAR    ///////////////////////////////// //
+
+/* The old Armenian calendar: a wandering year of 365 days without leap
+   years, twelve months of 30 days and five epagomenal days (Aveleats,
+   month 13), counted from 11 July 552 (Julian). */
+
+static const int ARMENIAN_EPOCH = 1922868;  // Julian day number of 1 Navasard 1 (JD 1922867.5)
+
+static int armenian_to_jdn(int year, int month, int day)
+{
+    return ARMENIAN_EPOCH + (365 * (year - 1)) + (30 * (month - 1)) + (day - 1);
+}
+
+static void jdn_to_armenian(int jdn, int *year, int *month, int *day)
+{
+    int days = jdn - ARMENIAN_EPOCH;
+    int y = floor_div(days, 365);
+
+    days -= 365 * y;
+    *year = y + 1;
+    *month = (days / 30) + 1;
+    *day = (days % 30) + 1;
+}
+
+double armenian_to_jd(int year, int month, int day)
+{
+    return armenian_to_jdn(year, month, day) - 0.5;
+}
+
+void jd_to_armenian(double jd, int *year, int *month, int *day)
+{
+    int jdn;
+
+    if(jd_to_jdn(jd, &jdn))
+        jdn_to_armenian(jdn, year, month, day);
+    else
+        *year = *month = *day = 0;
+}
+
+int armenian_month_days(int year, int month)
+{
+    (void)year;
+    if(month < 1 || month > 13)
+        return -1;  // ERROR: The month must be between 1-13
+
+    return (month <= 12) ? 30 : 5;
+}
+
+const char *armenian_month_name(int month)
+{
+    if(month < 1 || month > 13)
+        return NULL;
+    static const char *am_name[] = {"Navasard", "Hori", "Sahmi", "Tre", "Kaghots", "Arats", "Mehekan",
+                                    "Areg", "Ahekan", "Mareri", "Margats", "Hrotits", "Aveleats"};
+    return am_name[month - 1];
+}
+
+// /////////////////////////////////   ARMENIAN CALENDAR    ///////////////////////////////// //
+// ****************************************************************************************** //
+// ****************************************************************************************** //
+// /////////////////////////////////     BADI' CALENDAR     ///////////////////////////////// //
+
+#ifndef DC_EMBEDDED
+
+/* The Badi' (Baha'i) calendar: nineteen months of nineteen days, and
+   the four or five intercalary days of Ayyam-i-Ha, numbered month 0,
+   between months 18 and 19.  Since 172 B.E. (2015) a year begins on
+   Naw-Ruz, the day, from sunset to sunset in Tehran, in which the March
+   equinox falls; the earlier years began on 21 March.  A Badi' day
+   begins at the sunset before the civil day of the same number, and a
+   date names its daylight part.
+
+   The Naw-Ruz of each year of the table's window is computed once from
+   the Tehran equinox and sunset, and kept packed with the length of
+   its Ayyam-i-Ha, so that conversions look it up; the other years keep
+   it in the shared year cache. */
+
+#define BADI_ASTRONOMICAL 172   // First year begun by the equinox
+#define BADI_TABLE_YEARS  1024  // Table of the years 172-1195 (Gregorian 2015-3038)
+
+static const double TEHRAN_LATITUDE = 35.6944;   // 35°41'40" N
+static const double TEHRAN_LONGITUDE = 51.4215;  // 51°25'17" E
+
+static int badi_table[BADI_TABLE_YEARS];  // Naw-Ruz day number * 8 + days of Ayyam-i-Ha, 0 = not yet computed
+
+/* TEHRAN_SUNSET  --  Sunset in Tehran on the day whose apparent noon is
+                      Julian day "noon", in the time of tehran_equinox():
+                      apparent solar time at the Iran Standard Time
+                      meridian.  That time runs with universal time, so
+                      the two compare directly.  The Sun's centre sets
+                      50' below the horizon; its declination is taken
+                      again at the first estimate of the sunset. */
+
+static double tehran_sunset(double noon)
+{
+    double spos[12], ut, delta, hour_angle = 90;  // Degrees, 6 p.m. to begin with
+    int i;
+
+    for(i = 0; i < 2; i++)
+    {
+        ut = noon + ((hour_angle - TEHRAN_LONGITUDE) / 360);
+        ut -= equationOfTime(ut);
+        delta = sunpos(ut, spos)[11];
+        hour_angle = rtd(racos((dsin(-0.8333) - (dsin(TEHRAN_LATITUDE) * dsin(delta))) /
+                              (dcos(TEHRAN_LATITUDE) * dcos(delta))));
+    }
+
+    return noon + ((hour_angle + tehran_ctx.meridian - TEHRAN_LONGITUDE) / 360);
+}
+
+// Julian day number of Naw-Ruz, computed: the day whose sunset follows the equinox, or 21 March before 172
+
+static int badi_new_year(int year)
+{
+    double equinox, noon;
+
+    if(year < BADI_ASTRONOMICAL)
+        return gregorian_to_jdn(year + 1843, 3, 21);
+
+    equinox = tehran_equinox(year + 1843);
+    noon = floor(equinox);
+    return (int)noon + (equinox >= tehran_sunset(noon));
+}
+
+// BADI_YEAR: Julian day number of Naw-Ruz of a year and the days of its Ayyam-i-Ha, from the table or the cache
+
+static int badi_year(int year, int *ayyam)
+{
+    int i = year - BADI_ASTRONOMICAL, packed, start;
+
+    if(year < BADI_ASTRONOMICAL - 1)
+    {
+        *ayyam = 4 + leap_gregorian(year + 1844);  // Up to the next 21 March
+        return badi_new_year(year);
+    }
+
+    if(i >= 0 && i < BADI_TABLE_YEARS)
+        packed = DC_LOAD_RELAXED(&badi_table[i]);
+    else if(!year_cache_get(DC_BAH, year, &packed))
+        packed = 0;
+
+    if(!packed)
+    {
+        start = badi_new_year(year);
+        packed = (start << 3) | (badi_new_year(year + 1) - start - 361);
+        if(i >= 0 && i < BADI_TABLE_YEARS)
+            DC_STORE_RELAXED(&badi_table[i], packed);
+        else
+            year_cache_put(DC_BAH, year, packed);
+    }
+
+    *ayyam = packed & 7;
+    return packed >> 3;
+}
+
+// Forget the Naw-Ruz of every year (a new ephemeris)
+
+static void badi_table_drop(void)
+{
+    int i;
+
+    for(i = 0; i < BADI_TABLE_YEARS; i++)
+        DC_STORE_RELAXED(&badi_table[i], 0);
+    year_cache_drop(DC_BAH);
+}
+
+static int badi_to_jdn(int year, int month, int day)
+{
+    int ayyam, start = badi_year(year, &ayyam);
+
+    return start + (day - 1) + ((month == 0) ? 342 : ((19 * (month - 1)) + ((month == 19) ? ayyam : 0)));
+}
+
+static void jdn_to_badi(int jdn, int *year, int *month, int *day)
+{
+    int y, m, d, ayyam, start, yday;
+
+    jdn_to_gregorian(jdn, &y, &m, &d);
+    y -= 1843;
+    if(jdn < (start = badi_year(y, &ayyam)))
+        start = badi_year(--y, &ayyam);
+
+    yday = jdn - start;
+    if(yday < 342)
+    {
+        m = (yday / 19) + 1;
+        d = (yday % 19) + 1;
+    }
+    else if(yday < 342 + ayyam)
+    {
+        m = 0;  // Ayyam-i-Ha
+        d = yday - 342 + 1;
+    }
+    else
+    {
+        m = 19;
+        d = yday - (342 + ayyam) + 1;
+    }
+
+    *year = y;
+    *month = m;
+    *day = d;
+}
+
+/* BADI_TO_JD  --  Obtain Julian day from a given Badi' date; month 0
+                   is Ayyam-i-Ha. */
+
+double badi_to_jd(int year, int month, int day)
+{
+    return badi_to_jdn(year, month, day) - 0.5;
+}
+
+/* JD_TO_BADI  --  Calculate the Badi' date of the civil day of a
+                   Julian day. */
+
+void jd_to_badi(double jd, int *year, int *month, int *day)
+{
+    int jdn;
+
+    if(jd_to_jdn(jd, &jdn))
+        jdn_to_badi(jdn, year, month, day);
+    else
+        *year = *month = *day = 0;
+}
+
+// LEAP_BADI: Does a given year have five days of Ayyam-i-Ha?
+
+int leap_badi(int year)
+{
+    int ayyam;
+
+    badi_year(year, &ayyam);
+    return ayyam == 5;
+}
+
+int badi_month_days(int year, int month)
+{
+    int ayyam;
+
+    if(month < 0 || month > 19)
+        return -1;  // ERROR: The month must be between 0-19
+
+    if(month)
+        return 19;
+
+    badi_year(year, &ayyam);
+    return ayyam;
+}
+
+const char *badi_month_name(int month)
+{
+    if(month < 0 || month > 19)
+        return NULL;
+    static const char *bm_name[] = {"Ayyam-i-Ha", "Baha", "Jalal", "Jamal", "'Azamat", "Nur", "Rahmat",
+                                    "Kalimat", "Kamal", "Asma'", "'Izzat", "Mashiyyat", "'Ilm", "Qudrat",
+                                    "Qawl", "Masa'il", "Sharaf", "Sultan", "Mulk", "'Ala'"};
+    return bm_name[month];
+}
+
+#endif  // DC_EMBEDDED
+
+// /////////////////////////////////     BADI' CALENDAR     ///////////////////////////////// //
+// ****************************************************************************************** //
+// /////////////////////////////////   CALENDAR REGISTRY    ///////////////////////////////// //
+
+/* Every calendar is described once, by a dc_calendar_ops_t, and found
+   through a flat table indexed by its id: ymd_to_jd(), jd_to_ymd(),
+   dc_convert(), check_date() and the year layouts dispatch through it
+   instead of switching on the calendar, so a calendar added here or
+   by dc_calendar_register() needs no other change.  The calendars
+   computed on Julian days reach the integer interface through
+   wrappers. */
+
+// Integer day-number functions of a calendar computed on Julian days
+
+#define DC_JDN_THROUGH_JD(calendar) \
+    static int calendar##_to_jdn_jd(int year, int month, int day) \
+    { \
+        return jd_floor(calendar##_to_jd(year, month, day)) + 1; \
+    } \
+    static void jdn_to_##calendar##_jd(int jdn, int *year, int *month, int *day) \
+    { \
+        jd_to_##calendar(jdn - 0.5, year, month, day); \
+    }
+
+// Month name of a calendar whose names don't depend on the year
+
+#define DC_MONTH_NAME_ANY_YEAR(calendar) \
+    static const char *calendar##_month_name_any_year(int year, int month) \
+    { \
+        (void)year; \
+        return calendar##_month_name(month); \
+    }
+
+DC_JDN_THROUGH_JD(persian)
+DC_MONTH_NAME_ANY_YEAR(persian)
+DC_MONTH_NAME_ANY_YEAR(gregorian)
+DC_MONTH_NAME_ANY_YEAR(islamic)
+DC_MONTH_NAME_ANY_YEAR(julian)
+DC_MONTH_NAME_ANY_YEAR(persianb)
+DC_MONTH_NAME_ANY_YEAR(coptic)
+DC_MONTH_NAME_ANY_YEAR(ethiopian)
+DC_MONTH_NAME_ANY_YEAR(indian)
+DC_MONTH_NAME_ANY_YEAR(armenian)
+
+#ifndef DC_EMBEDDED
+DC_JDN_THROUGH_JD(hebrew)
+DC_JDN_THROUGH_JD(afghan)
+DC_JDN_THROUGH_JD(ummalqura)
+DC_MONTH_NAME_ANY_YEAR(afghan)
+DC_MONTH_NAME_ANY_YEAR(ummalqura)
+DC_MONTH_NAME_ANY_YEAR(badi)
+#endif
+
+#define DC_EVERY_MONTH 0x3ffeu  // variable_months of a calendar whose months all report code 8
+
+static const dc_calendar_ops_t calendar_ops[DC_CALENDARS] =
+{
+    [DC_PER] = {"Persian", 12, 1, 1, 0, 1u << 12, persian_to_jdn_jd, jdn_to_persian_jd,
+                persian_month_days, leap_persian, NULL, persian_month_name_any_year},
+    [DC_GRE] = {"Gregorian", 12, 1, 1, 0, 1u << 2, gregorian_to_jdn, jdn_to_gregorian,
+                gregorian_month_days, leap_gregorian, NULL, gregorian_month_name_any_year},
+    [DC_ISM] = {"Islamic", 12, 1, 1, 0, DC_EVERY_MONTH, islamic_to_jdn, jdn_to_islamic,
+                islamic_month_days, leap_islamic, NULL, islamic_month_name_any_year},
+    [DC_JUL] = {"Julian", 12, 1, 1, 1, 1u << 2, julian_to_jdn, jdn_to_julian,
+                julian_month_days, leap_julian, NULL, julian_month_name_any_year},
+    [DC_PER_B] = {"Persian (Birashk)", 12, 1, 1, 1, 1u << 12, persianb_to_jdn, jdn_to_persianb,
+                  persianb_month_days, leap_persianb, NULL, persianb_month_name_any_year},
+#ifndef DC_EMBEDDED
+    [DC_HEB] = {"Hebrew", 13, 1, 7, 0, (1u << 8) | (1u << 9) | (1u << 12), hebrew_to_jdn_jd, jdn_to_hebrew_jd,
+                hebrew_month_days, leap_hebrew, hebrew_year_months, hebrew_month_name},
+    [DC_PER_AF] = {"Afghan (Solar Hijri)", 12, 1, 1, 0, 1u << 12, afghan_to_jdn_jd, jdn_to_afghan_jd,
+                   afghan_month_days, leap_afghan, NULL, afghan_month_name_any_year},
+    [DC_ISM_UQ] = {"Islamic (Umm al-Qura)", 12, 1, 1, 0, DC_EVERY_MONTH, ummalqura_to_jdn_jd, jdn_to_ummalqura_jd,
+                   ummalqura_month_days, leap_ummalqura, NULL, ummalqura_month_name_any_year},
+#endif
+    [DC_COP] = {"Coptic", 13, 1, 1, 0, 1u << 13, coptic_to_jdn, jdn_to_coptic,
+                coptic_month_days, leap_coptic, NULL, coptic_month_name_any_year},
+    [DC_ETH] = {"Ethiopian", 13, 1, 1, 0, 1u << 13, ethiopian_to_jdn, jdn_to_ethiopian,
+                ethiopian_month_days, leap_ethiopian, NULL, ethiopian_month_name_any_year},
+    [DC_IND] = {"Indian National", 12, 1, 1, 0, 1u << 1, indian_to_jdn, jdn_to_indian,
+                indian_month_days, leap_indian, NULL, indian_month_name_any_year},
+    [DC_ARM] = {"Armenian", 13, 1, 1, 0, 0, armenian_to_jdn, jdn_to_armenian,
+                armenian_month_days, NULL, NULL, armenian_month_name_any_year},
+#ifndef DC_EMBEDDED
+    [DC_BAH] = {"Badi'", 19, 0, 1, 0, 1u << 0, badi_to_jdn, jdn_to_badi,
+                badi_month_days, leap_badi, NULL, badi_month_name_any_year},
+#endif
+};
+
+/* A calendar of the table: its description, its Julian day functions
+   (NULL for a registered calendar) and its exact integer path (NULL
+   for the calendars computed on Julian days). */
+
+typedef struct Calendar
+{
+    const dc_calendar_ops_t *ops;
+    double (*to_jd)(int, int, int);
+    void (*from_jd)(double, int *, int *, int *);
+    int (*to_jdn)(int, int, int);
+    void (*from_jdn)(int, int *, int *, int *);
+} calendar_t;
+
+static const calendar_t builtin_calendars[DC_CALENDARS] =
+{
+    [DC_PER] = {&calendar_ops[DC_PER], persian_to_jd, jd_to_persian, NULL, NULL},
+    [DC_GRE] = {&calendar_ops[DC_GRE], gregorian_to_jd, jd_to_gregorian, gregorian_to_jdn, jdn_to_gregorian},
+    [DC_ISM] = {&calendar_ops[DC_ISM], islamic_to_jd, jd_to_islamic, islamic_to_jdn, jdn_to_islamic},
+    [DC_JUL] = {&calendar_ops[DC_JUL], julian_to_jd, jd_to_julian, julian_to_jdn, jdn_to_julian},
+    [DC_PER_B] = {&calendar_ops[DC_PER_B], persianb_to_jd, jd_to_persianb, persianb_to_jdn, jdn_to_persianb},
+#ifndef DC_EMBEDDED
+    [DC_HEB] = {&calendar_ops[DC_HEB], hebrew_to_jd, jd_to_hebrew, NULL, NULL},
+    [DC_PER_AF] = {&calendar_ops[DC_PER_AF], afghan_to_jd, jd_to_afghan, NULL, NULL},
+    [DC_ISM_UQ] = {&calendar_ops[DC_ISM_UQ], ummalqura_to_jd, jd_to_ummalqura, NULL, NULL},
+#endif
+    [DC_COP] = {&calendar_ops[DC_COP], coptic_to_jd, jd_to_coptic, coptic_to_jdn, jdn_to_coptic},
+    [DC_ETH] = {&calendar_ops[DC_ETH], ethiopian_to_jd, jd_to_ethiopian, ethiopian_to_jdn, jdn_to_ethiopian},
+    [DC_IND] = {&calendar_ops[DC_IND], indian_to_jd, jd_to_indian, indian_to_jdn, jdn_to_indian},
+    [DC_ARM] = {&calendar_ops[DC_ARM], armenian_to_jd, jd_to_armenian, armenian_to_jdn, jdn_to_armenian},
+#ifndef DC_EMBEDDED
+    [DC_BAH] = {&calendar_ops[DC_BAH], badi_to_jd, jd_to_badi, badi_to_jdn, jdn_to_badi},
+#endif
+};
+
+static calendar_t registered_calendars[DC_CALENDARS_MAX - DC_CALENDARS];
+static int calendars_used = DC_CALENDARS;
+
+// The table itself; a registered calendar is published by a release store once its entry is complete
+
+static const calendar_t *calendar_table[DC_CALENDARS_MAX] =
+{
+    &builtin_calendars[DC_PER], &builtin_calendars[DC_GRE], &builtin_calendars[DC_ISM],
+#ifndef DC_EMBEDDED
+    &builtin_calendars[DC_HEB],
+#else
+    NULL,
+#endif
+    &builtin_calendars[DC_JUL], &builtin_calendars[DC_PER_B],
+#ifndef DC_EMBEDDED
+    &builtin_calendars[DC_PER_AF], &builtin_calendars[DC_ISM_UQ],
+#else
+    NULL, NULL,
+#endif
+    &builtin_calendars[DC_COP], &builtin_calendars[DC_ETH], &builtin_calendars[DC_IND], &builtin_calendars[DC_ARM],
+#ifndef DC_EMBEDDED
+    &builtin_calendars[DC_BAH],
+#else
+    NULL,
+#endif
+};
+
+// The entry of a calendar, NULL if unknown or left out of the build
+
+static inline const calendar_t *calendar_of(dc_calendar_t calendar_type)
+{
+    return ((unsigned)calendar_type < DC_CALENDARS_MAX) ? __atomic_load_n(&calendar_table[calendar_type], __ATOMIC_ACQUIRE) : NULL;
+}
+
+// Month that begins the year of a known calendar; a plain table read for the built-in ones
+
+static inline int calendar_first_month(dc_calendar_t calendar_type)
+{
+    return ((unsigned)calendar_type < DC_CALENDARS) ? calendar_ops[calendar_type].first_month
+                                                    : calendar_of(calendar_type)->ops->first_month;
+}
+
+// DC_CALENDAR_OPS: Description of a calendar, NULL if unknown or left out of the build
+
+const dc_calendar_ops_t *dc_calendar_ops(dc_calendar_t calendar_type)
+{
+    const calendar_t *calendar = calendar_of(calendar_type);
+    return calendar ? calendar->ops : NULL;
+}
+
+/* DC_CALENDAR_REGISTER  --  Add a calendar to the registry.  The
+                             description is used in place and must
+                             outlive its use.  Returns the id of the
+                             new calendar, to be used as its
+                             dc_calendar_t, or -1 for an incomplete
+                             description or a full table. */
+
+int dc_calendar_register(const dc_calendar_ops_t *ops)
+{
+    calendar_t *calendar;
+    int id;
+
+    if(!ops || !ops->to_jdn || !ops->from_jdn || !ops->month_days || ops->max_months < 1 || ops->max_months > 13 ||
+       ops->min_month < 0 || ops->min_month > 1 || ops->first_month < ops->min_month || ops->first_month > ops->max_months)
+        return -1;  // ERROR: Incomplete description
+
+    if((id = __atomic_fetch_add(&calendars_used, 1, __ATOMIC_RELAXED)) >= DC_CALENDARS_MAX)
+        return -1;  // ERROR: The table is full
+
+    calendar = &registered_calendars[id - DC_CALENDARS];
+    calendar->ops = ops;
+    calendar->to_jd = NULL;
+    calendar->from_jd = NULL;
+    calendar->to_jdn = ops->to_jdn;
+    calendar->from_jdn = ops->from_jdn;
+    __atomic_store_n(&calendar_table[id], calendar, __ATOMIC_RELEASE);
+    return id;
+}
+
+// /////////////////////////////////   CALENDAR REGISTRY    ///////////////////////////////// //
+// ****************************************************************************************** //
+
+
+/* CONVERT_DIRECT  --  Convert a date between two arithmetic calendars
+                       through the integer day number, falling back to
+                       the Julian day composition outside DC_JDN_YMD_OK(). */
+
+static inline void convert_direct(int (*to_jdn)(int, int, int), void (*from_jdn)(int, int *, int *, int *),
+                                  double (*to_jd)(int, int, int), void (*from_jd)(double, int *, int *, int *),
+                                  int *year, int *month, int *day)
+{
+    if(DC_JDN_YMD_OK(*year, *month, *day))
+        from_jdn(to_jdn(*year, *month, *day), year, month, day);
+    else
+        from_jd(to_jd(*year, *month, *day), year, month, day);
+}
+
+/* DC_CONVERT  --  Convert a date, in place, from one calendar to
+                   another: directly through the integer day number
+                   when both are arithmetic calendars, otherwise
+                   through the Julian day.  The date is not validated;
+                   returns -1 for an unknown calendar, or one left out
+                   of the build. */
+
+int dc_convert(dc_calendar_t from, dc_calendar_t to, int *year, int *month, int *day)
+{
+    const calendar_t *f = calendar_of(from), *t = calendar_of(to);
+
+    if(!f || !t)
+        return -1;  // ERROR: Unknown calendar, or one left out of the build
+
+    if(!f->to_jd || !t->from_jd)
+        t->ops->from_jdn(f->ops->to_jdn(*year, *month, *day), year, month, day);  // A registered calendar
+    else if(f->to_jdn && t->from_jdn)
+        convert_direct(f->to_jdn, t->from_jdn, f->to_jd, t->from_jd, year, month, day);
+    else
+        t->from_jd(f->to_jd(*year, *month, *day), year, month, day);
+
+    return 0;
+}
+
+// YMD_TO_JD: Determine Julian day from a date in any calendar, Gregorian for an unknown one
+
+double ymd_to_jd(int year, int month, int day, dc_calendar_t calendar_type)
+{
+    const calendar_t *calendar = calendar_of(calendar_type);
+
+    if(!calendar)
+        return gregorian_to_jd(year, month, day);
+    if(!calendar->to_jd)
+        return calendar->ops->to_jdn(year, month, day) - 0.5;  // A registered calendar
+
+    return calendar->to_jd(year, month, day);
+}
+
+// JD_TO_YMD: Calculate the date in any calendar from Julian day, Gregorian for an unknown one
+
+void jd_to_ymd(double jd, dc_calendar_t calendar_type, int *year, int *month, int *day)
+{
+    const calendar_t *calendar = calendar_of(calendar_type);
+    int jdn;
+
+    if(!calendar)
+        jd_to_gregorian(jd, year, month, day);
+    else if(calendar->from_jd)
+        calendar->from_jd(jd, year, month, day);
+    else if(jd_to_jdn(jd, &jdn))
+        calendar->ops->from_jdn(jdn, year, month, day);  // A registered calendar
+    else
+        *year = *month = *day = 0;
+}
+
+#ifdef DC_EMBEDDED
+
+// WEEKDAY_JD: Day of the week (0 = Sunday) of a Julian day, without libm
+
+int weekday_jd(double jd)
+{
+    return floor_mod(jd_floor(jd + 1.5), 7);
+}
+
+#endif
+
+const char *weekday_str(int i)
+{
+    static const char *weekdays[] = {"Sunday", "Monday", "Tuesday", "Wednesday", "Thursday", "Friday", "Saturday"};
+    return weekdays[abs(i) % 7];
+}
+
+const char *weekday_jd_str(double jd)
+{
+    return weekday_str(weekday_jd(jd));
+}
+
+int weekday_ymd(int year, int month, int day, dc_calendar_t calendar_type)
+{
+    return weekday_jd(ymd_to_jd(year, month, day, calendar_type));
+}
+
+const char *weekday_ymd_str(int year, int month, int day, dc_calendar_t calendar_type)
+{
+    return weekday_str(weekday_ymd(year, month, day, calendar_type));
+}
+
+// check_date_ldom() returns:
+// 0: Successful
+// 1: Error: Select the type of the calendar correctly.
+// 2: Error: Enter the year correctly (between -81739 and 213719).
+// 3: Error: This calendar has no year zero (0).
+// 4: Error: Enter the month correctly (between 1 and 12).
+// 5: Error: Enter the month correctly (between 1 and 13).
+// 6: Error: This year doesn't have 13 months (in Hebrew calendar).
+// 7: Error: Enter the day correctly (greater than 0).
+// 8: Error: This month of this year has *last_day_of_month days.
+// 9: Error: This month has *last_day_of_month days.
+// 10: Error: Enter the month correctly (between 0 and 19).
+// 11: Error: Enter the year correctly (between DC_PERSIAN_TABLE_FIRST and DC_PERSIAN_TABLE_LAST),
+//     in the embedded profile only, for a Persian year outside its table.
+
+int check_date_ldom(int year, int month, int day, dc_calendar_t calendar_type, int *last_day_of_month)
+{
+    const calendar_t *calendar = calendar_of(calendar_type);
+    const dc_calendar_ops_t *ops;
+    int hym;
+
+    *last_day_of_month = 0;
+
+    if(!calendar)
+        return 1;  // 1: Error: Select the type of the calendar correctly.
+    ops = calendar->ops;
+
+    if(year < -81739 || year > 213719)
+        return 2;  // 2: Error: Enter the year correctly (between -81739 and 213719).
+
+#ifdef DC_EMBEDDED
+    if(calendar_type == DC_PER && !persian_table_has(year))
+        return 11;  // 11: Error: Enter the year correctly (between DC_PERSIAN_TABLE_FIRST and DC_PERSIAN_TABLE_LAST).
+#endif
+
+    if(year == 0 && ops->no_year_zero)
+        return 3;  // 3: Error: This calendar has no year zero (0).
+
+    hym = ops->year_months ? ops->year_months(year) : ops->max_months;
+    if(month == 13 && ops->max_months == 13 && hym != 13)
+        return 6;  // 6: Error: This year doesn't have 13 months (in Hebrew calendar).
+    if(month < ops->min_month || month > hym)  // Badi' month 0: Ayyam-i-Ha
+        return !ops->min_month ? 10 : (hym == 13) ? 5 : 4;  // 10: (between 0 and 19); 5: (between 1 and 13); 4: (between 1 and 12).
+
+    if(day < 1)
+        return 7;  // 7: Error: Enter the day correctly (greater than 0).
+
+    *last_day_of_month = ops->month_days(year, month);
+    if(day > *last_day_of_month)
+        return (ops->variable_months >> month & 1) ? 8 : 9;  // 8: Error: This month of this year has *last_day_of_month days.
+                                                              // 9: Error: This month has *last_day_of_month days.
+    return 0;  // 0: Successful
+}
+
+/* CHECK_DATE_LDOM_BUF  --  check_date_ldom() with the message of the
+                            error, or "" for a valid date, written to a
+                            buffer of the caller and truncated to its
+                            size; nothing is allocated. */
+
+int check_date_ldom_buf(int year, int month, int day, dc_calendar_t calendar_type, int *last_day_of_month,
+                        char *buf, size_t size)
+{
+    static const char *error_msgs[] = {
+        "",
+        "Error: Select the type of the calendar correctly.",
+        "Error: Enter the year correctly (between -81739 and 213719).",
+        "Error: This calendar has no year zero (0).",
+        "Error: Enter the month correctly (between 1 and 12).",
+        "Error: Enter the month correctly (between 1 and 13).",
+        "Error: This year doesn't have 13 months (in Hebrew calendar).",
+        "Error: Enter the day correctly (greater than 0).",
+        "Error: This month of this year has dd days.",
+        "Error: This month has dd days.",
+        "Error: Enter the month correctly (between 0 and 19).",
+#ifdef DC_EMBEDDED
+        "Error: Enter the year correctly (between " DC_STR(DC_PERSIAN_TABLE_FIRST) " and " DC_STR(DC_PERSIAN_TABLE_LAST) ")."
+#endif
+    };
+
+    const char *error_msg;
+    int error_code;
+    size_t i;
+
+    error_code = check_date_ldom(year, month, day, calendar_type, last_day_of_month);
+    if(!size)
+        return error_code;
+
+    error_msg = error_msgs[error_code];
+    for(i = 0; (i + 1) < size && error_msg[i]; i++)
+        buf[i] = error_msg[i];
+    buf[i] = '\0';
+
+    // Fill in the "dd" of the message where it was not truncated
+    if(error_code == 8 && i > 36)
+    {
+        buf[35] = '0' + *last_day_of_month / 10;
+        buf[36] = '0' + *last_day_of_month % 10;
+    }
+    else if(error_code == 9 && i > 23)
+    {
+        buf[22] = '0' + *last_day_of_month / 10;
+        buf[23] = '0' + *last_day_of_month % 10;
+    }
+
+    return error_code;
+}
+
+#ifndef DC_EMBEDDED
+
+int check_date_ldom_str(int year, int month, int day, dc_calendar_t calendar_type, int *last_day_of_month, char **error_str)
+{
+    char error_msg[64];
+    int error_code;
+
+    if(!(error_code = check_date_ldom_buf(year, month, day, calendar_type, last_day_of_month, error_msg, sizeof(error_msg))))
+    {
+        *error_str = NULL;
+        return error_code;  // 0: Successful
+    }
+
+    if(!(*error_str = (char *)malloc((strlen(error_msg) + 1) * sizeof(char))))
+        return error_code;
+
+    // strcpy(*error_str, error_msg);
+    str_copy_unsafe(*error_str, error_msg);
+
+    return error_code;
+}
+
+int check_date_str(int year, int month, int day, dc_calendar_t calendar_type, char **error_str)
+{
+    int last_day_of_month;
+    return check_date_ldom_str(year, month, day, calendar_type, &last_day_of_month, error_str);
+}
+
+#endif  // DC_EMBEDDED
+
+int check_date(int year, int month, int day, dc_calendar_t calendar_type)
+{
+    int last_day_of_month;
+    return check_date_ldom(year, month, day, calendar_type, &last_day_of_month);
+}
+
+const char *norm_leap_str(int is_leap_year)
+{
+    static const char *nl[] = {"Normal Year", "Leap Year"};
+    return nl[!!is_leap_year];
+}
+
+// ****************************************************************************************** //
+
+void persian_to_gregorian(int *year, int *month, int *day)
+{
+    jd_to_gregorian(persian_to_jd(*year, *month, *day), year, month, day);
+}
+
+void persian_to_islamic(int *year, int *month, int *day)
+{
+    jd_to_islamic(persian_to_jd(*year, *month, *day), year, month, day);
+}
+
+#ifndef DC_EMBEDDED
+
+void persian_to_hebrew(int *year, int *month, int *day)
+{
+    jd_to_hebrew(persian_to_jd(*year, *month, *day), year, month, day);
+}
+
+#endif
+
+void persian_to_julian(int *year, int *month, int *day)
+{
+    jd_to_julian(persian_to_jd(*year, *month, *day), year, month, day);
+}
+
+void persian_to_persianb(int *year, int *month, int *day)
+{
+    jd_to_persianb(persian_to_jd(*year, *month, *day), year, month, day);
+}
+
+void gregorian_to_persian(int *year, int *month, int *day)
+{
+    jd_to_persian(gregorian_to_jd(*year, *month, *day), year, month, day);
+}
+
+void gregorian_to_islamic(int *year, int *month, int *day)
+{
+    convert_direct(gregorian_to_jdn, jdn_to_islamic, gregorian_to_jd, jd_to_islamic, year, month, day);
+}
+
+#ifndef DC_EMBEDDED
+
+void gregorian_to_hebrew(int *year, int *month, int *day)
+{
+    jd_to_hebrew(gregorian_to_jd(*year, *month, *day), year, month, day);
+}
+
+#endif
+
+void gregorian_to_julian(int *year, int *month, int *day)
+{
+    convert_direct(gregorian_to_jdn, jdn_to_julian, gregorian_to_jd, jd_to_julian, year, month, day);
+}
+
+void gregorian_to_persianb(int *year, int *month, int *day)
+{
+    convert_direct(gregorian_to_jdn, jdn_to_persianb, gregorian_to_jd, jd_to_persianb, year, month, day);
+}
+
+void islamic_to_persian(int *year, int *month, int *day)
+{
+    jd_to_persian(islamic_to_jd(*year, *month, *day), year, month, day);
+}
+
+void islamic_to_gregorian(int *year, int *month, int *day)
+{
+    convert_direct(islamic_to_jdn, jdn_to_gregorian, islamic_to_jd, jd_to_gregorian, year, month, day);
+}
+
+#ifndef DC_EMBEDDED
+
+void islamic_to_hebrew(int *year, int *month, int *day)
+{
+    jd_to_hebrew(islamic_to_jd(*year, *month, *day), year, month, day);
+}
+
+#endif
+
+void islamic_to_julian(int *year, int *month, int *day)
+{
+    convert_direct(islamic_to_jdn, jdn_to_julian, islamic_to_jd, jd_to_julian, year, month, day);
+}
+
+void islamic_to_persianb(int *year, int *month, int *day)
+{
+    convert_direct(islamic_to_jdn, jdn_to_persianb, islamic_to_jd, jd_to_persianb, year, month, day);
+}
+
+#ifndef DC_EMBEDDED
+
+void hebrew_to_persian(int *year, int *month, int *day)
+{
+    jd_to_persian(hebrew_to_jd(*year, *month, *day), year, month, day);
+}
+
+void hebrew_to_gregorian(int *year, int *month, int *day)
+{
+    jd_to_gregorian(hebrew_to_jd(*year, *month, *day), year, month, day);
+}
+
+void hebrew_to_islamic(int *year, int *month, int *day)
+{
+    jd_to_islamic(hebrew_to_jd(*year, *month, *day), year, month, day);
+}
+
+void hebrew_to_julian(int *year, int *month, int *day)
+{
+    jd_to_julian(hebrew_to_jd(*year, *month, *day), year, month, day);
+}
+
+void hebrew_to_persianb(int *year, int *month, int *day)
+{
+    jd_to_persianb(hebrew_to_jd(*year, *month, *day), year, month, day);
+}
+
+#endif
+
+void julian_to_persian(int *year, int *month, int *day)
+{
+    jd_to_persian(julian_to_jd(*year, *month, *day), year, month, day);
+}
+
+void julian_to_gregorian(int *year, int *month, int *day)
+{
+    convert_direct(julian_to_jdn, jdn_to_gregorian, julian_to_jd, jd_to_gregorian, year, month, day);
+}
+
+void julian_to_islamic(int *year, int *month, int *day)
+{
+    convert_direct(julian_to_jdn, jdn_to_islamic, julian_to_jd, jd_to_islamic, year, month, day);
+}
+
+#ifndef DC_EMBEDDED
+
+void julian_to_hebrew(int *year, int *month, int *day)
+{
+    jd_to_hebrew(julian_to_jd(*year, *month, *day), year, month, day);
+}
+
+#endif
+
+void julian_to_persianb(int *year, int *month, int *day)
+{
+    convert_direct(julian_to_jdn, jdn_to_persianb, julian_to_jd, jd_to_persianb, year, month, day);
+}
+
+void persianb_to_persian(int *year, int *month, int *day)
+{
+    jd_to_persian(persianb_to_jd(*year, *month, *day), year, month, day);
+}
+
+void persianb_to_gregorian(int *year, int *month, int *day)
+{
+    convert_direct(persianb_to_jdn, jdn_to_gregorian, persianb_to_jd, jd_to_gregorian, year, month, day);
+}
+
+void persianb_to_islamic(int *year, int *month, int *day)
+{
+    convert_direct(persianb_to_jdn, jdn_to_islamic, persianb_to_jd, jd_to_islamic, year, month, day);
+}
+
+#ifndef DC_EMBEDDED
+
+void persianb_to_hebrew(int *year, int *month, int *day)
+{
+    jd_to_hebrew(persianb_to_jd(*year, *month, *day), year, month, day);
+}
+
+#endif
+
+void persianb_to_julian(int *year, int *month, int *day)
+{
+    convert_direct(persianb_to_jdn, jdn_to_julian, persianb_to_jd, jd_to_julian, year, month, day);
+}
+
+#ifndef DC_EMBEDDED
+
+void persian_to_ummalqura(int *year, int *month, int *day)
+{
+    jd_to_ummalqura(persian_to_jd(*year, *month, *day), year, month, day);
+}
+
+void gregorian_to_ummalqura(int *year, int *month, int *day)
+{
+    jd_to_ummalqura(gregorian_to_jd(*year, *month, *day), year, month, day);
+}
+
+void islamic_to_ummalqura(int *year, int *month, int *day)
+{
+    jd_to_ummalqura(islamic_to_jd(*year, *month, *day), year, month, day);
+}
+
+void hebrew_to_ummalqura(int *year, int *month, int *day)
+{
+    jd_to_ummalqura(hebrew_to_jd(*year, *month, *day), year, month, day);
+}
+
+void julian_to_ummalqura(int *year, int *month, int *day)
+{
+    jd_to_ummalqura(julian_to_jd(*year, *month, *day), year, month, day);
+}
+
+void persianb_to_ummalqura(int *year, int *month, int *day)
+{
+    jd_to_ummalqura(persianb_to_jd(*year, *month, *day), year, month, day);
+}
+
+void ummalqura_to_persian(int *year, int *month, int *day)
+{
+    jd_to_persian(ummalqura_to_jd(*year, *month, *day), year, month, day);
+}
+
+void ummalqura_to_gregorian(int *year, int *month, int *day)
+{
+    jd_to_gregorian(ummalqura_to_jd(*year, *month, *day), year, month, day);
+}
+
+void ummalqura_to_islamic(int *year, int *month, int *day)
+{
+    jd_to_islamic(ummalqura_to_jd(*year, *month, *day), year, month, day);
+}
+
+void ummalqura_to_hebrew(int *year, int *month, int *day)
+{
+    jd_to_hebrew(ummalqura_to_jd(*year, *month, *day), year, month, day);
+}
+
+void ummalqura_to_julian(int *year, int *month, int *day)
+{
+    jd_to_julian(ummalqura_to_jd(*year, *month, *day), year, month, day);
+}
+
+void ummalqura_to_persianb(int *year, int *month, int *day)
+{
+    jd_to_persianb(ummalqura_to_jd(*year, *month, *day), year, month, day);
+}
+
+#endif
+
+// ****************************************************************************************** //
+
+int *persian_to_gregorian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_gregorian(persian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *persian_to_islamic_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_islamic(persian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+#ifndef DC_EMBEDDED
+
+int *persian_to_hebrew_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_hebrew(persian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+#endif
+
+int *persian_to_julian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_julian(persian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *persian_to_persianb_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_persianb(persian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *gregorian_to_persian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_persian(gregorian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *gregorian_to_islamic_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_islamic(gregorian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+#ifndef DC_EMBEDDED
+
+int *gregorian_to_hebrew_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_hebrew(gregorian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+#endif
+
+int *gregorian_to_julian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_julian(gregorian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *gregorian_to_persianb_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_persianb(gregorian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *islamic_to_persian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_persian(islamic_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *islamic_to_gregorian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_gregorian(islamic_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+#ifndef DC_EMBEDDED
+
+int *islamic_to_hebrew_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_hebrew(islamic_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+#endif
+
+int *islamic_to_julian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_julian(islamic_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *islamic_to_persianb_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_persianb(islamic_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+#ifndef DC_EMBEDDED
+
+int *hebrew_to_persian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_persian(hebrew_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *hebrew_to_gregorian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_gregorian(hebrew_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *hebrew_to_islamic_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_islamic(hebrew_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *hebrew_to_julian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_julian(hebrew_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *hebrew_to_persianb_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_persianb(hebrew_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+#endif
+
+int *julian_to_persian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_persian(julian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *julian_to_gregorian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_gregorian(julian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *julian_to_islamic_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_islamic(julian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+#ifndef DC_EMBEDDED
+
+int *julian_to_hebrew_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_hebrew(julian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+#endif
+
+int *julian_to_persianb_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_persianb(julian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *persianb_to_persian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_persian(persianb_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *persianb_to_gregorian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_gregorian(persianb_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *persianb_to_islamic_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_islamic(persianb_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+#ifndef DC_EMBEDDED
+
+int *persianb_to_hebrew_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_hebrew(persianb_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+#endif
+
+int *persianb_to_julian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_julian(persianb_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+#ifndef DC_EMBEDDED
+
+int *persian_to_ummalqura_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_ummalqura(persian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *gregorian_to_ummalqura_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_ummalqura(gregorian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *islamic_to_ummalqura_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_ummalqura(islamic_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *hebrew_to_ummalqura_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_ummalqura(hebrew_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *julian_to_ummalqura_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_ummalqura(julian_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *persianb_to_ummalqura_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_ummalqura(persianb_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *ummalqura_to_persian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_persian(ummalqura_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *ummalqura_to_gregorian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_gregorian(ummalqura_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *ummalqura_to_islamic_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_islamic(ummalqura_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *ummalqura_to_hebrew_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_hebrew(ummalqura_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *ummalqura_to_julian_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_julian(ummalqura_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+int *ummalqura_to_persianb_arr(int year, int month, int day, int result_ymd[])
+{
+    jd_to_persianb(ummalqura_to_jd(year, month, day), &result_ymd[0], &result_ymd[1], &result_ymd[2]);
+    return result_ymd;
+}
+
+#endif
+
+#ifndef DC_EMBEDDED
+// ****************************************************************************************** //
+// /////////////////////////////////      YEAR LAYOUT       ///////////////////////////////// //
+
+// Does a given calendar skip from year -1 straight to year 1?
+
+static int calendar_no_year_zero(dc_calendar_t calendar_type)
+{
+    const dc_calendar_ops_t *ops = dc_calendar_ops(calendar_type);
+    return ops && ops->no_year_zero;
+}
+
+// Is a calendar known and do its months fit a year layout (months 1-13; not Badi')?
+
+static int calendar_has_layout(dc_calendar_t calendar_type)
+{
+    const dc_calendar_ops_t *ops = dc_calendar_ops(calendar_type);
+    return ops && ops->min_month == 1 && ops->max_months <= 13;
+}
+
+// Julian day number of a date, as the layouts count days
+
+static int calendar_jdn(dc_calendar_t calendar_type, int year, int month, int day)
+{
+    return (int)floor(ymd_to_jd(year, month, day, calendar_type) + 0.5);
+}
+
+// Successor and predecessor of a year, stepping over year 0 where it doesn't exist
+
+static int calendar_next_year(dc_calendar_t calendar_type, int year)
+{
+    return (year == -1 && calendar_no_year_zero(calendar_type)) ? 1 : year + 1;
+}
+
+// Map a year onto a gap-free scale, and back
+
+static int calendar_year_index(dc_calendar_t calendar_type, int year)
+{
+    return (year < 0 && calendar_no_year_zero(calendar_type)) ? year + 1 : year;
+}
+
+static int calendar_index_year(dc_calendar_t calendar_type, int index)
+{
+    return (index <= 0 && calendar_no_year_zero(calendar_type)) ? index - 1 : index;
+}
+
+// Month number of the i-th (zero-based) month of a year, in chronological order: from first_month on, then from 1
+
+static inline int layout_month_at(const dc_year_layout_t *layout, int i)
+{
+    int first = calendar_first_month(layout->calendar);
+    int tail = layout->months - first + 1;  // Months from the first one to the end of the numbering
+
+    return (i < tail) ? first + i : i - tail + 1;
+}
+
+/* DC_YEAR_LAYOUT  --  Compute the first day and length of every month
+                       of a year in a single pass.  Only the year
+                       boundaries are obtained from the calendar; the
+                       month lengths inside the year follow from the
+                       rules of the calendar, so for most calendars the
+                       whole year costs about as much as two *_to_jd()
+                       calls (Hebrew: two Tishrei lookups); the other
+                       calendars of the registry give their month
+                       lengths.  Returns the error code of check_date() for
+                       the year (0: Successful), or 1 for a calendar of
+                       more than 13 months (Badi'). */
+
+int dc_year_layout(int year, dc_calendar_t calendar_type, dc_year_layout_t *layout)
+{
+    const dc_calendar_ops_t *ops;
+    int error_code, last_day_of_month, month, prev, next_start, year_days, leap, i;
+
+    if((error_code = check_date_ldom(year, 1, 1, calendar_type, &last_day_of_month)))
+        return error_code;
+    if(!calendar_has_layout(calendar_type))
+        return 1;  // 1: No layout of its months
+
+    layout->calendar = calendar_type;
+    layout->year = year;
+    layout->month_start[0] = layout->month_days[0] = 0;
+
+    if(calendar_type == DC_HEB)
+    {
+        // The Hebrew year begins with Tishrei (7); Nisan (1) comes after Adar
+        layout->start = (int)floor(hebrew_to_jd(year, 7, 1) + 0.5);
+        next_start = (int)floor(hebrew_to_jd(year + 1, 7, 1) + 0.5);
+        year_days = next_start - layout->start;
+        leap = leap_hebrew(year);
+
+        layout->months = leap ? 13 : 12;
+        layout->month_days[7] = 30;
+        layout->month_days[8] = (year_days % 10 == 5) ? 30 : 29;
+        layout->month_days[9] = (year_days % 10 == 3) ? 29 : 30;
+        layout->month_days[10] = 29;
+        layout->month_days[11] = 30;
+        layout->month_days[12] = leap ? 30 : 29;
+        layout->month_days[13] = leap ? 29 : 0;
+        for(month = 1; month <= 6; month++)
+            layout->month_days[month] = (month & 1) ? 30 : 29;
+
+        layout->month_start[7] = layout->start;
+        for(month = 8; month <= layout->months; month++)
+            layout->month_start[month] = layout->month_start[month - 1] + layout->month_days[month - 1];
+        layout->month_start[1] = layout->month_start[layout->months] + layout->month_days[layout->months];
+        for(month = 2; month <= 6; month++)
+            layout->month_start[month] = layout->month_start[month - 1] + layout->month_days[month - 1];
+        if(!leap)
+            layout->month_start[13] = 0;
+    }
+    else
+    {
+        ops = dc_calendar_ops(calendar_type);
+        layout->months = ops->year_months ? ops->year_months(year) : ops->max_months;
+        layout->start = calendar_jdn(calendar_type, year, ops->first_month, 1);
+        next_start = calendar_jdn(calendar_type, calendar_next_year(calendar_type, year), ops->first_month, 1);
+
+        switch(calendar_type)
+        {
+            case DC_PER:
+            case DC_PER_B:
+            case DC_PER_AF:
+                // Six months of 31 days, five of 30, and the remainder in Esfand
+                for(month = 1; month < 12; month++)
+                    layout->month_days[month] = (month <= 6) ? 31 : 30;
+                break;
+            case DC_ISM:
+                // Alternating months of 30 and 29 days, and the remainder in Dhu al-Hijjah
+                for(month = 1; month < 12; month++)
+                    layout->month_days[month] = (month & 1) ? 30 : 29;
+                break;
+            default:
+                for(month = 1; month <= layout->months; month++)
+                    layout->month_days[month] = ops->month_days(year, month);
+                break;
+        }
+
+        // Chain the months in chronological order; the last one runs to the next year
+        layout->month_start[month = ops->first_month] = layout->start;
+        for(i = 1; i < layout->months; i++)
+        {
+            prev = month;
+            month = layout_month_at(layout, i);
+            layout->month_start[month] = layout->month_start[prev] + layout->month_days[prev];
+        }
+        layout->month_days[month] = next_start - layout->month_start[month];
+        for(month = layout->months + 1; month <= 13; month++)
+            layout->month_start[month] = layout->month_days[month] = 0;
+    }
+
+    layout->days = next_start - layout->start;
+    return 0;  // 0: Successful
+}
+
+// /////////////////////////////////      YEAR LAYOUT       ///////////////////////////////// //
+// ****************************************************************************************** //
+// ****************************************************************************************** //
+// /////////////////////////////////     ORDINAL DATES      ///////////////////////////////// //
+
+// Days before each month of a common Gregorian or Julian year
+
+static const short common_days_before[13] = {0, 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+
+// Julian day number of the first day of a year (Hebrew: 1 Tishrei)
+
+static int ordinal_year_start(int year, dc_calendar_t calendar_type)
+{
+    return calendar_jdn(calendar_type, year, calendar_first_month(calendar_type), 1);
+}
+
+/* ORDINAL_MONTH_OFFSET  --  Days of a year before the first of a given
+                             month.  The calendars whose months follow a
+                             fixed rule need at most their leap year
+                             rule; the others read their year layout,
+                             or count days from the start of the year
+                             if their months don't fit one. */
+
+static int ordinal_month_offset(int year, int month, dc_calendar_t calendar_type)
+{
+    dc_year_layout_t layout;
+
+    switch(calendar_type)
+    {
+        case DC_PER:
+        case DC_PER_B:
+        case DC_PER_AF:
+            return (month <= 7) ? ((month - 1) * 31) : (((month - 1) * 30) + 6);
+        case DC_GRE:
+            return common_days_before[month] + (month > 2 && leap_gregorian(year));
+        case DC_JUL:
+            return common_days_before[month] + (month > 2 && leap_julian(year));
+        case DC_ISM:
+            return ceil_div(59 * (month - 1), 2);
+        default:
+            if(!calendar_has_layout(calendar_type))
+                return calendar_jdn(calendar_type, year, month, 1) - ordinal_year_start(year, calendar_type);
+            dc_year_layout(year, calendar_type, &layout);
+            return layout.month_start[month] - layout.start;
+    }
+}
+
+// ORDINAL_YEAR_DAYS: Length of a year, from the length of its last month where the others are fixed (0: invalid year)
+
+static int ordinal_year_days(int year, dc_calendar_t calendar_type)
+{
+    dc_year_layout_t layout;
+
+    switch(calendar_type)
+    {
+        case DC_PER:
+            return 336 + persian_month_days(year, 12);
+        case DC_PER_B:
+            return 336 + persianb_month_days(year, 12);
+        case DC_PER_AF:
+            return 336 + afghan_month_days(year, 12);
+        case DC_GRE:
+            return 365 + leap_gregorian(year);
+        case DC_JUL:
+            return 365 + leap_julian(year);
+        case DC_ISM:
+            return 325 + islamic_month_days(year, 12);
+        default:
+            if(!calendar_has_layout(calendar_type))
+                return ordinal_year_start(calendar_next_year(calendar_type, year), calendar_type) -
+                       ordinal_year_start(year, calendar_type);
+            return dc_year_layout(year, calendar_type, &layout) ? 0 : layout.days;
+    }
+}
+
+// Check_date() of the first day of a year
+
+static int ordinal_year_ok(int year, dc_calendar_t calendar_type)
+{
+    int last_day_of_month;
+    return check_date_ldom(year, 1, 1, calendar_type, &last_day_of_month);
+}
+
+/* DC_DAY_OF_YEAR  --  Day of the year of a date, 1 for the first day
+                       (Hebrew: 1 Tishrei).  Returns the error code of
+                       check_date() (0: Successful). */
+
+int dc_day_of_year(int year, int month, int day, dc_calendar_t calendar_type, int *day_of_year)
+{
+    int error_code, last_day_of_month;
+
+    if((error_code = check_date_ldom(year, month, day, calendar_type, &last_day_of_month)))
+        return error_code;
+
+    *day_of_year = ordinal_month_offset(year, month, calendar_type) + day;
+    return 0;  // 0: Successful
+}
+
+/* DC_FROM_ORDINAL  --  Month and day of the n-th day of a year.
+                        Returns the error code of check_date() for the
+                        year, or -1 if the year has no such day. */
+
+int dc_from_ordinal(int year, int day_of_year, dc_calendar_t calendar_type, int *month, int *day)
+{
+    dc_year_layout_t layout;
+    int error_code, yday, leap, y, m, i;
+
+    if((error_code = ordinal_year_ok(year, calendar_type)))
+        return error_code;
+
+    if(day_of_year < 1 || day_of_year > ordinal_year_days(year, calendar_type))
+        return -1;  // ERROR: The day must be within the year
+
+    switch(calendar_type)
+    {
+        case DC_PER:
+        case DC_PER_B:
+        case DC_PER_AF:
+            m = (day_of_year <= 186) ? ceil_div(day_of_year, 31) : ceil_div(day_of_year - 6, 30);
+            break;
+        case DC_GRE:
+        case DC_JUL:
+            // As jdn_to_gregorian(); the Julian months are the same
+            yday = day_of_year - 1;
+            leap = (calendar_type == DC_GRE) ? leap_gregorian(year) : leap_julian(year);
+            m = floor_div(((yday + ((yday < 59 + leap) ? 0 : (leap ? 1 : 2))) * 12) + 373, 367);
+            break;
+        case DC_ISM:
+            m = ceil_div(2 * (day_of_year - 30), 59) + 1;
+            m = (m < 12) ? m : 12;
+            break;
+        default:
+            if(!calendar_has_layout(calendar_type))
+            {
+                // The date of the day itself, counted from the first day of the year
+                dc_calendar_ops(calendar_type)->from_jdn(ordinal_year_start(year, calendar_type) + day_of_year - 1, &y, month, day);
+                return 0;  // 0: Successful
+            }
+            // The last month, in chronological order, that begins on or before the day
+            dc_year_layout(year, calendar_type, &layout);
+            for(i = layout.months - 1; layout.month_start[m = layout_month_at(&layout, i)] - layout.start >= day_of_year; i--)
+                ;
+            *month = m;
+            *day = day_of_year - (layout.month_start[m] - layout.start);
+            return 0;  // 0: Successful
+    }
+
+    *month = m;
+    *day = day_of_year - ordinal_month_offset(year, m, calendar_type);
+    return 0;  // 0: Successful
+}
+
+// Is a week numbering rule well formed?
+
+static int week_rule_ok(const dc_week_rule_t *rule)
+{
+    return rule && rule->first_weekday >= 0 && rule->first_weekday <= 6 && rule->min_days >= 1 && rule->min_days <= 7;
+}
+
+// First day of week 1 of a year starting on a given day: the start of the week holding its min_days-th day
+
+static int week_one_start(int year_start, const dc_week_rule_t *rule)
+{
+    int jdn = year_start + rule->min_days - 1;
+    return jdn - floor_mod(jdn + 1 - rule->first_weekday, 7);
+}
+
+/* DC_WEEKS_IN_YEAR  --  Number of weeks, 52 or 53 (Hebrew up to 55),
+                         of a week-numbering year.  Returns the error
+                         code of check_date() for the year, or -1 for a
+                         malformed rule. */
+
+int dc_weeks_in_year(int week_year, dc_calendar_t calendar_type, const dc_week_rule_t *rule, int *weeks)
+{
+    int error_code, start;
+
+    if(!week_rule_ok(rule))
+        return -1;  // ERROR: Malformed week numbering rule
+    if((error_code = ordinal_year_ok(week_year, calendar_type)))
+        return error_code;
+
+    start = ordinal_year_start(week_year, calendar_type);
+    *weeks = (week_one_start(start + ordinal_year_days(week_year, calendar_type), rule) - week_one_start(start, rule)) / 7;
+    return 0;  // 0: Successful
+}
+
+/* DC_WEEK_DATE  --  Week date of a date under a week numbering rule:
+                     the week-numbering year, which differs from the
+                     year of the date in the days before week 1 and
+                     after the last week, the week (1 = first) and the
+                     day of the week (1 = rule->first_weekday).
+                     Returns the error code of check_date(), or -1 for
+                     a malformed rule. */
+
+int dc_week_date(int year, int month, int day, dc_calendar_t calendar_type, const dc_week_rule_t *rule,
+                 int *week_year, int *week, int *week_day)
+{
+    int error_code, day_of_year, start, jdn, first, next;
+
+    if(!week_rule_ok(rule))
+        return -1;  // ERROR: Malformed week numbering rule
+    if((error_code = dc_day_of_year(year, month, day, calendar_type, &day_of_year)))
+        return error_code;
+
+    start = ordinal_year_start(year, calendar_type);
+    jdn = start + day_of_year - 1;
+    first = week_one_start(start, rule);
+    *week_year = year;
+
+    if(jdn < first)
+    {
+        // The last week of the previous year
+        *week_year = calendar_index_year(calendar_type, calendar_year_index(calendar_type, year) - 1);
+        first = week_one_start(start - ordinal_year_days(*week_year, calendar_type), rule);
+    }
+    else if(jdn >= (next = week_one_start(start + ordinal_year_days(year, calendar_type), rule)))
+    {
+        // Week 1 of the next year
+        *week_year = calendar_next_year(calendar_type, year);
+        first = next;
+    }
+
+    *week = (jdn - first) / 7 + 1;
+    *week_day = floor_mod(jdn + 1 - rule->first_weekday, 7) + 1;
+    return 0;  // 0: Successful
+}
+
+/* DC_FROM_WEEK_DATE  --  Date of a week date under a week numbering
+                          rule.  Returns the error code of check_date()
+                          for the week-numbering year, or -1 for a
+                          malformed rule or a week or day of the week
+                          outside the year. */
+
+int dc_from_week_date(int week_year, int week, int week_day, dc_calendar_t calendar_type, const dc_week_rule_t *rule,
+                      int *year, int *month, int *day)
+{
+    int error_code, weeks, start, jdn, y, year_days;
+
+    if((error_code = dc_weeks_in_year(week_year, calendar_type, rule, &weeks)))
+        return error_code;
+    if(week < 1 || week > weeks || week_day < 1 || week_day > 7)
+        return -1;  // ERROR: The week and the day of the week must be within the year
+
+    start = ordinal_year_start(week_year, calendar_type);
+    jdn = week_one_start(start, rule) + ((week - 1) * 7) + (week_day - 1);
+    y = week_year;
+
+    if(jdn < start)
+    {
+        y = calendar_index_year(calendar_type, calendar_year_index(calendar_type, y) - 1);
+        start -= ordinal_year_days(y, calendar_type);
+    }
+    else if(jdn >= start + (year_days = ordinal_year_days(y, calendar_type)))
+    {
+        y = calendar_next_year(calendar_type, y);
+        start += year_days;
+    }
+
+    *year = y;
+    return dc_from_ordinal(y, jdn - start + 1, calendar_type, month, day);
+}
+
+// /////////////////////////////////     ORDINAL DATES      ///////////////////////////////// //
+// ****************************************************************************************** //
+// ****************************************************************************************** //
+// /////////////////////////////////      MONTH INDEX       ///////////////////////////////// //
+
+/* The first day of every month of the calendars whose dates are slow
+   to find from a Julian day (the astronomical Persian and the Hebrew
+   calendars), over the calendar years that cover the Gregorian years
+   DC_MONTH_INDEX_FIRST to DC_MONTH_INDEX_FIRST + DC_MONTH_INDEX_YEARS - 1.
+   A calendar's index is built on its first lookup and published with
+   a compare-and-swap; a thread that loses the race frees its copy.
+   The months are kept in Eytzinger order (the implicit binary tree of
+   a heap, node k with children 2k and 2k + 1), so the top levels of
+   every search share a few cache lines.  The keys are padded to a
+   perfect tree with INT_MAX, so every search takes the same number of
+   steps and the loop branch is always predicted. */
+
+#define DC_MONTH_INDEX_FIRST 1900
+#define DC_MONTH_INDEX_YEARS 200
+
+typedef struct MonthIndex
+{
+    int first;      // First day of the first month
+    int end;        // Day after the last month
+    int n;          // Number of months
+    int height;     // Levels of the tree, 2^height > n
+    int *key;       // [1..2^height - 1] in Eytzinger order: first day of the month, INT_MAX past n
+    int *label;     // [1..n] in the same order: year * 16 + month
+} month_index_t;
+
+static month_index_t *month_indexes[DC_CALENDARS];  // NULL until the first lookup
+
+// Calendar year in which a Gregorian year begins, near enough to step from
+
+static int month_index_year(dc_calendar_t calendar_type, int gregorian_year)
+{
+    switch(calendar_type)
+    {
+        case DC_HEB:
+            return gregorian_year + 3760;
+        default:
+            return gregorian_year - 622;  // Persian
+    }
+}
+
+// Fill the subtree of node k in order from the sorted months, starting at the i-th; returns the next i
+
+static int month_index_fill(month_index_t *index, const int *start, const int *label, int i, int k)
+{
+    if(k <= index->n)
+    {
+        i = month_index_fill(index, start, label, i, 2 * k);
+        index->key[k] = start[i];
+        index->label[k] = label[i++];
+        i = month_index_fill(index, start, label, i, 2 * k + 1);
+    }
+    return i;
+}
+
+static month_index_t *month_index_build(dc_calendar_t calendar_type)
+{
+    dc_year_layout_t layout;
+    month_index_t *index;
+    int *start, *label;
+    int first_jdn, end_jdn, year, n, i, m, height;
+
+    first_jdn = (int)floor(gregorian_to_jd(DC_MONTH_INDEX_FIRST, 1, 1) + 0.5);
+    end_jdn = (int)floor(gregorian_to_jd(DC_MONTH_INDEX_FIRST + DC_MONTH_INDEX_YEARS, 1, 1) + 0.5);
+
+    // Step to the calendar year holding the first day of the window
+    year = month_index_year(calendar_type, DC_MONTH_INDEX_FIRST);
+    if(dc_year_layout(year, calendar_type, &layout))
+        return NULL;
+    while(layout.start > first_jdn && !dc_year_layout(--year, calendar_type, &layout));
+    while(layout.start + layout.days <= first_jdn && !dc_year_layout(++year, calendar_type, &layout));
+
+    n = (DC_MONTH_INDEX_YEARS + 2) * 13;
+    start = (int *)malloc(n * sizeof(int));
+    label = (int *)malloc(n * sizeof(int));
+    if(!start || !label)
+    {
+        free(start);
+        free(label);
+        return NULL;
+    }
+
+    n = 0;
+    do
+    {
+        for(i = 0; i < layout.months; i++)
+        {
+            m = layout_month_at(&layout, i);
+            start[n] = layout.month_start[m];
+            label[n++] = year * 16 + m;
+        }
+    } while(layout.start + layout.days < end_jdn && !dc_year_layout(++year, calendar_type, &layout));
+
+    for(height = 1; (1 << height) <= n; height++);
+    if((index = (month_index_t *)malloc(sizeof(month_index_t) + ((1 << height) + n + 1) * sizeof(int))))
+    {
+        index->first = start[0];
+        index->end = layout.start + layout.days;
+        index->n = n;
+        index->height = height;
+        index->key = (int *)(index + 1);
+        index->label = index->key + (1 << height);
+        for(i = 0; i < (1 << height); i++)
+            index->key[i] = INT_MAX;
+        index->label[0] = 0;
+        month_index_fill(index, start, label, 0, 1);
+    }
+
+    free(start);
+    free(label);
+    return index;
+}
+
+static int month_index_ymd(dc_calendar_t calendar_type, double jd, int *year, int *month, int *day)
+{
+    month_index_t *index, *expected = NULL;
+    int jdn, k, h;
+
+    if(!DC_JDN_JD_OK(jd))
+        return 0;
+
+    if(!(index = __atomic_load_n(&month_indexes[calendar_type], __ATOMIC_ACQUIRE)))
+    {
+        if(!(index = month_index_build(calendar_type)))
+            return 0;
+        if(!__atomic_compare_exchange_n(&month_indexes[calendar_type], &expected, index, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            free(index);
+            index = expected;
+        }
+    }
+
+    jdn = (int)floor(jd) + 1;
+    if(jdn < index->first || jdn >= index->end)
+        return 0;
+
+    /* Descend to the left while the month starts after the day, to the
+       right otherwise; the last node left to the right is the month of
+       the day.  Dropping the trailing left turns and that right turn
+       from the path gives its node. */
+
+    k = 1;
+    for(h = 0; h < index->height; h++)
+        k = 2 * k + (index->key[k] <= jdn);
+    k >>= __builtin_ffs(k);
+
+    *year = index->label[k] >> 4;
+    *month = index->label[k] & 15;
+    *day = jdn - index->key[k] + 1;
+    return 1;
+}
+
+/* MONTH_INDEX_DROP  --  Discard the index of a calendar whose dates
+                         have changed (a new ephemeris); it is rebuilt
+                         on the next lookup.  Not safe while other
+                         threads convert dates of the calendar. */
+
+static void month_index_drop(dc_calendar_t calendar_type)
+{
+    free(__atomic_exchange_n(&month_indexes[calendar_type], NULL, __ATOMIC_ACQ_REL));
+}
+
+// /////////////////////////////////      MONTH INDEX       ///////////////////////////////// //
+// ****************************************************************************************** //
+// /////////////////////////////////       RECURRENCE       ///////////////////////////////// //
+
+/* Expansion of yearly and monthly rules in the calendar of the rule,
+   after the RSCALE extension of iCalendar (RFC 7529).  A day missing
+   from a month (Esfand 30 in a common year, Dhu al-Hijjah 30) and a
+   month missing from a year (Adar II in a common Hebrew year) are
+   resolved by the rule's skip policy:
+
+       DC_SKIP_OMIT       No occurrence in that period
+       DC_SKIP_BACKWARD   Previous existing day (or month)
+       DC_SKIP_FORWARD    Next existing day (or month)  */
+
+// Running month number of the first month (chronologically) of a year; other calendars count max_months a year
+
+static long recur_year_month_index(dc_calendar_t calendar_type, int year)
+{
+    if(calendar_type == DC_HEB)
+        return (long)floor(((235 * (double)year) - 234) / 19);  // Months elapsed before Tishrei
+    return (long)dc_calendar_ops(calendar_type)->max_months * calendar_year_index(calendar_type, year);
+}
+
+// Chronological position of a month within its year, -1 if the year lacks it
+
+static int recur_month_position(const dc_year_layout_t *layout, int month)
+{
+    int first = calendar_first_month(layout->calendar);
+
+    if(month < 1 || month > layout->months)
+        return -1;
+    return (month >= first) ? month - first : month + layout->months - first;
+}
+
+/* RECUR_DAY  --  Julian day number of the rule's day in a given month
+                  of the layout, applying the skip policy.  Returns 0
+                  when the occurrence is omitted. */
+
+static int recur_day(const dc_recur_t *rule, const dc_year_layout_t *layout, int month)
+{
+    int start = layout->month_start[month];
+    int days = layout->month_days[month];
+    int offset = (rule->day > 0) ? rule->day - 1 : days + rule->day;
+
+    if(offset >= 0 && offset < days)
+        return start + offset;
+
+    switch(rule->skip)
+    {
+        case DC_SKIP_BACKWARD:
+            return (offset < 0) ? start - 1 : start + days - 1;
+        case DC_SKIP_FORWARD:
+            return (offset < 0) ? start : start + days;
+        default:
+            return 0;
+    }
+}
+
+static int recur_valid(const dc_recur_t *rule)
+{
+    int max_month;
+
+    if(check_date(rule->year, 1, 1, rule->calendar) || !calendar_has_layout(rule->calendar))
+        return 0;
+    max_month = dc_calendar_ops(rule->calendar)->max_months;
+    if(rule->freq != DC_YEARLY && rule->freq != DC_MONTHLY)
+        return 0;
+    if(rule->skip != DC_SKIP_OMIT && rule->skip != DC_SKIP_BACKWARD && rule->skip != DC_SKIP_FORWARD)
+        return 0;
+    if(rule->interval < 1 || rule->month < 1 || rule->month > max_month)
+        return 0;
+    if(rule->day == 0 || rule->day < -31 || rule->day > 31)
+        return 0;
+    return 1;
+}
+
+/* DC_RECUR_EXPAND  --  Expand a recurrence rule into the Julian day
+                        numbers of its occurrences between start_jdn
+                        and end_jdn (inclusive), in ascending order.
+                        Periods before the rule's anchor (year, and
+                        for DC_MONTHLY also month) are not expanded.
+                        At most max_count days are stored in result;
+                        the return value is the total number of
+                        occurrences in the range, or -1 if the rule
+                        is invalid. */
+
+int dc_recur_expand(const dc_recur_t *rule, int start_jdn, int end_jdn, int result[], int max_count)
+{
+    dc_year_layout_t layout;
+    int year, month, day, first_year, i, jdn, last_jdn, count;
+    long anchor, index;
+
+    if(!recur_valid(rule))
+        return -1;
+
+    count = 0;
+    last_jdn = 0;
+    if(start_jdn > end_jdn)
+        return count;
+
+    // A skipped day can move an occurrence across a year boundary, so begin one year early
+    jd_to_ymd(start_jdn - 0.5, rule->calendar, &year, &month, &day);
+    first_year = calendar_index_year(rule->calendar, calendar_year_index(rule->calendar, year) - 1);
+    if(calendar_year_index(rule->calendar, first_year) < calendar_year_index(rule->calendar, rule->year))
+        first_year = rule->year;
+    if(first_year < -81739)
+        first_year = -81739;
+
+    if(rule->freq == DC_YEARLY)
+    {
+        anchor = calendar_year_index(rule->calendar, rule->year);
+        index = calendar_year_index(rule->calendar, first_year);
+        index = anchor + ((index - anchor + rule->interval - 1) / rule->interval) * rule->interval;
+
+        for(; index <= 213719; index += rule->interval)
+        {
+            if(dc_year_layout(calendar_index_year(rule->calendar, (int)index), rule->calendar, &layout))
+                break;
+            if(layout.start - 1 > end_jdn)
+                break;
+
+            month = rule->month;
+            if(month > layout.months)
+            {
+                if(rule->skip == DC_SKIP_OMIT)
+                    continue;
+                month = (rule->skip == DC_SKIP_BACKWARD) ? layout.months : 1;
+            }
+
+            if(!(jdn = recur_day(rule, &layout, month)) || jdn < start_jdn || jdn > end_jdn || jdn == last_jdn)
+                continue;
+            if(count < max_count)
+                result[count] = jdn;
+            count++;
+            last_jdn = jdn;
+        }
+    }
+    else
+    {
+        if(dc_year_layout(rule->year, rule->calendar, &layout) || (i = recur_month_position(&layout, rule->month)) < 0)
+            return -1;
+        anchor = recur_year_month_index(rule->calendar, rule->year) + i;
+
+        for(year = first_year; year <= 213719; year = calendar_next_year(rule->calendar, year))
+        {
+            if(dc_year_layout(year, rule->calendar, &layout))
+                break;
+            if(layout.start - 1 > end_jdn)
+                break;
+
+            index = recur_year_month_index(rule->calendar, year);
+            for(i = 0; i < layout.months; i++)
+            {
+                if(index + i < anchor || (index + i - anchor) % rule->interval)
+                    continue;
+
+                month = layout_month_at(&layout, i);
+                if(!(jdn = recur_day(rule, &layout, month)) || jdn < start_jdn || jdn > end_jdn || jdn == last_jdn)
+                    continue;
+                if(count < max_count)
+                    result[count] = jdn;
+                count++;
+                last_jdn = jdn;
+            }
+        }
+    }
+
+    return count;
+}
+
+// /////////////////////////////////       RECURRENCE       ///////////////////////////////// //
+// ****************************************************************************************** //
+// /////////////////////////////////        HOLIDAYS        ///////////////////////////////// //
+
+/* Holiday rules are fixed dates in the calendar that defines them,
+   optionally spanning several days and moved off certain weekdays.
+   The id of a rule is its bit in the index, so a set holds at most
+   64 distinct holidays; a holiday whose observance rules changed
+   over time is written as several rules sharing one id. */
+
+// shift[] is indexed by weekday of the nominal date: Sun, Mon, Tue, Wed, Thu, Fri, Sat
+#define DC_NO_SHIFT {0, 0, 0, 0, 0, 0, 0}
+
+/* Official holidays of Iran.  The lunar dates follow the Umm al-Qura
+   calendar; the dates announced each year from sightings of the
+   crescent may differ from them by a day. */
+
+static const dc_holiday_t holidays_iran[] =
+{
+    { 0, "Nowruz",                         DC_PER,     1,  1, 4, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    { 1, "Islamic Republic Day",           DC_PER,     1, 12, 1, DC_SKIP_OMIT,     1358,    0, DC_NO_SHIFT},
+    { 2, "Nature Day",                     DC_PER,     1, 13, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    { 3, "Death of Imam Khomeini",         DC_PER,     3, 14, 1, DC_SKIP_OMIT,     1369,    0, DC_NO_SHIFT},
+    { 4, "Revolt of Khordad 15",           DC_PER,     3, 15, 1, DC_SKIP_OMIT,     1358,    0, DC_NO_SHIFT},
+    { 5, "Revolution Day",                 DC_PER,    11, 22, 1, DC_SKIP_OMIT,     1358,    0, DC_NO_SHIFT},
+    { 6, "Oil Nationalization Day",        DC_PER,    12, 29, 1, DC_SKIP_OMIT,     1330,    0, DC_NO_SHIFT},
+    { 7, "Tasua",                          DC_ISM_UQ,  1,  9, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    { 8, "Ashura",                         DC_ISM_UQ,  1, 10, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    { 9, "Arbaeen",                        DC_ISM_UQ,  2, 20, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    {10, "Demise of the Prophet",          DC_ISM_UQ,  2, 28, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    {11, "Martyrdom of Imam Reza",         DC_ISM_UQ,  2, -1, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    {12, "Martyrdom of Imam Hasan Askari", DC_ISM_UQ,  3,  8, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    {13, "Birth of the Prophet",           DC_ISM_UQ,  3, 17, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    {14, "Martyrdom of Fatimah",           DC_ISM_UQ,  6,  3, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    {15, "Birth of Imam Ali",              DC_ISM_UQ,  7, 13, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    {16, "Mab'ath",                        DC_ISM_UQ,  7, 27, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    {17, "Birth of Imam Mahdi",            DC_ISM_UQ,  8, 15, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    {18, "Martyrdom of Imam Ali",          DC_ISM_UQ,  9, 21, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    {19, "Eid al-Fitr",                    DC_ISM_UQ, 10,  1, 2, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    {20, "Martyrdom of Imam Sadiq",        DC_ISM_UQ, 10, 25, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    {21, "Eid al-Adha",                    DC_ISM_UQ, 12, 10, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    {22, "Eid al-Ghadir",                  DC_ISM_UQ, 12, 18, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT}
+};
+
+/* Holidays and memorial days of Israel.  Month 13 with a backward
+   skip is Adar II in leap years and Adar otherwise.  Memorial and
+   Independence Days move away from the Sabbath, and since 5764 also
+   off Sunday evenings; Yom HaShoah and Tisha B'Av avoid the Sabbath. */
+
+static const dc_holiday_t holidays_israel[] =
+{
+    { 0, "Rosh Hashanah",                  DC_HEB,     7,  1, 2, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    { 1, "Yom Kippur",                     DC_HEB,     7, 10, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    { 2, "Sukkot",                         DC_HEB,     7, 15, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    { 3, "Shemini Atzeret",                DC_HEB,     7, 22, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    { 4, "Hanukkah",                       DC_HEB,     9, 25, 8, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    { 5, "Purim",                          DC_HEB,    13, 14, 1, DC_SKIP_BACKWARD,    0,    0, DC_NO_SHIFT},
+    { 6, "Pesach",                         DC_HEB,     1, 15, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    { 7, "Seventh day of Pesach",          DC_HEB,     1, 21, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    { 8, "Yom HaShoah",                    DC_HEB,     1, 27, 1, DC_SKIP_OMIT,     5711,    0, {1, 0, 0, 0, 0, -1, 0}},
+    { 9, "Yom HaZikaron",                  DC_HEB,     2,  4, 1, DC_SKIP_OMIT,     5708, 5763, {0, 0, 0, 0, -1, -2, 0}},
+    { 9, "Yom HaZikaron",                  DC_HEB,     2,  4, 1, DC_SKIP_OMIT,     5764,    0, {1, 0, 0, 0, -1, -2, 0}},
+    {10, "Yom HaAtzmaut",                  DC_HEB,     2,  5, 1, DC_SKIP_OMIT,     5708, 5763, {0, 0, 0, 0, 0, -1, -2}},
+    {10, "Yom HaAtzmaut",                  DC_HEB,     2,  5, 1, DC_SKIP_OMIT,     5764,    0, {0, 1, 0, 0, 0, -1, -2}},
+    {11, "Yom Yerushalayim",               DC_HEB,     2, 28, 1, DC_SKIP_OMIT,     5728,    0, DC_NO_SHIFT},
+    {12, "Shavuot",                        DC_HEB,     3,  6, 1, DC_SKIP_OMIT,        0,    0, DC_NO_SHIFT},
+    {13, "Tisha B'Av",                     DC_HEB,     5,  9, 1, DC_SKIP_OMIT,        0,    0, {0, 0, 0, 0, 0, 0, 1}}
+};
+
+static const dc_holiday_set_t holiday_sets[] =
+{
+    {"IR", holidays_iran, (int)(sizeof(holidays_iran) / sizeof(holidays_iran[0]))},
+    {"IL", holidays_israel, (int)(sizeof(holidays_israel) / sizeof(holidays_israel[0]))}
+};
+
+// DC_HOLIDAY_SET: Built-in rule set of a country, by ISO 3166 code ("IR", "IL")
+
+const dc_holiday_set_t *dc_holiday_set(const char *country)
+{
+    size_t i;
+
+    for(i = 0; i < sizeof(holiday_sets) / sizeof(holiday_sets[0]); i++)
+        if(!strcmp(holiday_sets[i].country, country))
+            return &holiday_sets[i];
+    return NULL;
+}
+
+// DC_HOLIDAY_NAME: Name of a holiday of a set by its id
+
+const char *dc_holiday_name(const dc_holiday_set_t *set, int id)
+{
+    int i;
+
+    for(i = 0; i < set->count; i++)
+        if(set->rules[i].id == id)
+            return set->rules[i].name;
+    return NULL;
+}
+
+static int holiday_day_cmp(const void *a, const void *b)
+{
+    int x = ((const dc_holiday_day_t *)a)->jdn, y = ((const dc_holiday_day_t *)b)->jdn;
+    return (x > y) - (x < y);
+}
+
+/* HOLIDAY_EXPAND  --  Append the days of one rule that fall between
+                       first_jdn and last_jdn to days[].  Returns the
+                       new number of days, or -1 if the rule is
+                       invalid or memory runs out. */
+
+static int holiday_expand(const dc_holiday_t *h, int first_jdn, int last_jdn, dc_holiday_day_t **days, int count, int *capacity)
+{
+    dc_year_layout_t layout;
+    dc_recur_t rule;
+    dc_holiday_day_t *grown;
+    int *nominal;
+    int year, month, day, end_jdn, n, i, k, jdn, length;
+
+    // Shifts and multi-day holidays reach a few days past their nominal date
+    length = (h->length > 1) ? h->length : 1;
+    jd_to_ymd(first_jdn - length - 2.5, h->calendar, &year, &month, &day);
+
+    rule.calendar = h->calendar;
+    rule.freq = DC_YEARLY;
+    rule.interval = 1;
+    rule.year = (h->first_year && h->first_year > year) ? h->first_year : year;
+    rule.month = h->month;
+    rule.day = h->day;
+    rule.skip = h->skip;
+
+    end_jdn = last_jdn + 2;
+    if(h->last_year)
+    {
+        if(dc_year_layout(h->last_year, h->calendar, &layout))
+            return -1;
+        if(layout.start + layout.days - 1 < end_jdn)
+            end_jdn = layout.start + layout.days - 1;
+    }
+
+    if(end_jdn < first_jdn - length - 2)
+        return count;
+
+    // A year has at least 353 days, so one nominal date per 353 days plus the ends
+    n = (end_jdn - first_jdn + length + 2) / 353 + 2;
+    if(!(nominal = (int *)malloc(n * sizeof(int))))
+        return -1;
+    if((n = dc_recur_expand(&rule, first_jdn - length - 2, end_jdn, nominal, n)) < 0)
+    {
+        free(nominal);
+        return -1;
+    }
+
+    for(i = 0; i < n; i++)
+    {
+        jdn = nominal[i] + h->shift[weekday_jd(nominal[i] - 0.5)];
+        for(k = 0; k < length; k++, jdn++)
+        {
+            if(jdn < first_jdn || jdn > last_jdn)
+                continue;
+            if(count == *capacity)
+            {
+                *capacity = *capacity ? 2 * *capacity : 64;
+                if(!(grown = (dc_holiday_day_t *)realloc(*days, *capacity * sizeof(dc_holiday_day_t))))
+                {
+                    free(nominal);
+                    return -1;
+                }
+                *days = grown;
+            }
+            (*days)[count].jdn = jdn;
+            (*days)[count].holidays = 1ULL << h->id;
+            count++;
+        }
+    }
+
+    free(nominal);
+    return count;
+}
+
+/* DC_HOLIDAY_INDEX_BUILD  --  Evaluate every rule of a set over the
+                               Gregorian years first_year..last_year
+                               and build the index of holidays: the
+                               sorted holiday days, each with the
+                               bitset of holiday ids falling on it,
+                               and a bitmap of the span with running
+                               counts per word, so that membership and
+                               lookup take constant time.  Returns 0,
+                               or -1 on invalid input or when memory
+                               runs out. */
+
+int dc_holiday_index_build(const dc_holiday_set_t *set, int first_year, int last_year, dc_holiday_index_t *index)
+{
+    dc_holiday_day_t *days = NULL;
+    int i, n, count, capacity, span, words, offset;
+
+    index->days = NULL;
+    index->bitmap = NULL;
+    index->rank = NULL;
+    index->count = 0;
+
+    if(first_year > last_year || check_date(first_year, 1, 1, DC_GRE) || check_date(last_year, 12, 31, DC_GRE))
+        return -1;
+
+    index->set = set;
+    index->first_jdn = (int)floor(gregorian_to_jd(first_year, 1, 1) + 0.5);
+    index->last_jdn = (int)floor(gregorian_to_jd(last_year, 12, 31) + 0.5);
+
+    count = capacity = 0;
+    for(i = 0; i < set->count; i++)
+    {
+        if(set->rules[i].id < 0 || set->rules[i].id > 63)
+            count = -1;
+        else
+            count = holiday_expand(&set->rules[i], index->first_jdn, index->last_jdn, &days, count, &capacity);
+        if(count < 0)
+        {
+            free(days);
+            return -1;
+        }
+    }
+
+    // Merge the holidays falling on the same day
+    qsort(days, count, sizeof(dc_holiday_day_t), holiday_day_cmp);
+    for(i = n = 0; i < count; i++)
+    {
+        if(n && days[n - 1].jdn == days[i].jdn)
+            days[n - 1].holidays |= days[i].holidays;
+        else
+            days[n++] = days[i];
+    }
+
+    span = index->last_jdn - index->first_jdn + 1;
+    words = (span + 63) / 64;
+    index->bitmap = (unsigned long long *)calloc(words, sizeof(unsigned long long));
+    index->rank = (int *)malloc((words + 1) * sizeof(int));
+    if(!index->bitmap || !index->rank)
+    {
+        free(days);
+        dc_holiday_index_free(index);
+        return -1;
+    }
+
+    for(i = 0; i < n; i++)
+    {
+        offset = days[i].jdn - index->first_jdn;
+        index->bitmap[offset >> 6] |= 1ULL << (offset & 63);
+    }
+    index->rank[0] = 0;
+    for(i = 0; i < words; i++)
+        index->rank[i + 1] = index->rank[i] + __builtin_popcountll(index->bitmap[i]);
+
+    index->days = days;
+    index->count = n;
+    return 0;
+}
+
+void dc_holiday_index_free(dc_holiday_index_t *index)
+{
+    free(index->days);
+    free(index->bitmap);
+    free(index->rank);
+    index->days = NULL;
+    index->bitmap = NULL;
+    index->rank = NULL;
+    index->count = 0;
+}
+
+// Number of holiday days of the index before a day of its span
+
+static int holiday_rank(const dc_holiday_index_t *index, int offset)
+{
+    return index->rank[offset >> 6] + __builtin_popcountll(index->bitmap[offset >> 6] & ((1ULL << (offset & 63)) - 1));
+}
+
+/* DC_HOLIDAYS_ON  --  Bitset of the holidays (1 << id) falling on a
+                       Julian day number, 0 for a working day or a
+                       day outside the index. */
+
+unsigned long long dc_holidays_on(const dc_holiday_index_t *index, int jdn)
+{
+    int offset = jdn - index->first_jdn;
+
+    if(offset < 0 || jdn > index->last_jdn || !((index->bitmap[offset >> 6] >> (offset & 63)) & 1))
+        return 0;
+    return index->days[holiday_rank(index, offset)].holidays;
+}
+
+/* DC_HOLIDAY_NEXT  --  First holiday of the index strictly after a
+                        Julian day number; returns its Julian day
+                        number and stores its holidays in *holidays
+                        (if not NULL), or returns 0 if none follows
+                        within the index. */
+
+int dc_holiday_next(const dc_holiday_index_t *index, int jdn, unsigned long long *holidays)
+{
+    int i;
+
+    if(jdn < index->first_jdn)
+        i = 0;
+    else if(jdn >= index->last_jdn)
+        return 0;
+    else
+        i = holiday_rank(index, jdn + 1 - index->first_jdn);
+
+    if(i >= index->count)
+        return 0;
+    if(holidays)
+        *holidays = index->days[i].holidays;
+    return index->days[i].jdn;
+}
+
+// /////////////////////////////////        HOLIDAYS        ///////////////////////////////// //
+// ****************************************************************************************** //
+// /////////////////////////////////     BUSINESS DAYS      ///////////////////////////////// //
+
+/* A business-day calendar keeps one bit per day of a span of Gregorian
+   years, set for the days that are neither weekend nor holiday, with
+   the number of business days before every 64-day word (rank) and the
+   word holding every 64th business day (select).  Counting is then a
+   difference of two ranks, and stepping n business days a rank plus a
+   select; both take constant time. */
+
+// BDAY_RANK: Number of business days in the span before a given offset
+
+static int bday_rank(const dc_bday_t *bd, int offset)
+{
+    return bd->rank[offset >> 6] + __builtin_popcountll(bd->bitmap[offset >> 6] & ((1ULL << (offset & 63)) - 1));
+}
+
+// BDAY_SELECT: Offset of the business day preceded by r others in the span
+
+static int bday_select(const dc_bday_t *bd, int r)
+{
+    unsigned long long word;
+    int w, k, bits, offset;
+
+    // Every word holds a business day or more, so the run ends a few words on
+    for(w = bd->select[r >> 6]; bd->rank[w + 1] <= r; w++)
+        ;
+
+    word = bd->bitmap[w];
+    k = r - bd->rank[w];
+    for(offset = w << 6; (bits = __builtin_popcountll(word & 0xff)) <= k; offset += 8)
+    {
+        k -= bits;
+        word >>= 8;
+    }
+    while(k--)
+        word &= word - 1;
+
+    return offset + __builtin_ctzll(word);
+}
+
+/* DC_BDAY_BUILD  --  Build the business-day calendar of the Gregorian
+                      years first_year..last_year.  Bit w of weekend
+                      is set if weekday w (0 = Sunday) is a day off;
+                      holidays may be NULL.  Returns 0, or -1 on
+                      invalid input or when memory runs out. */
+
+int dc_bday_build(unsigned weekend, const dc_holiday_index_t *holidays, int first_year, int last_year, dc_bday_t *bd)
+{
+    int i, span, words, weekday, offset, next;
+
+    bd->bitmap = NULL;
+    bd->rank = NULL;
+    bd->select = NULL;
+    bd->count = 0;
+
+    if(first_year > last_year || check_date(first_year, 1, 1, DC_GRE) || check_date(last_year, 12, 31, DC_GRE) || (weekend & 0x7f) == 0x7f)
+        return -1;
+
+    bd->weekend = weekend & 0x7f;
+    bd->first_jdn = (int)floor(gregorian_to_jd(first_year, 1, 1) + 0.5);
+    bd->last_jdn = (int)floor(gregorian_to_jd(last_year, 12, 31) + 0.5);
+
+    span = bd->last_jdn - bd->first_jdn + 1;
+    words = (span + 63) / 64;
+    bd->bitmap = (unsigned long long *)calloc(words, sizeof(unsigned long long));
+    bd->rank = (int *)malloc((words + 1) * sizeof(int));
+    if(!bd->bitmap || !bd->rank)
+    {
+        dc_bday_free(bd);
+        return -1;
+    }
+
+    weekday = weekday_jd(bd->first_jdn - 0.5);
+    for(offset = 0; offset < span; offset++, weekday = (weekday == 6) ? 0 : weekday + 1)
+        if(!((bd->weekend >> weekday) & 1))
+            bd->bitmap[offset >> 6] |= 1ULL << (offset & 63);
+
+    if(holidays)
+    {
+        for(i = 0; i < holidays->count; i++)
+        {
+            offset = holidays->days[i].jdn - bd->first_jdn;
+            if(offset >= 0 && offset < span)
+                bd->bitmap[offset >> 6] &= ~(1ULL << (offset & 63));
+        }
+    }
+
+    bd->rank[0] = 0;
+    for(i = 0; i < words; i++)
+        bd->rank[i + 1] = bd->rank[i] + __builtin_popcountll(bd->bitmap[i]);
+    bd->count = bd->rank[words];
+
+    if(!(bd->select = (int *)malloc(((bd->count >> 6) + 1) * sizeof(int))))
+    {
+        dc_bday_free(bd);
+        return -1;
+    }
+    for(i = next = 0; i < words; i++)
+        for(; next < bd->rank[i + 1]; next += 64)
+            bd->select[next >> 6] = i;
+
+    return 0;
+}
+
+void dc_bday_free(dc_bday_t *bd)
+{
+    free(bd->bitmap);
+    free(bd->rank);
+    free(bd->select);
+    bd->bitmap = NULL;
+    bd->rank = NULL;
+    bd->select = NULL;
+    bd->count = 0;
+}
+
+// DC_BDAY_IS: Is a Julian day number a business day? (-1: outside the calendar)
+
+int dc_bday_is(const dc_bday_t *bd, int jdn)
+{
+    int offset = jdn - bd->first_jdn;
+
+    if(offset < 0 || jdn > bd->last_jdn)
+        return -1;
+    return (int)((bd->bitmap[offset >> 6] >> (offset & 63)) & 1);
+}
+
+/* DC_BDAY_COUNT  --  Number of business days from from_jdn up to, but
+                      not including, to_jdn; negative if to_jdn comes
+                      first.  Returns 0, or -1 if a day lies outside
+                      the calendar (to_jdn may be one past its end). */
+
+int dc_bday_count(const dc_bday_t *bd, int from_jdn, int to_jdn, int *count)
+{
+    int span = bd->last_jdn - bd->first_jdn + 1;
+    int from = from_jdn - bd->first_jdn, to = to_jdn - bd->first_jdn;
+
+    if(from < 0 || from > span || to < 0 || to > span)
+        return -1;
+
+    *count = ((to == span) ? bd->count : bday_rank(bd, to)) - ((from == span) ? bd->count : bday_rank(bd, from));
+    return 0;
+}
+
+/* DC_BDAY_ADD  --  The n-th business day after a Julian day number,
+                    or before it if n is negative; n = 0 leaves the
+                    day unchanged.  Returns 0, or -1 if the day or
+                    the result lies outside the calendar. */
+
+int dc_bday_add(const dc_bday_t *bd, int jdn, int n, int *result_jdn)
+{
+    int offset = jdn - bd->first_jdn;
+    long r;
+
+    if(offset < 0 || jdn > bd->last_jdn)
+        return -1;
+    if(!n)
+    {
+        *result_jdn = jdn;
+        return 0;
+    }
+
+    // r: business days of the span before the target
+    r = (long)bday_rank(bd, offset) + n;
+    if(n > 0)
+        r += ((bd->bitmap[offset >> 6] >> (offset & 63)) & 1) - 1;
+    if(r < 0 || r >= bd->count)
+        return -1;
+
+    *result_jdn = bd->first_jdn + bday_select(bd, (int)r);
+    return 0;
+}
+
+// Business-day arithmetic on dates of any calendar; errors as check_date(), or -1 outside the calendar
+
+int dc_bday_add_ymd(const dc_bday_t *bd, int *year, int *month, int *day, dc_calendar_t calendar_type, int n)
+{
+    int error_code, jdn;
+
+    if((error_code = check_date(*year, *month, *day, calendar_type)))
+        return error_code;
+    if(dc_bday_add(bd, (int)floor(ymd_to_jd(*year, *month, *day, calendar_type) + 0.5), n, &jdn))
+        return -1;
+
+    jd_to_ymd(jdn - 0.5, calendar_type, year, month, day);
+    return 0;
+}
+
+int dc_bday_count_ymd(const dc_bday_t *bd, int from_year, int from_month, int from_day,
+                      int to_year, int to_month, int to_day, dc_calendar_t calendar_type, int *count)
+{
+    int error_code;
+
+    if((error_code = check_date(from_year, from_month, from_day, calendar_type)) ||
+       (error_code = check_date(to_year, to_month, to_day, calendar_type)))
+        return error_code;
+
+    return dc_bday_count(bd, (int)floor(ymd_to_jd(from_year, from_month, from_day, calendar_type) + 0.5),
+                         (int)floor(ymd_to_jd(to_year, to_month, to_day, calendar_type) + 0.5), count);
+}
+
+// /////////////////////////////////     BUSINESS DAYS      ///////////////////////////////// //
+// ****************************************************************************************** //
+// /////////////////////////////////    BATCH VALIDATION    ///////////////////////////////// //
+
+#define DC_CHECK_YEAR_CACHE 256  // Years whose month lengths one dc_check_date_n() call keeps
+
+// Month lengths of one year, as kept by dc_check_date_n()
+typedef struct
+{
+    int year;
+    unsigned char month_days[14];
+} check_year_t;
+
+/* CHECK_RULES  --  Rules of the first pass for a calendar.  A month
+                   has a fixed length unless the calendar marks it
+                   in variable_months or some years lack it (month 13
+                   of a calendar with year_months). */
+
+static void check_rules(const dc_calendar_ops_t *ops, check_rules_t *rules)
+{
+    int m, ldom;
+
+    rules->max_months = ops->max_months;
+    rules->no_year_zero = ops->no_year_zero;
+    for(m = 0; m < 32; m++)
+    {
+        rules->fixed_days[m] = 0;
+        if(m < 1 || m > ops->max_months || (ops->variable_months >> m & 1) || (ops->year_months && m == 13))
+            continue;
+        if((ldom = ops->month_days(1, m)) > 0)
+            rules->fixed_days[m] = ldom;
+    }
+}
+
+/* Pass 1: range checks and months of fixed length, with branch-free
+   arithmetic and a lookup the compiler can vectorize.  Rows left for
+   pass 2 are marked with error code -1; *pending receives their
+   number. */
+
+DC_KERNEL void check_date_pass1(const int *restrict year, const int *restrict month, const int *restrict day, size_t n,
+                                const check_rules_t *restrict rules, int *restrict error_code, int *restrict last_day_of_month,
+                                size_t *pending)
+{
+    const int max_month = rules->max_months, no_zero = rules->no_year_zero;
+    const int *fixed_days = rules->fixed_days;
+    size_t i, left = 0;
+    int y, m, d, fixed, ok;
+
+    for(i = 0; i < n; i++)
+    {
+        y = year[i];
+        m = month[i];
+        d = day[i];
+        fixed = fixed_days[m & 31];
+        ok = ((unsigned)(y + 81739) <= (unsigned)(213719 + 81739)) & ((y != 0) | !no_zero) &
+             ((unsigned)(m - 1) < (unsigned)max_month) & (d >= 1) & (d <= fixed);
+        error_code[i] = ok - 1;
+        last_day_of_month[i] = ok ? fixed : 0;
+        left += !ok;
+    }
+
+    *pending = left;
+}
+
+DC_ISA_VARIANTS(check_date_pass1,
+                (const int *year, const int *month, const int *day, size_t n, const check_rules_t *rules,
+                 int *error_code, int *last_day_of_month, size_t *pending),
+                (year, month, day, n, rules, error_code, last_day_of_month, pending))
+
+/* DC_CHECK_DATE_N  --  Validate n dates held in separate year, month
+                        and day arrays, as check_date_ldom() would.
+                        For each row, error_code[] receives 0-10 and
+                        last_day_of_month[] the length of the month,
+                        or 0 where an error was found before the month
+                        length was known (codes 1-7 and 10).  Returns the
+                        number of invalid rows.
+
+   A first pass checks the ranges of all rows and settles every date of
+   a month whose length never varies (all but Esfand, February, Dhu
+   al-Hijjah and so on) with branch-free arithmetic the compiler can
+   vectorize.  The remaining rows take their month lengths from the
+   calendar's month_days(), called once per year for the whole call. */
+
+size_t dc_check_date_n(const int *restrict year, const int *restrict month, const int *restrict day, size_t n,
+                       dc_calendar_t calendar_type, int *restrict error_code, int *restrict last_day_of_month)
+{
+    check_year_t cache[DC_CHECK_YEAR_CACHE];
+    check_year_t *entry;
+    const dc_calendar_ops_t *ops = dc_calendar_ops(calendar_type);
+    check_rules_t rules;
+    size_t i, invalid;
+    int y, m, d, ldom, slot, months, layouts = calendar_has_layout(calendar_type);
+
+    if(!ops)
+    {
+        for(i = 0; i < n; i++)
+        {
+            error_code[i] = 1;  // 1: Error: Select the type of the calendar correctly.
+            last_day_of_month[i] = 0;
+        }
+        return n;
+    }
+
+    check_rules(ops, &rules);
+    isa_kernels()->check_date_pass1(year, month, day, n, &rules, error_code, last_day_of_month, &invalid);
+
+    if(!invalid)
+        return 0;
+
+    // Pass 2: months whose length depends on the year, and rows out of range
+    for(slot = 0; slot < DC_CHECK_YEAR_CACHE; slot++)
+        cache[slot].month_days[0] = 0;  // Empty slot
+
+    invalid = 0;
+    for(i = 0; i < n; i++)
+    {
+        if(error_code[i] != -1)
+            continue;
+
+        y = year[i];
+        m = month[i];
+        d = day[i];
+
+        if(!layouts)
+        {
+            // More months than a year layout holds (Badi'): row by row
+            if((error_code[i] = check_date_ldom(y, m, d, calendar_type, &last_day_of_month[i])))
+                invalid++;
+            continue;
+        }
+
+        if(y < -81739 || y > 213719 || (y == 0 && ops->no_year_zero) || m < 1 || m > ops->max_months || d < 1)
+        {
+            error_code[i] = check_date_ldom(y, m, d, calendar_type, &ldom);  // 2-7 are settled before ldom
+            invalid++;
+            continue;
+        }
+
+        entry = &cache[(unsigned)y % DC_CHECK_YEAR_CACHE];
+        if(!entry->month_days[0] || entry->year != y)
+        {
+            months = ops->year_months ? ops->year_months(y) : ops->max_months;
+            entry->year = y;
+            entry->month_days[0] = 1;
+            for(slot = 1; slot <= 13; slot++)
+                entry->month_days[slot] = (slot <= months) ? (unsigned char)ops->month_days(y, slot) : 0;
+        }
+
+        if(!(ldom = entry->month_days[m]))
+        {
+            error_code[i] = 6;  // 6: Error: This year doesn't have 13 months (in Hebrew calendar).
+            invalid++;
+            continue;
+        }
+
+        last_day_of_month[i] = ldom;
+        if(d <= ldom)
+        {
+            error_code[i] = 0;
+            continue;
+        }
+
+        error_code[i] = (ops->variable_months >> m & 1) ? 8 : 9;
+        invalid++;
+    }
+
+    return invalid;
+}
+
+// /////////////////////////////////    BATCH VALIDATION    ///////////////////////////////// //
+// ****************************************************************************************** //
+// /////////////////////////////////      ARROW KERNELS     ///////////////////////////////// //
+
+/* Conversion of Apache Arrow date32 columns (days since 1970-01-01)
+   to and from year, month and day columns of any calendar, working
+   on the Arrow buffers in place.  As in Arrow, a validity bitmap holds
+   one bit per slot, least significant bit first, set for a non-null
+   value; a NULL bitmap means no nulls, and offset is the position of
+   the first slot in both the values and the bitmap.  Outputs start at
+   slot 0; null slots hold 0.  A date outside the years the library
+   accepts (check_date()) or not a valid date becomes null. */
+
+static const int DATE32_JDN = 2440588;  // Julian day number of 1970-01-01
+
+#define DC_DATE32_CACHE 16   // Year layouts kept by one kernel call
+#define DC_DATE32_BLOCK 256  // Gregorian rows converted at a time by the vectorized kernels
+
+/* Howard Hinnant's civil_from_days() and days_from_civil() for the
+   proleptic Gregorian calendar, on a block of rows without branches so
+   that the loops vectorize.  Values are clamped into [first, last] (the
+   bounds of check_date() as date32); rows outside are nulled by the
+   caller.  Days and years are shifted by whole 400-year eras to be
+   non-negative, as unsigned division by a constant vectorizes even with
+   plain SSE2. */
+
+#define DATE32_DAY_ERAS   400  // Eras added to day numbers, enough to lift check_date()'s first day above 0
+#define DATE32_YEAR_ERAS  205  // Eras added to years, likewise for its first year
+
+DC_KERNEL void date32_to_gregorian_block(const int32_t *values, int n, int first, int last,
+                                         int32_t *year, int32_t *month, int32_t *day)
+{
+    unsigned z, era, doe, yoe, doy, mp;
+    int i, v, m;
+
+    for(i = 0; i < n; i++)
+    {
+        v = values[i];
+        z = (unsigned)(((v < first) ? first : ((v > last) ? last : v)) + 719468 + DATE32_DAY_ERAS * 146097);
+        era = z / 146097;
+        doe = z - era * 146097;
+        yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        mp = (5 * doy + 2) / 153;
+        m = (int)mp + ((mp < 10) ? 3 : -9);
+        day[i] = (int)(doy - (153 * mp + 2) / 5 + 1);
+        month[i] = m;
+        year[i] = (int)(yoe + era * 400) - DATE32_DAY_ERAS * 400 + (m <= 2);
+    }
+}
+
+DC_ISA_VARIANTS(date32_to_gregorian_block,
+                (const int32_t *values, int n, int first, int last, int32_t *year, int32_t *month, int32_t *day),
+                (values, n, first, last, year, month, day))
+
+// Validate and convert a block of Gregorian dates; valid[] receives 1 for a valid date, values[] 0 for an invalid one
+
+DC_KERNEL void date32_from_gregorian_block(const int32_t *year, const int32_t *month, const int32_t *day, int n,
+                                           int32_t *values, unsigned char *valid)
+{
+    unsigned yu, era, yoe, doy, doe;
+    int i, y, m, d, leap, ok;
+
+    for(i = 0; i < n; i++)
+    {
+        y = year[i];
+        m = month[i];
+        d = day[i];
+        yu = (unsigned)y + DATE32_YEAR_ERAS * 400;  // Wraps only for years the range check rejects
+        leap = ((yu & 3) == 0) & (((yu % 100) != 0) | ((yu % 400) == 0));
+        ok = ((unsigned)y + 81739u <= 213719u + 81739u) & ((unsigned)(m - 1) < 12u) & (d >= 1) &
+             (d <= ((m == 2) ? 28 + leap : 30 + ((m + (m >> 3)) & 1)));
+
+        // Invalid rows are converted as 2000-03-01 to keep the arithmetic in range
+        yu = ok ? yu : 2000 + DATE32_YEAR_ERAS * 400;
+        m = ok ? m : 3;
+        d = ok ? d : 1;
+
+        yu -= (m <= 2);
+        era = yu / 400;
+        yoe = yu - era * 400;
+        doy = (153 * (unsigned)(m + ((m > 2) ? -3 : 9)) + 2) / 5 + (unsigned)d - 1;
+        doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        values[i] = ok ? (int)(era * 146097 + doe) - DATE32_YEAR_ERAS * 146097 - 719468 : 0;
+        valid[i] = (unsigned char)ok;
+    }
+}
+
+DC_ISA_VARIANTS(date32_from_gregorian_block,
+                (const int32_t *year, const int32_t *month, const int32_t *day, int n, int32_t *values, unsigned char *valid),
+                (year, month, day, n, values, valid))
+
+static int date32_valid_bit(const uint8_t *validity, int64_t i)
+{
+    return !validity || ((validity[i >> 3] >> (i & 7)) & 1);
+}
+
+static void date32_set_bit(uint8_t *bitmap, int64_t i, int valid)
+{
+    if(valid)
+        bitmap[i >> 3] |= (uint8_t)(1u << (i & 7));
+    else
+        bitmap[i >> 3] &= (uint8_t)~(1u << (i & 7));
+}
+
+/* First and last Julian day numbers of the years a calendar accepts,
+   computed once per calendar (the astronomical calendars need the
+   equinoxes of their extreme years). */
+
+static void date32_bounds(dc_calendar_t calendar_type, int *first_jdn, int *last_jdn)
+{
+    static int bounds[DC_CALENDARS_MAX][2];  // 0 = not yet computed
+    dc_year_layout_t layout;
+
+    if(!(*first_jdn = DC_LOAD_RELAXED(&bounds[calendar_type][0])) || !(*last_jdn = DC_LOAD_RELAXED(&bounds[calendar_type][1])))
+    {
+        *first_jdn = dc_year_layout(-81739, calendar_type, &layout) ? 0 : layout.start;
+        *last_jdn = dc_year_layout(213719, calendar_type, &layout) ? 0 : layout.start + layout.days - 1;
+        DC_STORE_RELAXED(&bounds[calendar_type][0], *first_jdn);
+        DC_STORE_RELAXED(&bounds[calendar_type][1], *last_jdn);
+    }
+}
+
+/* DATE32_LAYOUT_YMD  --  Date of a Julian day number from the layout of
+                          its year, found among the cached layouts.  A
+                          miss converts the day directly; the layout of
+                          its year is computed (and cached) only when
+                          the previous miss fell in the same year, so
+                          sorted input runs off the cache while random
+                          input costs no more than the direct
+                          conversion.  *missed holds the year of the
+                          previous miss, INT_MIN before the first. */
+
+static void date32_layout_ymd(dc_year_layout_t *cache, int *missed, int jdn, dc_calendar_t calendar_type, int *year, int *month, int *day)
+{
+    dc_year_layout_t *layout = &cache[(jdn / 366) & (DC_DATE32_CACHE - 1)];
+    int i, m = 1;
+
+    if(layout->months && (unsigned)(jdn - layout->start) < (unsigned)layout->days)
+    {
+        for(i = 0; i < layout->months; i++)
+        {
+            m = layout_month_at(layout, i);
+            if(jdn < layout->month_start[m] + layout->month_days[m])
+                break;
+        }
+        *year = layout->year;
+        *month = m;
+        *day = jdn - layout->month_start[m] + 1;
+        return;
+    }
+
+    jd_to_ymd(jdn - 0.5, calendar_type, year, month, day);
+    if(*year == *missed)
+        dc_year_layout(*year, calendar_type, layout);
+    *missed = *year;
+}
+
+/* DC_DATE32_TO_YMD  --  Convert length date32 values, starting at slot
+                         offset, to year, month and day columns of a
+                         calendar.  out_validity (may be NULL) receives
+                         the validity of the outputs.  Returns the
+                         number of nulls, or -1 for an unknown calendar
+                         or one without year layouts (Badi'). */
+
+int64_t dc_date32_to_ymd(const int32_t *values, const uint8_t *validity, int64_t offset, int64_t length,
+                         dc_calendar_t calendar_type, int32_t *year, int32_t *month, int32_t *day, uint8_t *out_validity)
+{
+    dc_year_layout_t cache[DC_DATE32_CACHE];
+    int32_t gy[DC_DATE32_BLOCK], gm[DC_DATE32_BLOCK], gd[DC_DATE32_BLOCK];
+    int64_t i, nulls, jdn64;
+    int first_jdn, last_jdn, missed = INT_MIN, valid, y, m, d;
+
+    if(!calendar_has_layout(calendar_type))
+        return -1;
+
+    date32_bounds(calendar_type, &first_jdn, &last_jdn);
+    for(i = 0; i < DC_DATE32_CACHE; i++)
+        cache[i].months = 0;
+
+    nulls = 0;
+    for(i = 0; i < length; i++)
+    {
+        if(calendar_type == DC_GRE && !(i % DC_DATE32_BLOCK))
+            isa_kernels()->date32_to_gregorian(values + offset + i, (int)((length - i < DC_DATE32_BLOCK) ? length - i : DC_DATE32_BLOCK),
+                                               first_jdn - DATE32_JDN, last_jdn - DATE32_JDN, gy, gm, gd);
+
+        y = m = d = 0;
+        valid = date32_valid_bit(validity, offset + i);
+        if(valid)
+        {
+            jdn64 = (int64_t)values[offset + i] + DATE32_JDN;
+            if(jdn64 < first_jdn || jdn64 > last_jdn)
+                valid = 0;
+            else if(calendar_type == DC_GRE)
+            {
+                y = gy[i % DC_DATE32_BLOCK];
+                m = gm[i % DC_DATE32_BLOCK];
+                d = gd[i % DC_DATE32_BLOCK];
+            }
+            else
+                date32_layout_ymd(cache, &missed, (int)jdn64, calendar_type, &y, &m, &d);
+        }
+
+        year[i] = y;
+        month[i] = m;
+        day[i] = d;
+        nulls += !valid;
+        if(out_validity)
+            date32_set_bit(out_validity, i, valid);
+    }
+
+    return nulls;
+}
+
+/* DC_DATE32_TO_MONTH_KEY  --  Like dc_date32_to_ymd(), but produce a
+                               single year * 100 + month column, e.g.
+                               140301 for Farvardin 1403, for grouping
+                               by month of the calendar. */
+
+int64_t dc_date32_to_month_key(const int32_t *values, const uint8_t *validity, int64_t offset, int64_t length,
+                               dc_calendar_t calendar_type, int32_t *key, uint8_t *out_validity)
+{
+    dc_year_layout_t cache[DC_DATE32_CACHE];
+    int32_t gy[DC_DATE32_BLOCK], gm[DC_DATE32_BLOCK], gd[DC_DATE32_BLOCK];
+    int64_t i, nulls, jdn64;
+    int first_jdn, last_jdn, missed = INT_MIN, valid, y, m, d;
+
+    if(!calendar_has_layout(calendar_type))
+        return -1;
+
+    date32_bounds(calendar_type, &first_jdn, &last_jdn);
+    for(i = 0; i < DC_DATE32_CACHE; i++)
+        cache[i].months = 0;
+
+    nulls = 0;
+    for(i = 0; i < length; i++)
+    {
+        if(calendar_type == DC_GRE && !(i % DC_DATE32_BLOCK))
+            isa_kernels()->date32_to_gregorian(values + offset + i, (int)((length - i < DC_DATE32_BLOCK) ? length - i : DC_DATE32_BLOCK),
+                                               first_jdn - DATE32_JDN, last_jdn - DATE32_JDN, gy, gm, gd);
+
+        y = m = 0;
+        valid = date32_valid_bit(validity, offset + i);
+        if(valid)
+        {
+            jdn64 = (int64_t)values[offset + i] + DATE32_JDN;
+            if(jdn64 < first_jdn || jdn64 > last_jdn)
+                valid = 0;
+            else if(calendar_type == DC_GRE)
+            {
+                y = gy[i % DC_DATE32_BLOCK];
+                m = gm[i % DC_DATE32_BLOCK];
+            }
+            else
+                date32_layout_ymd(cache, &missed, (int)jdn64, calendar_type, &y, &m, &d);
+        }
+
+        key[i] = valid ? y * 100 + m : 0;
+        nulls += !valid;
+        if(out_validity)
+            date32_set_bit(out_validity, i, valid);
+    }
+
+    return nulls;
+}
+
+/* DC_YMD_TO_DATE32  --  Convert year, month and day columns of a
+                         calendar, starting at slot offset, to date32
+                         values.  Invalid dates become null in
+                         out_validity (may be NULL).  Returns the number
+                         of nulls, or -1 for an unknown calendar or one
+                         without year layouts (Badi'). */
+
+int64_t dc_ymd_to_date32(const int32_t *year, const int32_t *month, const int32_t *day, const uint8_t *validity,
+                         int64_t offset, int64_t length, dc_calendar_t calendar_type, int32_t *values, uint8_t *out_validity)
+{
+    dc_year_layout_t cache[DC_DATE32_CACHE];
+    dc_year_layout_t *layout;
+    int32_t gv[DC_DATE32_BLOCK];
+    unsigned char gok[DC_DATE32_BLOCK];
+    int64_t i, nulls;
+    int valid, y, m, d, v;
+
+    if(!calendar_has_layout(calendar_type))
+        return -1;
+
+    for(i = 0; i < DC_DATE32_CACHE; i++)
+        cache[i].months = 0;
+
+    nulls = 0;
+    for(i = 0; i < length; i++)
+    {
+        if(calendar_type == DC_GRE && !(i % DC_DATE32_BLOCK))
+            isa_kernels()->date32_from_gregorian(year + offset + i, month + offset + i, day + offset + i,
+                                                 (int)((length - i < DC_DATE32_BLOCK) ? length - i : DC_DATE32_BLOCK), gv, gok);
+
+        v = 0;
+        valid = date32_valid_bit(validity, offset + i);
+        if(valid && calendar_type == DC_GRE)
+        {
+            valid = gok[i % DC_DATE32_BLOCK];
+            v = gv[i % DC_DATE32_BLOCK];
+        }
+        else if(valid)
+        {
+            y = year[offset + i];
+            m = month[offset + i];
+            d = day[offset + i];
+
+            if(y < -81739 || y > 213719 || m < 1 || m > 13 || d < 1 || d > 31)
+                valid = 0;
+            else if(y == 0 && calendar_no_year_zero(calendar_type))
+                valid = 0;
+            else
+            {
+                layout = &cache[(unsigned)y % DC_DATE32_CACHE];
+                if(!layout->months || layout->year != y)
+                    dc_year_layout(y, calendar_type, layout);
+                if(m > layout->months || d > layout->month_days[m])
+                    valid = 0;
+                else
+                    v = layout->month_start[m] + d - 1 - DATE32_JDN;
+            }
+        }
+
+        values[i] = v;
+        nulls += !valid;
+        if(out_validity)
+            date32_set_bit(out_validity, i, valid);
+    }
+
+    return nulls;
+}
+
+// /////////////////////////////////      ARROW KERNELS     ///////////////////////////////// //
+// ****************************************************************************************** //
+
+// ****************************************************************************************** //
+// /////////////////////////////////       BUCKETING        ///////////////////////////////// //
+
+/* Grouping of Julian day numbers by month or year of a calendar for
+   aggregation: the first day of every period of a span of years is
+   computed once, and each row is then placed by a search among these
+   starts instead of being converted to a date. */
+
+#define DC_BUCKET_BLOCK 256  // Rows searched at a time
+
+// BUCKET_OF: Period holding a day number within the span, by the same search as bucket_block()
+
+static inline int bucket_of(const int *start, int count, int jdn)
+{
+    int id = 0, len, half;
+
+    for(len = count; len > 1; len -= half)
+    {
+        half = len >> 1;
+        id += (start[id + half] <= jdn) ? half : 0;
+    }
+    return id;
+}
+
+/* Periods of a block of rows, -1 outside the span.  The search is
+   narrowed to the periods between those of the smallest and largest
+   rows, so that a block of sorted input within one period is filled
+   without a search and one across a boundary takes a step or two.
+   The halving steps of the branchless binary search are the same for
+   every row, so the rows are the inner loop and each step vectorizes
+   as a gather and a compare. */
+
+DC_KERNEL void bucket_block(const int *restrict start, int count, const int32_t *restrict jdn, int n, int32_t *restrict id)
+{
+    const int first = start[0], end = start[count];
+    int i, len, half, lo, hi, p;
+
+    lo = hi = jdn[0];
+    for(i = 1; i < n; i++)
+    {
+        lo = (jdn[i] < lo) ? jdn[i] : lo;
+        hi = (jdn[i] > hi) ? jdn[i] : hi;
+    }
+    p = bucket_of(start, count, lo);
+    len = bucket_of(start, count, hi) - p + 1;
+    start += p;
+
+    for(i = 0; i < n; i++)
+        id[i] = 0;
+    for(; len > 1; len -= half)
+    {
+        half = len >> 1;
+        for(i = 0; i < n; i++)
+            id[i] += (start[id[i] + half] <= jdn[i]) ? half : 0;
+    }
+    for(i = 0; i < n; i++)
+        id[i] = (jdn[i] >= first && jdn[i] < end) ? id[i] + p : -1;
+}
+
+DC_ISA_VARIANTS(bucket_block,
+                (const int *start, int count, const int32_t *jdn, int n, int32_t *id),
+                (start, count, jdn, n, id))
+
+/* DC_BUCKETS_BUILD  --  The months or years of a calendar from
+                         first_year to last_year as periods numbered
+                         from 0 in chronological order.  Returns 0, or
+                         -1 for an invalid calendar, period or span, or
+                         out of memory. */
+
+int dc_buckets_build(dc_calendar_t calendar_type, dc_period_t period, int first_year, int last_year, dc_buckets_t *buckets)
+{
+    dc_year_layout_t layout;
+    int year, i, m, n;
+
+    buckets->calendar = calendar_type;
+    buckets->period = period;
+    buckets->count = 0;
+    buckets->start = NULL;
+    buckets->label = NULL;
+
+    if(first_year > last_year || (period != DC_PERIOD_MONTH && period != DC_PERIOD_YEAR) ||
+       !calendar_has_layout(calendar_type) || check_date(first_year, 1, 1, calendar_type) == 2 ||
+       check_date(last_year, 1, 1, calendar_type) == 2)
+        return -1;
+
+    n = (last_year - first_year + 1) * ((period == DC_PERIOD_MONTH) ? 13 : 1);
+    buckets->start = (int *)malloc((n + 1) * sizeof(int));
+    buckets->label = (int *)malloc(n * sizeof(int));
+    if(!buckets->start || !buckets->label)
+    {
+        dc_buckets_free(buckets);
+        return -1;
+    }
+
+    n = 0;
+    for(year = first_year; year <= last_year; year++)
+    {
+        if(year == 0 && calendar_no_year_zero(calendar_type))
+            continue;  // No year zero
+        if(dc_year_layout(year, calendar_type, &layout))
+        {
+            dc_buckets_free(buckets);
+            return -1;
+        }
+
+        if(period == DC_PERIOD_YEAR)
+        {
+            buckets->start[n] = layout.start;
+            buckets->label[n++] = year;
+        }
+        else
+        {
+            for(i = 0; i < layout.months; i++)
+            {
+                m = layout_month_at(&layout, i);
+                buckets->start[n] = layout.month_start[m];
+                buckets->label[n++] = year * 100 + m;
+            }
+        }
+        buckets->start[n] = layout.start + layout.days;
+    }
+    buckets->count = n;
+
+    return 0;
+}
+
+void dc_buckets_free(dc_buckets_t *buckets)
+{
+    free(buckets->start);
+    free(buckets->label);
+    buckets->start = NULL;
+    buckets->label = NULL;
+    buckets->count = 0;
+}
+
+/* DC_BUCKET_AGGREGATE  --  Period of each of n Julian day numbers,
+                            sorted or not, into id[] (-1 outside the
+                            span; may be NULL), and the count, sum,
+                            minimum and maximum of the companion values
+                            (may be NULL: counts only) per period into
+                            agg[], which holds buckets->count entries
+                            and is added to, so that a column can be
+                            fed in chunks; start from zeroed entries.
+                            Returns the number of rows outside the
+                            span. */
+
+int64_t dc_bucket_aggregate(const dc_buckets_t *buckets, const int32_t *jdn, const double *value, int64_t n,
+                            int32_t *id, dc_bucket_agg_t *agg)
+{
+    int32_t block_id[DC_BUCKET_BLOCK];
+    int32_t *ids;
+    dc_bucket_agg_t *a;
+    int64_t i, outside = 0;
+    double v;
+    int j, len;
+
+    if(!buckets->count)
+        return n;
+
+    for(i = 0; i < n; i += len)
+    {
+        len = (n - i < DC_BUCKET_BLOCK) ? (int)(n - i) : DC_BUCKET_BLOCK;
+        ids = id ? id + i : block_id;
+        isa_kernels()->bucket_block(buckets->start, buckets->count, jdn + i, len, ids);
+
+        for(j = 0; j < len; j++)
+        {
+            if(ids[j] < 0)
+            {
+                outside++;
+                continue;
+            }
+            if(!agg)
+                continue;
+
+            a = &agg[ids[j]];
+            v = value ? value[i + j] : 0;
+            if(!a->count || v < a->min)
+                a->min = v;
+            if(!a->count || v > a->max)
+                a->max = v;
+            a->sum += v;
+            a->count++;
+        }
+    }
+
+    return outside;
+}
+
+// DC_BUCKET_ASSIGN: dc_bucket_aggregate() without the aggregates
+
+int64_t dc_bucket_assign(const dc_buckets_t *buckets, const int32_t *jdn, int64_t n, int32_t *id)
+{
+    return dc_bucket_aggregate(buckets, jdn, NULL, n, id, NULL);
+}
+
+// /////////////////////////////////       BUCKETING        ///////////////////////////////// //
+// ****************************************************************************************** //
+
+// ****************************************************************************************** //
+// /////////////////////////////////         TODAY          ///////////////////////////////// //
+
+/* Today's date in every calendar, cached per UTC offset.  Each slot is
+   a sequence lock: a writer makes the sequence odd, stores the offset,
+   the day number and the dates, and makes it even again; a reader
+   copies the slot and keeps the copy only if the sequence was even and
+   unchanged across it.  The day number is part of the key, so the slot
+   goes stale the moment the local day rolls over and the next call
+   refills it.  Readers never wait: a reader that loses a race, or a
+   writer that finds the slot taken, converts the date itself. */
+
+#define DC_TODAY_SLOTS 64  // Power of 2; a collision costs only the conversions
+#define DC_TODAY_WORDS (2 + 3 * DC_CALENDARS)
+
+#define UNIX_EPOCH_JDN 2440588  // 1970 January 1
+
+typedef struct TodaySlot
+{
+    unsigned seq;                 // Odd while a writer fills the slot
+    int words[DC_TODAY_WORDS];    // UTC offset, day number, then year, month and day per calendar
+} today_slot_t;
+
+static today_slot_t today_slots[DC_TODAY_SLOTS];
+
+static int today_read(today_slot_t *slot, int tz_offset, int jdn, int words[])
+{
+    unsigned seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    int i;
+
+    if((seq & 1) || DC_LOAD_RELAXED(&slot->words[0]) != tz_offset || DC_LOAD_RELAXED(&slot->words[1]) != jdn)
+        return 0;
+
+    for(i = 2; i < DC_TODAY_WORDS; i++)
+        words[i] = DC_LOAD_RELAXED(&slot->words[i]);
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return DC_LOAD_RELAXED(&slot->seq) == seq;
+}
+
+static void today_write(today_slot_t *slot, const int words[])
+{
+    unsigned seq = DC_LOAD_RELAXED(&slot->seq);
+    int i;
+
+    // Another writer holds the slot: leave it to that one
+    if((seq & 1) || !__atomic_compare_exchange_n(&slot->seq, &seq, seq + 1, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        return;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    for(i = 0; i < DC_TODAY_WORDS; i++)
+        DC_STORE_RELAXED(&slot->words[i], words[i]);
+
+    __atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/* DC_TODAY_AT  --  The local date at a Unix time (seconds) and a UTC
+                    offset (seconds east of Greenwich, at most 18
+                    hours) in every calendar, and the Unix time at
+                    which that local day ends.  Returns -1 for an
+                    offset or a time out of range. */
+
+int dc_today_at(int64_t unix_time, int tz_offset, dc_today_t *today)
+{
+    today_slot_t *slot;
+    int64_t days;
+    int words[DC_TODAY_WORDS];
+    int jdn, c;
+
+    if(tz_offset < -18 * 3600 || tz_offset > 18 * 3600 || unix_time < -(INT64_C(1) << 52) || unix_time > (INT64_C(1) << 52))
+        return -1;  // ERROR: Offset beyond 18 hours, or a time beyond any calendar
+
+    days = unix_time + tz_offset;
+    days = (days >= 0) ? days / 86400 : -((86399 - days) / 86400);
+    if(!DC_JDN_JD_OK((double)(days + UNIX_EPOCH_JDN)))
+        return -1;
+    jdn = (int)days + UNIX_EPOCH_JDN;
+
+    slot = &today_slots[((unsigned)tz_offset * 2654435761u) >> 26];
+    if(!today_read(slot, tz_offset, jdn, words))
+    {
+        words[0] = tz_offset;
+        words[1] = jdn;
+        for(c = 0; c < DC_CALENDARS; c++)
+            jd_to_ymd(jdn - 0.5, (dc_calendar_t)c, &words[2 + 3 * c], &words[3 + 3 * c], &words[4 + 3 * c]);
+        today_write(slot, words);
+    }
+
+    today->jdn = jdn;
+    today->weekday = floor_mod(jdn + 1, 7);
+    for(c = 0; c < DC_CALENDARS; c++)
+    {
+        today->ymd[c][0] = words[2 + 3 * c];
+        today->ymd[c][1] = words[3 + 3 * c];
+        today->ymd[c][2] = words[4 + 3 * c];
+    }
+    today->next_rollover = (days + 1) * 86400 - tz_offset;
+
+    return 0;
+}
+
+// DC_TODAY: dc_today_at() at the current time of the system clock
+
+int dc_today(int tz_offset, dc_today_t *today)
+{
+    return dc_today_at((int64_t)time(NULL), tz_offset, today);
+}
+
+// /////////////////////////////////         TODAY          ///////////////////////////////// //
+// ****************************************************************************************** //
+
+// ****************************************************************************************** //
+// /////////////////////////////////      ISA DISPATCH      ///////////////////////////////// //
+
+/* The kernels of each instruction set level, indexed by dc_isa_t.  The
+   level is chosen on the first call: the highest the CPU (and the OS)
+   supports, or the one named by the environment variable DATECONV_ISA
+   ("sse2", "avx2" or "avx512") if the CPU supports it. */
+
+static const isa_kernels_t isa_tables[] = {
+    {
+        nutation_terms_reduced_sse2, equinox_terms_reduced_sse2, check_date_pass1_sse2,
+        date32_to_gregorian_block_sse2, date32_from_gregorian_block_sse2, bucket_block_sse2
+    },
+#if DC_ISA_DISPATCH
+    {
+        nutation_terms_reduced_avx2, equinox_terms_reduced_avx2, check_date_pass1_avx2,
+        date32_to_gregorian_block_avx2, date32_from_gregorian_block_avx2, bucket_block_avx2
+    },
+    {
+        nutation_terms_reduced_avx512, equinox_terms_reduced_avx512, check_date_pass1_avx512,
+        date32_to_gregorian_block_avx512, date32_from_gregorian_block_avx512, bucket_block_avx512
+    }
+#endif
+};
+
+static const char *isa_names[] = {"sse2", "avx2", "avx512"};
+
+static const isa_kernels_t *isa_current;  // NULL until the first call
+
+// Highest level the CPU supports
+
+static dc_isa_t isa_supported(void)
+{
+#if DC_ISA_DISPATCH
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") &&
+       __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq"))
+        return DC_ISA_AVX512;
+    if(__builtin_cpu_supports("avx2"))
+        return DC_ISA_AVX2;
+#endif
+    return DC_ISA_SSE2;
+}
+
+static const isa_kernels_t *isa_kernels(void)
+{
+    const isa_kernels_t *kernels = DC_LOAD_RELAXED(&isa_current);
+    dc_isa_t isa;
+    const char *env;
+    int i;
+
+    if(!kernels)
+    {
+        isa = isa_supported();
+        if((env = getenv("DATECONV_ISA")))
+        {
+            for(i = 0; i < (int)isa; i++)
+            {
+                if(!strcmp(env, isa_names[i]))
+                    isa = (dc_isa_t)i;
+            }
+        }
+        kernels = &isa_tables[isa];
+        DC_STORE_RELAXED(&isa_current, kernels);
+    }
+
+    return kernels;
+}
+
+// DC_GET_ISA: Instruction set level of the kernels in use
+
+dc_isa_t dc_get_isa(void)
+{
+    return (dc_isa_t)(isa_kernels() - isa_tables);
+}
+
+/* DC_SET_ISA  --  Use the kernels of a level, or of the highest level
+                   the CPU supports if lower.  Returns the level in
+                   use.  Meant for tests and benchmarks; kernels
+                   already running in other threads finish on the
+                   level they started with. */
+
+dc_isa_t dc_set_isa(dc_isa_t isa)
+{
+    dc_isa_t supported = isa_supported();
+
+    if((unsigned)isa > (unsigned)supported)
+        isa = supported;
+    DC_STORE_RELAXED(&isa_current, &isa_tables[isa]);
+    return isa;
+}
+
+const char *dc_isa_name(dc_isa_t isa)
+{
+    return ((unsigned)isa <= DC_ISA_AVX512) ? isa_names[isa] : NULL;
+}
+
+// /////////////////////////////////      ISA DISPATCH      ///////////////////////////////// //
+// ****************************************************************************************** //
+#endif  // DC_EMBEDDED
@@ -21,12 +21,211 @@ extern "C"
 {
 #endif  // __cplusplus
 
+// The shared library is built with hidden visibility; only what is declared here is exported
+#if defined(__GNUC__) && !defined(_WIN32)
+#pragma GCC visibility push(default)
+#endif
+
 #define DATE_CONVERTER_VERSION "1.1.2"
 #define DATE_CONVERTER_VER_MAJOR 1
 #define DATE_CONVERTER_VER_MINOR 1
 #define DATE_CONVERTER_VER_PATCH 2
 
-typedef enum DC_CalendarType {DC_PER, DC_GRE, DC_ISM, DC_HEB, DC_JUL, DC_PER_B} dc_calendar_t;
+#include <stddef.h>  // size_t
+#include <stdint.h>  // int32_t, int64_t, uint8_t
+
+typedef enum DC_CalendarType {DC_PER, DC_GRE, DC_ISM, DC_HEB, DC_JUL, DC_PER_B, DC_PER_AF, DC_ISM_UQ,
+                              DC_COP, DC_ETH, DC_IND, DC_ARM, DC_BAH} dc_calendar_t;
+#define DC_CALENDARS 13      // Number of built-in calendar types
+#define DC_CALENDARS_MAX 32  // Built-in and registered calendars (dc_calendar_register())
+
+/* A calendar of the registry: its day-number conversions and the rules
+   of its months.  Every function but to_jdn() and from_jdn() is called
+   only for a year and month that check_date() accepts. */
+typedef struct DC_CalendarOps
+{
+    const char *name;
+    int max_months;                                              // Most months in a year: 1-13 (Badi': 19)
+    int min_month;                                               // 1, or 0 if the months also include a month 0 (Badi')
+    int first_month;                                             // Month that begins the year (Hebrew: 7)
+    int no_year_zero;                                            // Does year 1 follow year -1?
+    unsigned variable_months;                                    // Bit m set if month m's length depends on the year
+    int (*to_jdn)(int year, int month, int day);                 // Julian day number, the Julian day + 0.5
+    void (*from_jdn)(int jdn, int *year, int *month, int *day);
+    int (*month_days)(int year, int month);
+    int (*leap)(int year);                                       // May be NULL: no leap years
+    int (*year_months)(int year);                                // May be NULL: always max_months
+    const char *(*month_name)(int year, int month);              // May be NULL
+} dc_calendar_ops_t;
+
+// Gregorian years whose equinox day is cached by a solar Hijri context
+#define DC_EQUINOX_CACHE_FIRST 1000
+#define DC_EQUINOX_CACHE_YEARS 2048
+
+// Astronomical solar Hijri calendar reckoned from an arbitrary meridian
+typedef struct DC_SolarHijri
+{
+    double meridian;                          // Reference meridian, degrees east of Greenwich
+    int equinox_jd[DC_EQUINOX_CACHE_YEARS];   // Equinox day per Gregorian year, 0 = not yet computed
+} dc_solar_hijri_t;
+
+// Principal phases of one lunation, as Julian days in Universal time
+typedef struct DC_Lunation
+{
+    int k;              // Lunation number, 0 = new moon of 2000 January 6
+    double phase[4];    // New moon, first quarter, full moon, last quarter
+} dc_lunation_t;
+
+// Evaluation of the equinox days behind the astronomical solar Hijri calendars
+typedef enum DC_AstroPrecision {DC_ASTRO_DOUBLE, DC_ASTRO_REDUCED} dc_astro_precision_t;
+
+// Ephemeris of the March equinoxes: short Meeus series, truncated VSOP87, or the series checked by VSOP87 near a day boundary
+typedef enum DC_Ephemeris {DC_EPHEM_MEEUS, DC_EPHEM_VSOP87, DC_EPHEM_AUTO} dc_ephemeris_t;
+#define DC_EPHEM_MARGIN 0.0015  // Days, about twice the largest gap between the two in the equinox cache window
+
+// Instruction set levels of the vectorized kernels, chosen at run time (DATECONV_ISA=sse2|avx2|avx512 forces one)
+typedef enum DC_Isa {DC_ISA_SSE2, DC_ISA_AVX2, DC_ISA_AVX512} dc_isa_t;  // DC_ISA_SSE2: baseline, the only level off x86
+
+// Fields of the solar position, selectable in dc_sunpos_batch()
+#define DC_SUN_L0         (1u << 0)   // Geometric mean longitude of the Sun
+#define DC_SUN_M          (1u << 1)   // Mean anomaly of the Sun
+#define DC_SUN_E          (1u << 2)   // Eccentricity of the Earth's orbit
+#define DC_SUN_C          (1u << 3)   // Sun's equation of the Centre
+#define DC_SUN_LONG       (1u << 4)   // Sun's true longitude
+#define DC_SUN_ANOMALY    (1u << 5)   // Sun's true anomaly
+#define DC_SUN_R          (1u << 6)   // Sun's radius vector in AU
+#define DC_SUN_LAMBDA     (1u << 7)   // Sun's apparent longitude at true equinox of the date
+#define DC_SUN_ALPHA      (1u << 8)   // Sun's true right ascension
+#define DC_SUN_DELTA      (1u << 9)   // Sun's true declination
+#define DC_SUN_ALPHA_APP  (1u << 10)  // Sun's apparent right ascension
+#define DC_SUN_DELTA_APP  (1u << 11)  // Sun's apparent declination
+#define DC_SUN_ALL        0xfffu
+
+// First day and length of each month of one calendar year, as Julian day numbers
+typedef struct DC_YearLayout
+{
+    dc_calendar_t calendar;
+    int year;
+    int months;           // 12, or 13 (Hebrew leap years; Coptic, Ethiopian and Armenian)
+    int start;            // First day of the year (Hebrew: 1 Tishrei)
+    int days;             // Length of the year
+    int month_start[14];  // Indexed by month number, 0 if the year lacks the month
+    int month_days[14];
+} dc_year_layout_t;
+
+// Week numbering of a calendar: the first day of the week and the fewest days of a year in its week 1
+typedef struct DC_WeekRule
+{
+    int first_weekday;  // 0 = Sunday ... 6 = Saturday
+    int min_days;       // 1: week 1 holds the first day of the year, 4: ISO 8601, 7: the first full week
+} dc_week_rule_t;
+
+#define DC_WEEK_ISO     {1, 4}  // Monday; week 1 holds the fourth day of the year
+#define DC_WEEK_IRAN    {6, 1}  // Saturday; week 1 holds the first day of the year
+#define DC_WEEK_ISRAEL  {0, 1}  // Sunday; week 1 holds the first day of the year
+
+// Periods of a calendar for grouping Julian day numbers (dc_buckets_build())
+typedef enum DC_Period {DC_PERIOD_MONTH, DC_PERIOD_YEAR} dc_period_t;
+
+typedef struct DC_Buckets
+{
+    dc_calendar_t calendar;
+    dc_period_t period;
+    int count;      // Number of periods
+    int *start;     // First Julian day number of each period, and the end of the span after the last
+    int *label;     // year * 100 + month, or the year, of each period
+} dc_buckets_t;
+
+// Aggregates of a value column over one period (dc_bucket_aggregate())
+typedef struct DC_BucketAgg
+{
+    int64_t count;
+    double sum;
+    double min;
+    double max;
+} dc_bucket_agg_t;
+
+// Today's local date in every calendar (dc_today())
+typedef struct DC_Today
+{
+    int jdn;                      // Julian day number of the local date
+    int weekday;                  // 0 = Sunday
+    int ymd[DC_CALENDARS][3];     // Year, month and day, indexed by dc_calendar_t
+    int64_t next_rollover;        // Unix time at which the local day ends
+} dc_today_t;
+
+// Recurrence rules expanded in the calendar of the rule (RFC 7529 RSCALE)
+typedef enum DC_RecurFreq {DC_YEARLY, DC_MONTHLY} dc_recur_freq_t;
+typedef enum DC_RecurSkip {DC_SKIP_OMIT, DC_SKIP_BACKWARD, DC_SKIP_FORWARD} dc_recur_skip_t;
+
+typedef struct DC_Recur
+{
+    dc_calendar_t calendar;
+    dc_recur_freq_t freq;
+    int interval;           // Every interval-th year or month, counted from the anchor
+    int year;               // Anchor year; no occurrence falls before it
+    int month;              // DC_YEARLY: month of every occurrence; DC_MONTHLY: anchor month
+    int day;                // Day of the month, negative counts from its end (-1 = last day)
+    dc_recur_skip_t skip;   // Policy for a day or month missing from the period
+} dc_recur_t;
+
+// A holiday on a fixed date of some calendar
+typedef struct DC_Holiday
+{
+    int id;                 // Bit of the holiday in an index, 0-63
+    const char *name;
+    dc_calendar_t calendar;
+    int month;              // As in dc_recur_t
+    int day;
+    int length;             // Number of consecutive days
+    dc_recur_skip_t skip;
+    int first_year;         // Years of the calendar in which the rule applies, 0 = unbounded
+    int last_year;
+    signed char shift[7];   // Days moved, by weekday of the nominal date (0 = Sunday)
+} dc_holiday_t;
+
+typedef struct DC_HolidaySet
+{
+    const char *country;
+    const dc_holiday_t *rules;
+    int count;
+} dc_holiday_set_t;
+
+typedef struct DC_HolidayDay
+{
+    int jdn;
+    unsigned long long holidays;  // Bitset of holiday ids
+} dc_holiday_day_t;
+
+// Holidays of a set over a span of Gregorian years
+typedef struct DC_HolidayIndex
+{
+    const dc_holiday_set_t *set;
+    int first_jdn;
+    int last_jdn;
+    int count;
+    dc_holiday_day_t *days;       // Sorted by Julian day number
+    unsigned long long *bitmap;   // One bit per day of the span
+    int *rank;                    // Holiday days before each word of the bitmap
+} dc_holiday_index_t;
+
+// Weekends of a business-day calendar, one bit per weekday (0 = Sunday)
+#define DC_WEEKEND_FRI      (1u << 5)                  // Iran
+#define DC_WEEKEND_THU_FRI  ((1u << 4) | (1u << 5))    // Afghanistan
+#define DC_WEEKEND_FRI_SAT  ((1u << 5) | (1u << 6))    // Israel, most Arab states
+#define DC_WEEKEND_SAT_SUN  ((1u << 6) | (1u << 0))
+
+// Business days of a span of Gregorian years
+typedef struct DC_BusinessDays
+{
+    unsigned weekend;
+    int first_jdn;
+    int last_jdn;
+    int count;                    // Business days in the span
+    unsigned long long *bitmap;   // One bit per day of the span, set for business days
+    int *rank;                    // Business days before each word of the bitmap
+    int *select;                  // Word of the bitmap holding every 64th business day
+} dc_bday_t;
 
 void persian_to_gregorian(int *year, int *month, int *day);
 void persian_to_islamic(int *year, int *month, int *day);
@@ -58,6 +257,18 @@ void persianb_to_gregorian(int *year, int *month, int *day);
 void persianb_to_islamic(int *year, int *month, int *day);
 void persianb_to_hebrew(int *year, int *month, int *day);
 void persianb_to_julian(int *year, int *month, int *day);
+void persian_to_ummalqura(int *year, int *month, int *day);
+void gregorian_to_ummalqura(int *year, int *month, int *day);
+void islamic_to_ummalqura(int *year, int *month, int *day);
+void hebrew_to_ummalqura(int *year, int *month, int *day);
+void julian_to_ummalqura(int *year, int *month, int *day);
+void persianb_to_ummalqura(int *year, int *month, int *day);
+void ummalqura_to_persian(int *year, int *month, int *day);
+void ummalqura_to_gregorian(int *year, int *month, int *day);
+void ummalqura_to_islamic(int *year, int *month, int *day);
+void ummalqura_to_hebrew(int *year, int *month, int *day);
+void ummalqura_to_julian(int *year, int *month, int *day);
+void ummalqura_to_persianb(int *year, int *month, int *day);
 
 int *persian_to_gregorian_arr(int year, int month, int day, int result_ymd[]);
 int *persian_to_islamic_arr(int year, int month, int day, int result_ymd[]);
@@ -89,24 +300,64 @@ int *persianb_to_gregorian_arr(int year, int month, int day, int result_ymd[]);
 int *persianb_to_islamic_arr(int year, int month, int day, int result_ymd[]);
 int *persianb_to_hebrew_arr(int year, int month, int day, int result_ymd[]);
 int *persianb_to_julian_arr(int year, int month, int day, int result_ymd[]);
+int *persian_to_ummalqura_arr(int year, int month, int day, int result_ymd[]);
+int *gregorian_to_ummalqura_arr(int year, int month, int day, int result_ymd[]);
+int *islamic_to_ummalqura_arr(int year, int month, int day, int result_ymd[]);
+int *hebrew_to_ummalqura_arr(int year, int month, int day, int result_ymd[]);
+int *julian_to_ummalqura_arr(int year, int month, int day, int result_ymd[]);
+int *persianb_to_ummalqura_arr(int year, int month, int day, int result_ymd[]);
+int *ummalqura_to_persian_arr(int year, int month, int day, int result_ymd[]);
+int *ummalqura_to_gregorian_arr(int year, int month, int day, int result_ymd[]);
+int *ummalqura_to_islamic_arr(int year, int month, int day, int result_ymd[]);
+int *ummalqura_to_hebrew_arr(int year, int month, int day, int result_ymd[]);
+int *ummalqura_to_julian_arr(int year, int month, int day, int result_ymd[]);
+int *ummalqura_to_persianb_arr(int year, int month, int day, int result_ymd[]);
 
-int leap_persian(int year);
+void solar_hijri_init(dc_solar_hijri_t *ctx, double meridian);
+double solar_hijri_equinox_jd(dc_solar_hijri_t *ctx, int year);
+double solar_hijri_to_jd(dc_solar_hijri_t *ctx, int year, int month, int day);
+void jd_to_solar_hijri(dc_solar_hijri_t *ctx, double jd, int *year, int *month, int *day);
+int leap_solar_hijri(dc_solar_hijri_t *ctx, int year);
+int solar_hijri_month_days(dc_solar_hijri_t *ctx, int year, int month);
+
+// Defined static inline instead when included through date_converter_inline.h
+#ifndef DC_INLINE_FAST_PATHS
 int leap_gregorian(int year);
 int leap_islamic(int year);
 int leap_hebrew(int year);
 int leap_julian(int year);
+int hebrew_year_months(int year);
+int gregorian_month_days(int year, int month);
+int islamic_month_days(int year, int month);
+int julian_month_days(int year, int month);
+int weekday_jd(double jd);
+double gregorian_to_jd(int year, int month, int day);
+double islamic_to_jd(int year, int month, int day);
+double julian_to_jd(int year, int month, int day);
+#endif  // DC_INLINE_FAST_PATHS
+
+int leap_persian(int year);
 int leap_persianb(int year);
 int leap_persianb2(int year);
+int leap_afghan(int year);
+int leap_ummalqura(int year);
+int leap_coptic(int year);
+int leap_ethiopian(int year);
+int leap_indian(int year);
+int leap_badi(int year);
 
-int hebrew_year_months(int year);
 int hebrew_year_days(int year);
 
 int persian_month_days(int year, int month);
-int gregorian_month_days(int year, int month);
-int islamic_month_days(int year, int month);
 int hebrew_month_days(int year, int month);
-int julian_month_days(int year, int month);
 int persianb_month_days(int year, int month);
+int afghan_month_days(int year, int month);
+int ummalqura_month_days(int year, int month);
+int coptic_month_days(int year, int month);
+int ethiopian_month_days(int year, int month);
+int indian_month_days(int year, int month);
+int armenian_month_days(int year, int month);
+int badi_month_days(int year, int month);
 
 const char *persian_month_name(int month);
 const char *gregorian_month_name(int month);
@@ -114,26 +365,106 @@ const char *islamic_month_name(int month);
 const char *hebrew_month_name(int year, int month);
 const char *julian_month_name(int month);
 const char *persianb_month_name(int month);
+const char *afghan_month_name(int month);
+const char *ummalqura_month_name(int month);
+const char *coptic_month_name(int month);
+const char *ethiopian_month_name(int month);
+const char *indian_month_name(int month);
+const char *armenian_month_name(int month);
+const char *badi_month_name(int month);
+
+const dc_calendar_ops_t *dc_calendar_ops(dc_calendar_t calendar_type);
+int dc_calendar_register(const dc_calendar_ops_t *ops);
+
+double ymd_to_jd(int year, int month, int day, dc_calendar_t calendar_type);
+void jd_to_ymd(double jd, dc_calendar_t calendar_type, int *year, int *month, int *day);
+int dc_convert(dc_calendar_t from, dc_calendar_t to, int *year, int *month, int *day);
+int dc_today(int tz_offset, dc_today_t *today);
+int dc_today_at(int64_t unix_time, int tz_offset, dc_today_t *today);
 
 const char *weekday_str(int i);
-int weekday_jd(double jd);
 const char *weekday_jd_str(double jd);
 int weekday_ymd(int year, int month, int day, dc_calendar_t calendar_type);
 const char *weekday_ymd_str(int year, int month, int day, dc_calendar_t calendar_type);
 
 int check_date_ldom(int year, int month, int day, dc_calendar_t calendar_type, int *last_day_of_month);
+int check_date_ldom_buf(int year, int month, int day, dc_calendar_t calendar_type, int *last_day_of_month,
+                        char *buf, size_t size);
 int check_date_ldom_str(int year, int month, int day, dc_calendar_t calendar_type, int *last_day_of_month, char **error_str);
 int check_date_str(int year, int month, int day, dc_calendar_t calendar_type, char **error_str);
 int check_date(int year, int month, int day, dc_calendar_t calendar_type);
 
+size_t dc_check_date_n(const int *year, const int *month, const int *day, size_t n,
+                       dc_calendar_t calendar_type, int *error_code, int *last_day_of_month);
+
 const char *norm_leap_str(int is_leap_year);
 
+dc_lunation_t *dc_lunation(int k, dc_lunation_t *result);
+double dc_new_moon(int k);
+int dc_lunation_of(double jd);
+double dc_moon_phase(double jd, int *lunation);
+int dc_lunations(int first_year, int last_year, dc_lunation_t result[], int max_count);
+
+void dc_sunpos_batch(const double *jd, size_t n, unsigned fields, double *out[12]);
+
+void dc_set_astro_precision(dc_astro_precision_t precision);
+dc_astro_precision_t dc_get_astro_precision(void);
+void dc_set_ephemeris(dc_ephemeris_t kind, double margin);
+dc_ephemeris_t dc_get_ephemeris(double *margin);
+
+dc_isa_t dc_get_isa(void);
+dc_isa_t dc_set_isa(dc_isa_t isa);
+const char *dc_isa_name(dc_isa_t isa);
+
+int dc_year_layout(int year, dc_calendar_t calendar_type, dc_year_layout_t *layout);
+int dc_day_of_year(int year, int month, int day, dc_calendar_t calendar_type, int *day_of_year);
+int dc_from_ordinal(int year, int day_of_year, dc_calendar_t calendar_type, int *month, int *day);
+int dc_weeks_in_year(int week_year, dc_calendar_t calendar_type, const dc_week_rule_t *rule, int *weeks);
+int dc_week_date(int year, int month, int day, dc_calendar_t calendar_type, const dc_week_rule_t *rule,
+                 int *week_year, int *week, int *week_day);
+int dc_from_week_date(int week_year, int week, int week_day, dc_calendar_t calendar_type, const dc_week_rule_t *rule,
+                      int *year, int *month, int *day);
+int dc_recur_expand(const dc_recur_t *rule, int start_jdn, int end_jdn, int result[], int max_count);
+
+const dc_holiday_set_t *dc_holiday_set(const char *country);
+const char *dc_holiday_name(const dc_holiday_set_t *set, int id);
+int dc_holiday_index_build(const dc_holiday_set_t *set, int first_year, int last_year, dc_holiday_index_t *index);
+void dc_holiday_index_free(dc_holiday_index_t *index);
+unsigned long long dc_holidays_on(const dc_holiday_index_t *index, int jdn);
+int dc_holiday_next(const dc_holiday_index_t *index, int jdn, unsigned long long *holidays);
+
+int dc_bday_build(unsigned weekend, const dc_holiday_index_t *holidays, int first_year, int last_year, dc_bday_t *bd);
+void dc_bday_free(dc_bday_t *bd);
+int dc_bday_is(const dc_bday_t *bd, int jdn);
+int dc_bday_count(const dc_bday_t *bd, int from_jdn, int to_jdn, int *count);
+int dc_bday_add(const dc_bday_t *bd, int jdn, int n, int *result_jdn);
+int dc_bday_add_ymd(const dc_bday_t *bd, int *year, int *month, int *day, dc_calendar_t calendar_type, int n);
+int dc_bday_count_ymd(const dc_bday_t *bd, int from_year, int from_month, int from_day,
+                      int to_year, int to_month, int to_day, dc_calendar_t calendar_type, int *count);
+
+int64_t dc_date32_to_ymd(const int32_t *values, const uint8_t *validity, int64_t offset, int64_t length,
+                         dc_calendar_t calendar_type, int32_t *year, int32_t *month, int32_t *day, uint8_t *out_validity);
+int64_t dc_date32_to_month_key(const int32_t *values, const uint8_t *validity, int64_t offset, int64_t length,
+                               dc_calendar_t calendar_type, int32_t *key, uint8_t *out_validity);
+int64_t dc_ymd_to_date32(const int32_t *year, const int32_t *month, const int32_t *day, const uint8_t *validity,
+                         int64_t offset, int64_t length, dc_calendar_t calendar_type, int32_t *values, uint8_t *out_validity);
+
+int dc_buckets_build(dc_calendar_t calendar_type, dc_period_t period, int first_year, int last_year, dc_buckets_t *buckets);
+void dc_buckets_free(dc_buckets_t *buckets);
+int64_t dc_bucket_assign(const dc_buckets_t *buckets, const int32_t *jdn, int64_t n, int32_t *id);
+int64_t dc_bucket_aggregate(const dc_buckets_t *buckets, const int32_t *jdn, const double *value, int64_t n,
+                            int32_t *id, dc_bucket_agg_t *agg);
+
 double persian_to_jd(int year, int month, int day);
-double gregorian_to_jd(int year, int month, int day);
-double islamic_to_jd(int year, int month, int day);
 double hebrew_to_jd(int year, int month, int day);
-double julian_to_jd(int year, int month, int day);
 double persianb_to_jd(int year, int month, int day);
+double afghan_to_jd(int year, int month, int day);
+double ummalqura_to_jd(int year, int month, int day);
+double coptic_to_jd(int year, int month, int day);
+double ethiopian_to_jd(int year, int month, int day);
+double indian_to_jd(int year, int month, int day);
+double armenian_to_jd(int year, int month, int day);
+double badi_to_jd(int year, int month, int day);
 
 void jd_to_persian(double jd, int *year, int *month, int *day);
 void jd_to_gregorian(double jd, int *year, int *month, int *day);
@@ -141,6 +472,13 @@ void jd_to_islamic(double jd, int *year, int *month, int *day);
 void jd_to_hebrew(double jd, int *year, int *month, int *day);
 void jd_to_julian(double jd, int *year, int *month, int *day);
 void jd_to_persianb(double jd, int *year, int *month, int *day);
+void jd_to_afghan(double jd, int *year, int *month, int *day);
+void jd_to_ummalqura(double jd, int *year, int *month, int *day);
+void jd_to_coptic(double jd, int *year, int *month, int *day);
+void jd_to_ethiopian(double jd, int *year, int *month, int *day);
+void jd_to_indian(double jd, int *year, int *month, int *day);
+void jd_to_armenian(double jd, int *year, int *month, int *day);
+void jd_to_badi(double jd, int *year, int *month, int *day);
 
 int *jd_to_persian_arr(double jd, int result_ymd[]);
 int *jd_to_gregorian_arr(double jd, int result_ymd[]);
@@ -148,6 +486,12 @@ int *jd_to_islamic_arr(double jd, int result_ymd[]);
 int *jd_to_hebrew_arr(double jd, int result_ymd[]);
 int *jd_to_julian_arr(double jd, int result_ymd[]);
 int *jd_to_persianb_arr(double jd, int result_ymd[]);
+int *jd_to_afghan_arr(double jd, int result_ymd[]);
+int *jd_to_ummalqura_arr(double jd, int result_ymd[]);
+
+#if defined(__GNUC__) && !defined(_WIN32)
+#pragma GCC visibility pop
+#endif
 
 #ifdef __cplusplus
 }
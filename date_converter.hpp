@@ -0,0 +1,259 @@
+/*
+                     Fourmilab Calendar Converter:
+                  by John Walker  --  September, MMXV
+              http://www.fourmilab.ch/documents/calendar/
+                  (Originally written in JavaScript)
+
+                            Converted to C:
+                by Aboutaleb Roshan  --  August, MMXVII
+                   22 Mordad, 1396 (13 August, 2017)
+               https://www.rosybit.com/products/dateconv/
+                         ab.roshan39@gmail.com
+
+                 This library is in the public domain.
+*/
+
+/* C++20 date types of the library's calendars that convert implicitly
+   to and from std::chrono::sys_days:
+
+       dc::persian_ymd nowruz = std::chrono::sys_days{std::chrono::March / 20 / 2024};
+       std::chrono::sys_days fast = dc::islamic_ymd{1445, 9, 1};
+
+   The Julian, Islamic and Birashk Persian conversions are the
+   library's integer day-number code, inline and constexpr, for years
+   within +-500000.  The astronomical and Hebrew calendars call the
+   library.  Months and days are numbered as in the C API. */
+
+#ifndef DATE_CONVERTER_HPP
+#define DATE_CONVERTER_HPP
+
+#include <chrono>
+#include "date_converter.h"
+
+namespace dc
+{
+
+namespace detail
+{
+
+constexpr int unix_epoch_jdn = 2440588;  // Julian day number of 1970-01-01, day 0 of sys_days
+
+// Integer division and remainder rounding toward minus infinity (b > 0)
+
+constexpr int floor_div(int a, int b)
+{
+    return (a >= 0) ? a / b : -((b - 1 - a) / b);
+}
+
+constexpr int floor_mod(int a, int b)
+{
+    return a - b * floor_div(a, b);
+}
+
+constexpr int ceil_div(int a, int b)
+{
+    return -floor_div(-a, b);
+}
+
+/* CALENDAR_TRAITS  --  Julian day number of a date and back, and the
+                        lowest month number.  The calendars without an
+                        integer path go through the library's Julian
+                        days, whose day is floor(jd) + 1, and read
+                        min_month from the registry. */
+
+template<dc_calendar_t C>
+struct calendar_traits
+{
+    static int to_jdn(int year, int month, int day)
+    {
+        return (int)(ymd_to_jd(year, month, day, C) + 0.5);
+    }
+
+    static void from_jdn(int jdn, int &year, int &month, int &day)
+    {
+        jd_to_ymd(jdn - 0.5, C, &year, &month, &day);
+    }
+
+    static int min_month()
+    {
+        const dc_calendar_ops_t *ops = dc_calendar_ops(C);
+        return ops ? ops->min_month : 1;
+    }
+};
+
+// The integer paths of date_converter.c: julian_to_jdn(), jdn_to_julian() and so on
+
+template<>
+struct calendar_traits<DC_JUL>
+{
+    static constexpr int min_month() { return 1; }
+
+    static constexpr int to_jdn(int year, int month, int day)
+    {
+        if(year < 1)
+            year++;
+
+        if(month <= 2)
+        {
+            year--;
+            month += 12;
+        }
+
+        return floor_div(1461 * (year + 4716), 4) + floor_div(306001 * (month + 1), 10000) + day - 1524;
+    }
+
+    static constexpr void from_jdn(int jdn, int &year, int &month, int &day)
+    {
+        long long x;
+        int b, c, d, e, m, y;
+
+        b = jdn + 1524;
+        x = (100LL * b) - 12210;
+        c = (int)((x >= 0) ? x / 36525 : -((36524 - x) / 36525));
+        d = floor_div(1461 * c, 4);
+        e = floor_div(10000 * (b - d), 306001);
+
+        m = (e < 14) ? (e - 1) : (e - 13);
+        y = (m > 2) ? (c - 4716) : (c - 4715);
+
+        year = (y < 1) ? y - 1 : y;
+        month = m;
+        day = b - d - floor_div(306001 * e, 10000);
+    }
+};
+
+template<>
+struct calendar_traits<DC_ISM>
+{
+    static constexpr int min_month() { return 1; }
+
+    static constexpr int to_jdn(int year, int month, int day)
+    {
+        return day + ceil_div(59 * (month - 1), 2) + (year - 1) * 354 + floor_div(3 + (11 * year), 30) + 1948439;
+    }
+
+    static constexpr void from_jdn(int jdn, int &year, int &month, int &day)
+    {
+        long long x = 30LL * (jdn - 1948440) + 10646;
+        int y, m, start;
+
+        y = (int)((x >= 0) ? x / 10631 : -((10630 - x) / 10631));
+        start = to_jdn(y, 1, 1);
+        m = ceil_div(2 * (jdn - 29 - start), 59) + 1;
+        m = (m < 12) ? m : 12;
+
+        year = y;
+        month = m;
+        day = jdn - (start + ceil_div(59 * (m - 1), 2)) + 1;
+    }
+};
+
+template<>
+struct calendar_traits<DC_PER_B>
+{
+    static constexpr int min_month() { return 1; }
+
+    static constexpr int to_jdn(int year, int month, int day)
+    {
+        int epbase = year - ((year >= 0) ? 474 : 473);
+        int epyear = 474 + floor_mod(epbase, 2820);
+
+        return day + ((month <= 7) ? ((month - 1) * 31) : (((month - 1) * 30) + 6)) +
+               floor_div((epyear * 682) - 110, 2816) + (epyear - 1) * 365 + floor_div(epbase, 2820) * 1029983 + 1948320;
+    }
+
+    static constexpr void from_jdn(int jdn, int &year, int &month, int &day)
+    {
+        int depoch, cycle, cyear, ycycle, aux1, aux2, y, m, yday;
+
+        depoch = jdn - to_jdn(475, 1, 1);
+        cycle = floor_div(depoch, 1029983);
+        cyear = depoch - (cycle * 1029983);
+        if(cyear == 1029982)
+        {
+            ycycle = 2820;
+        }
+        else
+        {
+            aux1 = cyear / 366;
+            aux2 = cyear % 366;
+            ycycle = (((2134 * aux1) + (2816 * aux2) + 2815) / 1028522) + aux1 + 1;
+        }
+
+        y = ycycle + (2820 * cycle) + 474;
+        if(y <= 0)
+            y--;
+
+        yday = (jdn - to_jdn(y, 1, 1)) + 1;
+        m = (yday <= 186) ? ceil_div(yday, 31) : ceil_div(yday - 6, 30);
+
+        year = y;
+        month = m;
+        day = yday - ((m <= 7) ? ((m - 1) * 31) : (((m - 1) * 30) + 6));
+    }
+};
+
+}  // namespace detail
+
+// CALENDAR_YMD: A date of calendar C, convertible to and from std::chrono::sys_days
+
+template<dc_calendar_t C>
+class calendar_ymd
+{
+    using traits = detail::calendar_traits<C>;
+
+public:
+    static constexpr dc_calendar_t calendar = C;
+
+    calendar_ymd() = default;
+
+    constexpr calendar_ymd(int year, int month, int day) noexcept : y(year), m(month), d(day) {}
+
+    constexpr calendar_ymd(std::chrono::sys_days days) noexcept : y(), m(), d()
+    {
+        traits::from_jdn((int)days.time_since_epoch().count() + detail::unix_epoch_jdn, y, m, d);
+    }
+
+    constexpr operator std::chrono::sys_days() const noexcept
+    {
+        return std::chrono::sys_days{std::chrono::days{jdn() - detail::unix_epoch_jdn}};
+    }
+
+    // Julian day number, the Julian day of the date + 0.5
+    constexpr int jdn() const noexcept
+    {
+        return traits::to_jdn(y, m, d);
+    }
+
+    constexpr int year() const noexcept { return y; }
+    constexpr int month() const noexcept { return m; }
+    constexpr int day() const noexcept { return d; }
+
+    // Is the date valid: does it come back unchanged from its day number? (Badi' month 0: Ayyam-i-Ha)
+    constexpr bool ok() const noexcept
+    {
+        return m >= traits::min_month() && d >= 1 && calendar_ymd(std::chrono::sys_days(*this)) == *this;
+    }
+
+    friend constexpr bool operator==(const calendar_ymd &a, const calendar_ymd &b) noexcept = default;
+
+private:
+    int y, m, d;
+};
+
+using persian_ymd = calendar_ymd<DC_PER>;
+using islamic_ymd = calendar_ymd<DC_ISM>;
+using hebrew_ymd = calendar_ymd<DC_HEB>;
+using julian_ymd = calendar_ymd<DC_JUL>;
+using persian_b_ymd = calendar_ymd<DC_PER_B>;
+using afghan_ymd = calendar_ymd<DC_PER_AF>;
+using ummalqura_ymd = calendar_ymd<DC_ISM_UQ>;
+using coptic_ymd = calendar_ymd<DC_COP>;
+using ethiopian_ymd = calendar_ymd<DC_ETH>;
+using indian_ymd = calendar_ymd<DC_IND>;
+using armenian_ymd = calendar_ymd<DC_ARM>;
+using badi_ymd = calendar_ymd<DC_BAH>;
+
+}  // namespace dc
+
+#endif  // DATE_CONVERTER_HPP
@@ -0,0 +1,195 @@
+/*
+                     Fourmilab Calendar Converter:
+                  by John Walker  --  September, MMXV
+              http://www.fourmilab.ch/documents/calendar/
+                  (Originally written in JavaScript)
+
+                            Converted to C:
+                by Aboutaleb Roshan  --  August, MMXVII
+                   22 Mordad, 1396 (13 August, 2017)
+               https://www.rosybit.com/products/dateconv/
+                         ab.roshan39@gmail.com
+
+                 This library is in the public domain.
+*/
+
+/* The cheap functions of the library -- leap year rules, month lengths
+   and the arithmetic calendars' Julian days -- as static inline
+   definitions the compiler can fold into a caller's loop instead of a
+   call through the PLT.  Include this header instead of, not after,
+   date_converter.h; everything else still comes from the library.
+   date_converter.c compiles the same definitions with external
+   linkage (DC_FAST defined empty), so the two never disagree. */
+
+#ifndef DATE_CONVERTER_INLINE_H
+#define DATE_CONVERTER_INLINE_H
+
+#ifndef DC_FAST
+#if defined(DATE_CONVERTER_H) && !defined(DC_INLINE_FAST_PATHS)
+#error "Include date_converter_inline.h instead of date_converter.h, not after it"
+#endif
+#define DC_INLINE_FAST_PATHS
+#define DC_FAST static inline
+#endif  // DC_FAST
+
+#include <math.h>
+#include "date_converter.h"
+
+// LEAP_GREGORIAN: Is a given year in the Gregorian calendar a leap year?
+
+DC_FAST int leap_gregorian(int year)
+{
+    // return ((year % 4) == 0) && (!(((year % 100) == 0) && ((year % 400) != 0)));
+    return (year % 400 == 0) || ((year % 4 == 0) && (year % 100 != 0));
+}
+
+#ifndef DC_EMBEDDED  // Integer versions in date_converter.c
+
+// GREGORIAN_TO_JD:‌ Determine Julian day number from Gregorian calendar date
+
+DC_FAST double gregorian_to_jd(int year, int month, int day)
+{
+    return (1721425.5 - 1) + (365 * (year - 1)) + floor((year - 1) / (double)4) +
+           (-floor((year - 1) / (double)100)) + floor((year - 1) / (double)400) +
+           floor((((367 * month) - 362) / (double)12) +
+           ((month <= 2) ? 0 : (leap_gregorian(year) ? -1 : -2)) + day);
+}
+
+#endif
+
+DC_FAST int gregorian_month_days(int year, int month)
+{
+    switch(month)
+    {
+        case 1:
+        case 3:
+        case 5:
+        case 7:
+        case 8:
+        case 10:
+        case 12:
+            return 31;
+        case 4:
+        case 6:
+        case 9:
+        case 11:
+            return 30;
+        case 2:
+            break;
+        default:
+            return -1;  // ERROR: The month must be between 1-12
+    }
+
+    return leap_gregorian(year) ? 29 : 28;
+}
+
+// LEAP_ISLAMIC: Is a given year a leap year in the Islamic calendar?
+
+DC_FAST int leap_islamic(int year)
+{
+    // return (((year * 11) + 14) % 30) < 11;  // Negative years -> ERROR
+    return ((((year * 11) + 14) % 30 + 30) % 30) < 11;
+}
+
+#ifndef DC_EMBEDDED  // Integer versions in date_converter.c
+
+// ISLAMIC_TO_JD: Determine Julian day from Islamic date
+
+DC_FAST double islamic_to_jd(int year, int month, int day)
+{
+    return (day + ceil(29.5 * (month - 1)) + (year - 1) * 354 + floor((3 + (11 * year)) / (double)30) + 1948439.5) - 1;
+}
+
+#endif
+
+DC_FAST int islamic_month_days(int year, int month)
+{
+    if(month < 1 || month > 12)
+        return -1;  // ERROR: The month must be between 1-12
+
+    // Odd months have 30 days, even months 29, and Dhu al-Hijjah 30 in a leap year
+    return ((month & 1) || (month == 12 && leap_islamic(year))) ? 30 : 29;
+}
+
+// Is a given Hebrew year a leap year?
+
+DC_FAST int leap_hebrew(int year)
+{
+    return ((((year * 7) + 1) % 19 + 19) % 19) < 7;
+}
+
+// How many months are there in a Hebrew year (12 = normal, 13 = leap)
+
+DC_FAST int hebrew_year_months(int year)
+{
+    return leap_hebrew(year) ? 13 : 12;
+}
+
+DC_FAST int leap_julian(int year)
+{
+    return ((year % 4 + 4) % 4) == ((year > 0) ? 0 : 3);
+}
+
+#ifndef DC_EMBEDDED  // Integer versions in date_converter.c
+
+// JULIAN_TO_JD: Determine Julian day number from Julian calendar date
+
+DC_FAST double julian_to_jd(int year, int month, int day)
+{
+    // Adjust negative common era years to the zero-based notation we use.
+
+    if(year < 1)
+        year++;
+
+    // Algorithm as given in Meeus, Astronomical Algorithms, Chapter 7, page 61
+
+    if(month <= 2)
+    {
+        year--;
+        month += 12;
+    }
+
+    return ((floor((365.25 * (year + 4716))) + floor((30.6001 * (month + 1))) + day) - 1524.5);
+}
+
+#endif
+
+DC_FAST int julian_month_days(int year, int month)
+{
+    switch(month)
+    {
+        case 1:
+        case 3:
+        case 5:
+        case 7:
+        case 8:
+        case 10:
+        case 12:
+            return 31;
+        case 4:
+        case 6:
+        case 9:
+        case 11:
+            return 30;
+        case 2:
+            break;
+        default:
+            return -1;  // ERROR: The month must be between 1-12
+    }
+
+    return leap_julian(year) ? 29 : 28;
+}
+
+#ifndef DC_EMBEDDED  // Integer versions in date_converter.c
+
+// WEEKDAY_JD: Day of the week (0 = Sunday) of a Julian day
+
+DC_FAST int weekday_jd(double jd)
+{
+    double days = floor(jd + 1.5);
+    return (int)(days - (7 * floor(days / 7)));
+}
+
+#endif
+
+#endif  // DATE_CONVERTER_INLINE_H
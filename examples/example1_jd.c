@@ -47,6 +47,8 @@ int main()
         case DC_HEB: jd = hebrew_to_jd(year, month, day); break;
         case DC_JUL: jd = julian_to_jd(year, month, day); break;
         case DC_PER_B: jd = persianb_to_jd(year, month, day); break;
+        case DC_PER_AF: jd = afghan_to_jd(year, month, day); break;
+        case DC_ISM_UQ: jd = ummalqura_to_jd(year, month, day); break;
         default: jd = gregorian_to_jd(year, month, day); break;
     }
 
@@ -67,6 +69,11 @@ int main()
     month_name = islamic_month_name(m);
     printf("Islamic Date:\t\t\t%d/%02d/%02d\t%s\t%s\n", y, m, d, no_le_year, month_name);
 
+    jd_to_ummalqura(jd, &y, &m, &d);
+    no_le_year = norm_leap_str(leap_ummalqura(y));
+    month_name = ummalqura_month_name(m);
+    printf("Islamic (Umm al-Qura) Date:\t%d/%02d/%02d\t%s\t%s\n", y, m, d, no_le_year, month_name);
+
     jd_to_hebrew(jd, &y, &m, &d);
     no_le_year = norm_leap_str(leap_hebrew(y));
     month_name = hebrew_month_name(y, m);
@@ -82,6 +89,11 @@ int main()
     month_name = persianb_month_name(m);
     printf("Persian (Birashk) Date:\t\t%d/%02d/%02d\t%s\t%s\n", y, m, d, no_le_year, month_name);
 
+    jd_to_afghan(jd, &y, &m, &d);
+    no_le_year = norm_leap_str(leap_afghan(y));
+    month_name = afghan_month_name(m);
+    printf("Afghan (Solar Hijri) Date:\t%d/%02d/%02d\t%s\t%s\n", y, m, d, no_le_year, month_name);
+
     printf("Weekday:\t\t\t%s\n\n", weekday);
 
 out:
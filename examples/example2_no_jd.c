@@ -56,6 +56,12 @@ int main()
     month_name = islamic_month_name(m);
     printf("Islamic Date:\t\t\t%d/%02d/%02d\t%s\t%s\n", y, m, d, no_le_year, month_name);
 
+    y = year; m = month; d = day;
+    gregorian_to_ummalqura(&y, &m, &d);
+    no_le_year = norm_leap_str(leap_ummalqura(y));
+    month_name = ummalqura_month_name(m);
+    printf("Islamic (Umm al-Qura) Date:\t%d/%02d/%02d\t%s\t%s\n", y, m, d, no_le_year, month_name);
+
     y = year; m = month; d = day;
     gregorian_to_hebrew(&y, &m, &d);
     no_le_year = norm_leap_str(leap_hebrew(y));
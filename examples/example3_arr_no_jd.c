@@ -54,6 +54,11 @@ int main()
     month_name = islamic_month_name(ymd[1]);
     printf("Islamic Date:\t\t\t%d/%02d/%02d\t%s\t%s\n", ymd[0], ymd[1], ymd[2], no_le_year, month_name);
 
+    gregorian_to_ummalqura_arr(year, month, day, ymd);
+    no_le_year = norm_leap_str(leap_ummalqura(ymd[0]));
+    month_name = ummalqura_month_name(ymd[1]);
+    printf("Islamic (Umm al-Qura) Date:\t%d/%02d/%02d\t%s\t%s\n", ymd[0], ymd[1], ymd[2], no_le_year, month_name);
+
     gregorian_to_hebrew_arr(year, month, day, ymd);
     no_le_year = norm_leap_str(leap_hebrew(ymd[0]));
     month_name = hebrew_month_name(ymd[0], ymd[1]);
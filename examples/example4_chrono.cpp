@@ -0,0 +1,50 @@
+/*
+                     Fourmilab Calendar Converter:
+                  by John Walker  --  September, MMXV
+              http://www.fourmilab.ch/documents/calendar/
+                  (Originally written in JavaScript)
+
+                            Converted to C:
+                by Aboutaleb Roshan  --  August, MMXVII
+                   22 Mordad, 1396 (13 August, 2017)
+               https://www.rosybit.com/products/dateconv/
+                         ab.roshan39@gmail.com
+
+                 This library is in the public domain.
+*/
+
+// g++ -std=c++20 example4_chrono.cpp -ldateconv -lm
+
+#include <chrono>
+#include <cstdio>
+#include <date_converter.hpp>
+
+using namespace std::chrono;
+
+// The arithmetic calendars convert at compile time
+static_assert(dc::islamic_ymd(sys_days{2024y / March / 11}) == dc::islamic_ymd{1445, 9, 1});
+static_assert(sys_days(dc::julian_ymd{2024, 4, 19}) == sys_days{2024y / May / 2});
+static_assert(dc::persian_b_ymd(sys_days{2024y / March / 20}) == dc::persian_b_ymd{1403, 1, 1});
+static_assert(!dc::persian_b_ymd{1403, 12, 30}.ok());
+
+int main()
+{
+    sys_days today = 2024y / May / 2;
+
+    dc::persian_ymd persian = today;
+    dc::hebrew_ymd hebrew = today;
+    dc::islamic_ymd islamic = today;
+
+    std::printf("Persian: %d/%02d/%02d\n", persian.year(), persian.month(), persian.day());
+    std::printf("Hebrew:  %d/%02d/%02d\n", hebrew.year(), hebrew.month(), hebrew.day());
+    std::printf("Islamic: %d/%02d/%02d\n", islamic.year(), islamic.month(), islamic.day());
+
+    // Back to the standard calendar: days between Nowruz and today
+    sys_days nowruz = dc::persian_ymd{persian.year(), 1, 1};
+    std::printf("Day %d of the Persian year, a %s\n", (int)(today - nowruz).count() + 1,
+                weekday_str(weekday{today}.c_encoding()));
+
+    year_month_day ymd = sys_days(dc::hebrew_ymd{5784, 7, 1});
+    std::printf("Rosh Hashanah 5784: %d-%02u-%02u\n", (int)ymd.year(), (unsigned)ymd.month(), (unsigned)ymd.day());
+    return 0;
+}
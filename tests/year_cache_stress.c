@@ -0,0 +1,108 @@
+/*
+    Stress test of the shared year cache.
+
+    Many threads look up the Hebrew new years and the Tehran and Kabul
+    equinox days of random years, drawn from far more keys than the
+    cache holds, so that fills race with each other and with the
+    evictions.  Every result is checked against a reference computed
+    without the cache before the threads start.
+
+    Build and run with:  make stress  [STRESS_THREADS=n]
+*/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <date_converter.h>
+
+// Internal functions of the library, computed without the cache
+int hebrew_delay_1(int year);
+int hebrew_delay_2(int year);
+double equinox_day(int year, double meridian);
+
+#define HEBREW_FIRST   1
+#define HEBREW_YEARS   6000
+#define EQUINOX_FIRST  -1000  // Gregorian years before the contexts' own window (1000-3047)
+#define EQUINOX_YEARS  1000
+#define LOOKUPS        10000
+
+static int hebrew_days[HEBREW_YEARS];
+static double tehran_eq[EQUINOX_YEARS], kabul_eq[EQUINOX_YEARS];
+
+typedef struct Worker
+{
+    pthread_t thread;
+    unsigned seed;
+    long errors;
+} worker_t;
+
+static void *run(void *arg)
+{
+    worker_t *w = (worker_t *)arg;
+    int i, year;
+
+    for(i = 0; i < LOOKUPS; i++)
+    {
+        switch(rand_r(&w->seed) % 3)
+        {
+            case 0:
+                year = HEBREW_FIRST + rand_r(&w->seed) % HEBREW_YEARS;
+                if(hebrew_year_days(year) != hebrew_days[year - HEBREW_FIRST])
+                    w->errors++;
+                break;
+            case 1:
+                year = EQUINOX_FIRST + rand_r(&w->seed) % EQUINOX_YEARS;
+                if(persian_to_jd(year - 621, 1, 1) != tehran_eq[year - EQUINOX_FIRST])
+                    w->errors++;
+                break;
+            default:
+                year = EQUINOX_FIRST + rand_r(&w->seed) % EQUINOX_YEARS;
+                if(afghan_to_jd(year - 621, 1, 1) != kabul_eq[year - EQUINOX_FIRST])
+                    w->errors++;
+                break;
+        }
+    }
+
+    return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+    int threads = (argc > 1) ? atoi(argv[1]) : 64;
+    worker_t *workers;
+    long errors = 0;
+    int i;
+
+    if(threads < 1)
+    {
+        fprintf(stderr, "Usage: %s [threads]\n", argv[0]);
+        return 2;
+    }
+
+    for(i = 0; i < HEBREW_YEARS; i++)
+        hebrew_days[i] = (hebrew_delay_1(HEBREW_FIRST + i + 1) + hebrew_delay_2(HEBREW_FIRST + i + 1)) -
+                         (hebrew_delay_1(HEBREW_FIRST + i) + hebrew_delay_2(HEBREW_FIRST + i));
+
+    // 1 Farvardin of a year starts with the equinox day of the Gregorian year 621 later
+    for(i = 0; i < EQUINOX_YEARS; i++)
+    {
+        tehran_eq[i] = equinox_day(EQUINOX_FIRST + i, 52.5) + 0.5;
+        kabul_eq[i] = equinox_day(EQUINOX_FIRST + i, 67.5) + 0.5;
+    }
+
+    workers = (worker_t *)calloc(threads, sizeof(worker_t));
+    for(i = 0; i < threads; i++)
+    {
+        workers[i].seed = 1234u + i;
+        pthread_create(&workers[i].thread, NULL, run, &workers[i]);
+    }
+    for(i = 0; i < threads; i++)
+    {
+        pthread_join(workers[i].thread, NULL);
+        errors += workers[i].errors;
+    }
+
+    printf("%d threads, %ld lookups, %ld wrong\n", threads, (long)threads * LOOKUPS, errors);
+    free(workers);
+    return errors != 0;
+}
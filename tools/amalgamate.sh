@@ -0,0 +1,40 @@
+#!/bin/sh
+#
+#   Generate the single-header amalgamation date_converter_all.h
+#
+#   The fast paths of date_converter_inline.h come first with the
+#   public header spliced in, so every includer gets them static
+#   inline; the implementation follows under DATE_CONVERTER_IMPLEMENTATION.
+#   In exactly one translation unit:
+#
+#       #define DATE_CONVERTER_IMPLEMENTATION
+#       #include "date_converter_all.h"
+#
+#   Usage: tools/amalgamate.sh [output]   (run from the top directory)
+
+set -e
+
+out=${1:-date_converter_all.h}
+tmp=$out.tmp
+
+{
+    echo "/* date_converter_all.h -- generated by tools/amalgamate.sh, do not edit */"
+    echo
+    sed -e '/^#include "date_converter.h"$/{
+r date_converter.h
+d
+}' date_converter_inline.h
+    echo
+    echo "#ifdef DATE_CONVERTER_IMPLEMENTATION"
+    echo "#ifndef DATE_CONVERTER_IMPLEMENTATION_DONE"
+    echo "#define DATE_CONVERTER_IMPLEMENTATION_DONE"
+    echo
+    sed -e '/^\/\/ The fast paths of date_converter_inline.h are defined here/d' \
+        -e '/^#define DC_FAST$/d' \
+        -e '/^#include "date_converter_inline.h"$/d' date_converter.c
+    echo
+    echo "#endif  // DATE_CONVERTER_IMPLEMENTATION_DONE"
+    echo "#endif  // DATE_CONVERTER_IMPLEMENTATION"
+} > "$tmp"
+
+mv "$tmp" "$out"
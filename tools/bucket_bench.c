@@ -0,0 +1,109 @@
+/*
+    Benchmark of grouping day numbers by month of a calendar.
+
+    Places a column of Julian day numbers, once in random order and
+    once sorted, in the Persian months of 1300-1499 and the Hebrew
+    years of 5650-5849: converting each row with jd_to_ymd(), with
+    dc_date32_to_month_key(), and with dc_bucket_assign() and
+    dc_bucket_aggregate().  Reports the time per row.
+
+    Build and run with:  make bench
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <date_converter.h>
+
+#define ROWS 4000000
+
+static double seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int cmp_int32(const void *a, const void *b)
+{
+    int32_t x = *(const int32_t *)a, y = *(const int32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void run(const char *name, dc_calendar_t calendar_type, dc_period_t period, int first_year, int last_year)
+{
+    dc_buckets_t buckets;
+    dc_bucket_agg_t *agg;
+    int32_t *jdn, *date32, *id;
+    double *value, t0;
+    long sum = 0;
+    int i, pass, y, m, d;
+
+    if(dc_buckets_build(calendar_type, period, first_year, last_year, &buckets))
+        return;
+
+    jdn = (int32_t *)malloc(ROWS * sizeof(int32_t));
+    date32 = (int32_t *)malloc(ROWS * sizeof(int32_t));
+    id = (int32_t *)malloc(ROWS * sizeof(int32_t));
+    value = (double *)malloc(ROWS * sizeof(double));
+    agg = (dc_bucket_agg_t *)calloc(buckets.count, sizeof(dc_bucket_agg_t));
+
+    srand(1);
+    for(i = 0; i < ROWS; i++)
+    {
+        jdn[i] = buckets.start[0] + rand() % (buckets.start[buckets.count] - buckets.start[0]);
+        value[i] = rand() % 1000;
+    }
+
+    printf("%s, %d periods\n", name, buckets.count);
+    for(pass = 0; pass < 2; pass++)
+    {
+        if(pass)
+            qsort(jdn, ROWS, sizeof(int32_t), cmp_int32);
+        printf("  %s\n", pass ? "sorted" : "random order");
+        for(i = 0; i < ROWS; i++)
+            date32[i] = jdn[i] - 2440588;
+
+        if(calendar_type != DC_HEB || !pass)
+        {
+            t0 = seconds();
+            for(i = 0; i < ROWS; i++)
+            {
+                jd_to_ymd(jdn[i] - 0.5, calendar_type, &y, &m, &d);
+                sum += y + m;
+            }
+            printf("    jd_to_ymd               %7.2f ns/row\n", (seconds() - t0) * 1e9 / ROWS);
+        }
+
+        t0 = seconds();
+        dc_date32_to_month_key(date32, NULL, 0, ROWS, calendar_type, id, NULL);
+        printf("    dc_date32_to_month_key  %7.2f ns/row\n", (seconds() - t0) * 1e9 / ROWS);
+
+        t0 = seconds();
+        dc_bucket_assign(&buckets, jdn, ROWS, id);
+        printf("    dc_bucket_assign        %7.2f ns/row\n", (seconds() - t0) * 1e9 / ROWS);
+
+        t0 = seconds();
+        dc_bucket_aggregate(&buckets, jdn, value, ROWS, NULL, agg);
+        printf("    dc_bucket_aggregate     %7.2f ns/row\n", (seconds() - t0) * 1e9 / ROWS);
+    }
+
+    // Keep the results alive
+    printf("  (checksum %ld %d %.0f)\n", sum, id[ROWS / 2], agg[0].sum);
+
+    free(jdn);
+    free(date32);
+    free(id);
+    free(value);
+    free(agg);
+    dc_buckets_free(&buckets);
+}
+
+int main()
+{
+    run("Persian months 1300-1499", DC_PER, DC_PERIOD_MONTH, 1300, 1499);
+    run("Hebrew years 5650-5849", DC_HEB, DC_PERIOD_YEAR, 5650, 5849);
+    return 0;
+}
@@ -0,0 +1,79 @@
+/*
+    Call-overhead benchmark of the cheap functions.
+
+    Runs the same loops of leap_gregorian(), gregorian_month_days(),
+    gregorian_to_jd() and weekday_jd() once built against the shared
+    library, where every call goes through the PLT, and once with
+    -DUSE_INLINE through date_converter_inline.h, where the compiler
+    can inline and vectorize them.
+
+    Build and run with:  make bench
+*/
+
+#include <stdio.h>
+#include <time.h>
+
+#ifdef USE_INLINE
+#include <date_converter_inline.h>
+#define VARIANT "inline"
+#else
+#include <date_converter.h>
+#define VARIANT "shared library (PLT)"
+#endif
+
+#define ROUNDS 200
+
+static double seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main()
+{
+    const int first = 1, last = 10000;
+    double t0, t, sum = 0;
+    long calls, n = 0;
+    int r, year, month;
+
+    printf("%s\n", VARIANT);
+
+    t0 = seconds();
+    for(r = 0; r < ROUNDS; r++)
+        for(year = first + r; year <= last + r; year++)
+            n += leap_gregorian(year);
+    t = seconds() - t0;
+    calls = (long)ROUNDS * (last - first + 1);
+    printf("  leap_gregorian        %6.2f ns/call\n", t * 1e9 / calls);
+
+    t0 = seconds();
+    for(r = 0; r < ROUNDS; r++)
+        for(year = first + r; year <= last + r; year++)
+            for(month = 1; month <= 12; month++)
+                n += gregorian_month_days(year, month);
+    t = seconds() - t0;
+    calls *= 12;
+    printf("  gregorian_month_days  %6.2f ns/call\n", t * 1e9 / calls);
+
+    t0 = seconds();
+    for(r = 0; r < ROUNDS; r++)
+        for(year = first + r; year <= last + r; year++)
+            for(month = 1; month <= 12; month++)
+                sum += gregorian_to_jd(year, month, 1);
+    t = seconds() - t0;
+    printf("  gregorian_to_jd       %6.2f ns/call\n", t * 1e9 / calls);
+
+    t0 = seconds();
+    for(r = 0; r < ROUNDS; r++)
+        for(year = first + r; year <= last + r; year++)
+            for(month = 0; month < 12; month++)
+                n += weekday_jd(2451544.5 + year * 12 + month);
+    t = seconds() - t0;
+    printf("  weekday_jd            %6.2f ns/call\n", t * 1e9 / calls);
+
+    // Keep the results alive
+    printf("  (checksum %ld %.1f)\n", n, sum);
+    return 0;
+}
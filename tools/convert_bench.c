@@ -0,0 +1,92 @@
+/*
+    Benchmark of the pairwise date conversions.
+
+    Converts the first of every month of a run of years with each of
+    the direct pairs (Gregorian <-> Julian, Islamic and Birashk's
+    Persian) and with dc_convert(), and reports the time per
+    conversion.
+
+    Build and run with:  make bench
+*/
+
+#include <stdio.h>
+#include <time.h>
+
+#include <date_converter.h>
+
+#define ROUNDS 20
+
+typedef struct Pair
+{
+    const char *name;
+    void (*convert)(int *, int *, int *);
+} pair_t;
+
+static const pair_t pairs[] =
+{
+    {"gregorian_to_julian   ", gregorian_to_julian},
+    {"julian_to_gregorian   ", julian_to_gregorian},
+    {"gregorian_to_islamic  ", gregorian_to_islamic},
+    {"islamic_to_gregorian  ", islamic_to_gregorian},
+    {"gregorian_to_persianb ", gregorian_to_persianb},
+    {"persianb_to_gregorian ", persianb_to_gregorian}
+};
+
+static double seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main()
+{
+    const int years = 10000;
+    double t0, t;
+    long calls = (long)ROUNDS * years * 12, sum = 0;
+    int i, r, y, m, year, month, day;
+
+    for(i = 0; i < (int)(sizeof(pairs) / sizeof(pairs[0])); i++)
+    {
+        t0 = seconds();
+        for(r = 0; r < ROUNDS; r++)
+        {
+            for(y = 1; y <= years; y++)
+            {
+                for(m = 1; m <= 12; m++)
+                {
+                    year = y;
+                    month = m;
+                    day = 1 + r;
+                    pairs[i].convert(&year, &month, &day);
+                    sum += year + month + day;
+                }
+            }
+        }
+        t = seconds() - t0;
+        printf("  %s %6.2f ns/call\n", pairs[i].name, t * 1e9 / calls);
+    }
+
+    t0 = seconds();
+    for(r = 0; r < ROUNDS; r++)
+    {
+        for(y = 1; y <= years; y++)
+        {
+            for(m = 1; m <= 12; m++)
+            {
+                year = y;
+                month = m;
+                day = 1 + r;
+                dc_convert(DC_GRE, DC_PER_B, &year, &month, &day);
+                sum += year + month + day;
+            }
+        }
+    }
+    t = seconds() - t0;
+    printf("  dc_convert (GRE, PER_B) %4.2f ns/call\n", t * 1e9 / calls);
+
+    // Keep the results alive
+    printf("  (checksum %ld)\n", sum);
+    return 0;
+}
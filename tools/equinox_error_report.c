@@ -0,0 +1,156 @@
+/*
+    Error-bound report for the reduced-precision equinox evaluation
+    and the ephemeris backends.
+
+    For every Gregorian year of the equinox cache window and for the
+    Tehran and Kabul meridians, compare meridian_equinox_reduced()
+    against the double meridian_equinox() and report the largest
+    difference, how many years fall back to the double evaluation,
+    and whether any equinox day would differ.  Then compare the short
+    Meeus series against the truncated VSOP87 solver: the largest
+    difference, how many years DC_EPHEM_AUTO refines, and how many
+    equinox days each mode would give differently from VSOP87.
+
+    Build and run with:  make equinox-report
+*/
+
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <date_converter.h>
+
+double meridian_equinox(int year, double meridian);
+double meridian_equinox_reduced(int year, double meridian);
+double equinox_day(int year, double meridian);
+double equinox(int year, int which);
+double equinox_vsop87(int year, int which);
+
+int main()
+{
+    static const double meridians[] = {52.5, 67.5};
+    static const char *names[] = {"Tehran (52.5 E)", "Kabul (67.5 E)"};
+
+    int first = DC_EQUINOX_CACHE_FIRST;
+    int last = DC_EQUINOX_CACHE_FIRST + DC_EQUINOX_CACHE_YEARS - 1;
+    int i, year, worst_year, closest_year, mismatches;
+    double full, reduced, err, max_err, sum_sq, margin, closest;
+    clock_t t0;
+    double t_full, t_reduced, sink = 0;
+
+    printf("Reduced-precision equinox error report, Gregorian years %d-%d\n\n", first, last);
+
+    for(i = 0; i < 2; i++)
+    {
+        max_err = sum_sq = 0;
+        worst_year = first;
+        for(year = first; year <= last; year++)
+        {
+            full = meridian_equinox(year, meridians[i]);
+            reduced = meridian_equinox_reduced(year, meridians[i]);
+            err = fabs(reduced - full);
+            sum_sq += err * err;
+            if(err > max_err)
+            {
+                max_err = err;
+                worst_year = year;
+            }
+        }
+
+        dc_set_astro_precision(DC_ASTRO_REDUCED);
+        mismatches = 0;
+        closest = 1;
+        closest_year = first;
+        for(year = first; year <= last; year++)
+        {
+            reduced = meridian_equinox_reduced(year, meridians[i]);
+            margin = fmin(reduced - floor(reduced), ceil(reduced) - reduced);
+            if(margin < closest)
+            {
+                closest = margin;
+                closest_year = year;
+            }
+            if(equinox_day(year, meridians[i]) != floor(meridian_equinox(year, meridians[i])))
+                mismatches++;
+        }
+        dc_set_astro_precision(DC_ASTRO_DOUBLE);
+
+        printf("%s\n", names[i]);
+        printf("    max |reduced - double|    %.3e days (%.3f s), year %d\n", max_err, max_err * 86400, worst_year);
+        printf("    rms |reduced - double|    %.3e days\n", sqrt(sum_sq / (last - first + 1)));
+        printf("    closest to a day boundary %.3e days, year %d\n", closest, closest_year);
+        printf("    equinox day mismatches    %d\n\n", mismatches);
+    }
+
+    t0 = clock();
+    for(year = first; year <= last; year++)
+        sink += meridian_equinox(year, meridians[0]);
+    t_full = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+    t0 = clock();
+    for(year = first; year <= last; year++)
+        sink += meridian_equinox_reduced(year, meridians[0]);
+    t_reduced = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+    printf("Time per equinox: double %.2f us, reduced %.2f us\n\n",
+           1e6 * t_full / (last - first + 1), 1e6 * t_reduced / (last - first + 1));
+
+    printf("Ephemeris backends, margin %.4f days (%.0f s)\n\n", DC_EPHEM_MARGIN, DC_EPHEM_MARGIN * 86400);
+
+    for(i = 0; i < 2; i++)
+    {
+        int refined = 0, meeus_days = 0, auto_days = 0;
+        double days[DC_EQUINOX_CACHE_YEARS];
+
+        dc_set_ephemeris(DC_EPHEM_VSOP87, 0);
+        max_err = 0;
+        worst_year = first;
+        for(year = first; year <= last; year++)
+        {
+            full = meridian_equinox(year, meridians[i]);
+            days[year - first] = floor(full);
+            err = fabs(equinox_vsop87(year, 0) - equinox(year, 0));
+            if(err > max_err)
+            {
+                max_err = err;
+                worst_year = year;
+            }
+        }
+
+        dc_set_ephemeris(DC_EPHEM_MEEUS, 0);
+        for(year = first; year <= last; year++)
+        {
+            full = meridian_equinox(year, meridians[i]);
+            margin = fmin(full - floor(full), ceil(full) - full);
+            refined += margin <= DC_EPHEM_MARGIN;
+            meeus_days += floor(full) != days[year - first];
+        }
+
+        dc_set_ephemeris(DC_EPHEM_AUTO, 0);
+        for(year = first; year <= last; year++)
+            auto_days += equinox_day(year, meridians[i]) != days[year - first];
+        dc_set_ephemeris(DC_EPHEM_MEEUS, 0);
+
+        printf("%s\n", names[i]);
+        printf("    max |Meeus - VSOP87|      %.3e days (%.1f s), year %d\n", max_err, max_err * 86400, worst_year);
+        printf("    years refined by AUTO     %d\n", refined);
+        printf("    days differing, Meeus     %d\n", meeus_days);
+        printf("    days differing, AUTO      %d\n\n", auto_days);
+    }
+
+    t0 = clock();
+    for(year = first; year <= last; year++)
+        sink += equinox_vsop87(year, 0);
+    t_full = (double)(clock() - t0) / CLOCKS_PER_SEC;
+
+    dc_set_ephemeris(DC_EPHEM_AUTO, 0);
+    t0 = clock();
+    for(year = first; year <= last; year++)
+        sink += meridian_equinox(year, meridians[0]);
+    t_reduced = (double)(clock() - t0) / CLOCKS_PER_SEC;
+    dc_set_ephemeris(DC_EPHEM_MEEUS, 0);
+
+    printf("Time per equinox: VSOP87 %.2f us, AUTO %.2f us (VSOP87 memoized)\n",
+           1e6 * t_full / (last - first + 1), 1e6 * t_reduced / (last - first + 1));
+
+    return sink == 0;
+}
@@ -0,0 +1,53 @@
+/*
+    Table of the astronomical Persian calendar for the embedded profile.
+
+    Runs the full library on the build host and writes, for the years
+    first to last, the Julian day number of 1 Farvardin of the first
+    year and one leap bit per year as date_converter_persian_table.h,
+    which date_converter.c includes when built with -DDC_EMBEDDED.
+
+    Usage: persian-table first last > date_converter_persian_table.h
+    Build and run with:  make embedded [PERSIAN_FIRST=n] [PERSIAN_LAST=n]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <date_converter.h>
+
+int main(int argc, char *argv[])
+{
+    int first, last, years, year, n, i;
+    unsigned char *bits;
+
+    if(argc != 3 || (first = atoi(argv[1])) < 1 || (last = atoi(argv[2])) < first || last - first >= 100000)
+    {
+        fprintf(stderr, "Usage: %s first last  (Persian years, 1 <= first <= last)\n", argv[0]);
+        return 2;
+    }
+
+    years = last - first + 1;
+    bits = (unsigned char *)calloc(years / 8 + 1, 1);
+    for(year = first; year <= last; year++)
+    {
+        n = year - first;
+        if(leap_persian(year))
+            bits[n >> 3] |= 1u << (n & 7);
+    }
+
+    printf("/* Generated by tools/persian_table.c -- do not edit.\n"
+           "   Astronomical Persian years %d to %d: bit (n & 7) of byte\n"
+           "   (n >> 3) is set when year %d + n is a leap year. */\n\n", first, last, first);
+    printf("#ifndef DATE_CONVERTER_PERSIAN_TABLE_H\n#define DATE_CONVERTER_PERSIAN_TABLE_H\n\n");
+    printf("#define DC_PERSIAN_TABLE_FIRST %d\n", first);
+    printf("#define DC_PERSIAN_TABLE_LAST  %d\n", last);
+    printf("#define DC_PERSIAN_TABLE_START %d  // Julian day number of 1 Farvardin %d\n\n",
+           (int)(persian_to_jd(first, 1, 1) + 0.5), first);
+
+    printf("static const unsigned char persian_table_leap[%d] =\n{", years / 8 + 1);
+    for(i = 0; i < years / 8 + 1; i++)
+        printf("%s0x%02x%s", (i % 12) ? " " : "\n    ", bits[i], (i < years / 8) ? "," : "");
+    printf("\n};\n\n#endif  // DATE_CONVERTER_PERSIAN_TABLE_H\n");
+
+    free(bits);
+    return 0;
+}
@@ -0,0 +1,71 @@
+#!/bin/sh
+#
+# Code and data size per calendar of an embedded build of the library,
+# summed from the symbol sizes nm reports, and a check that the build
+# needs neither libm nor the heap.
+#
+# Usage: size_report.sh object_file  (NM may name another nm)
+#
+
+NM=${NM:-nm}
+obj=$1
+
+if [ -z "$obj" ] || [ ! -f "$obj" ]; then
+    echo "Usage: $0 object_file" >&2
+    exit 2
+fi
+
+$NM -S -t d "$obj" | awk '
+    NF == 4 {
+        size = $2 + 0; type = toupper($3); name = $4
+        if(name ~ /^(persian|persianb|gregorian|islamic|julian)_to_(persian|persianb|gregorian|islamic|julian)(_arr)?$/ ||
+           name ~ /convert/)
+            cal = "conversions"
+        else if(name ~ /calendar|_any_year$|_jdn_jd$/)
+            cal = "registry"
+        else if(name ~ /persianb/)
+            cal = "persianb"
+        else if(name ~ /persian/)
+            cal = "persian (table)"
+        else if(name ~ /gregorian/)
+            cal = "gregorian"
+        else if(name ~ /islamic/)
+            cal = "islamic"
+        else if(name ~ /julian/)
+            cal = "julian"
+        else if(name ~ /coptic|ethiopian|alexandrian|COPTIC|ETHIOPIAN|^[ce]m_name/)
+            cal = "coptic, ethiopian"
+        else if(name ~ /indian|^nm_name/)
+            cal = "indian"
+        else if(name ~ /armenian|ARMENIAN|^am_name/)
+            cal = "armenian"
+        else
+            cal = "common"
+        if(type == "T")
+            code[cal] += size
+        else
+            data[cal] += size
+    }
+    END {
+        n = split("gregorian|julian|islamic|persianb|persian (table)|coptic, ethiopian|indian|armenian|conversions|registry|common", order, "|")
+        printf("%-17s %7s %7s\n", "", "code", "data")
+        for(i = 1; i <= n; i++)
+        {
+            printf("%-17s %7d %7d\n", order[i], code[order[i]], data[order[i]])
+            total_code += code[order[i]]
+            total_data += data[order[i]]
+        }
+        printf("%-17s %7d %7d\n", "total", total_code, total_data)
+    }'
+
+status=0
+for sym in $($NM -u "$obj" | awk '{ print $NF }'); do
+    echo "needs $sym"
+    case $sym in
+        malloc|calloc|realloc|free|floor|ceil|fabs|fmod|round|trunc|sqrt|pow|exp|log|sin|cos|tan|asin|acos|atan|atan2)
+            echo "error: $obj must not need $sym" >&2
+            status=1
+            ;;
+    esac
+done
+exit $status
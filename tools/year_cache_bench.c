@@ -0,0 +1,139 @@
+/*
+    Scaling benchmark of the shared year cache.
+
+    Runs 1 to 64 threads that each look up the lengths of random Hebrew
+    years from a working set the cache holds, and reports the total
+    lookups per second: through the library's lock-free cache, through
+    the same lookup guarded by one mutex, and computed without a cache.
+
+    Build and run with:  make bench
+*/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <date_converter.h>
+
+// Internal functions of the library, computed without the cache
+int hebrew_delay_1(int year);
+int hebrew_delay_2(int year);
+
+#define FIRST_YEAR  5000
+#define YEARS       1000     // Working set of the lookups
+#define LOOKUPS     2000000  // Per run, shared among the threads
+
+typedef enum {LOCK_FREE, MUTEX, UNCACHED} variant_t;
+
+static const char *variant_names[] = {"lock-free cache", "mutex cache", "no cache"};
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static int mutex_cache[YEARS + 1];  // 0 = not yet computed
+
+typedef struct Worker
+{
+    pthread_t thread;
+    variant_t variant;
+    unsigned seed;
+    int lookups;
+    long sum;
+} worker_t;
+
+static double seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int new_year(int year)
+{
+    return hebrew_delay_1(year) + hebrew_delay_2(year);
+}
+
+static int mutex_new_year(int year)
+{
+    int days;
+
+    pthread_mutex_lock(&lock);
+    if(!(days = mutex_cache[year - FIRST_YEAR]))
+        days = mutex_cache[year - FIRST_YEAR] = new_year(year);
+    pthread_mutex_unlock(&lock);
+    return days;
+}
+
+static void *run(void *arg)
+{
+    worker_t *w = (worker_t *)arg;
+    int i, year;
+
+    for(i = 0; i < w->lookups; i++)
+    {
+        year = FIRST_YEAR + rand_r(&w->seed) % YEARS;
+        switch(w->variant)
+        {
+            case LOCK_FREE:
+                w->sum += hebrew_year_days(year);
+                break;
+            case MUTEX:
+                w->sum += mutex_new_year(year + 1) - mutex_new_year(year);
+                break;
+            default:
+                w->sum += new_year(year + 1) - new_year(year);
+                break;
+        }
+    }
+
+    return NULL;
+}
+
+int main()
+{
+    static const int thread_counts[] = {1, 2, 4, 8, 16, 32, 64};
+    worker_t workers[64];
+    double t0, t;
+    long sum = 0;
+    int v, c, i, threads;
+
+    // Warm both caches
+    for(i = FIRST_YEAR; i <= FIRST_YEAR + YEARS; i++)
+        sum += hebrew_year_days(i) + mutex_new_year(i);
+
+    printf("Hebrew year lengths, million lookups per second\n");
+    printf("threads ");
+    for(v = LOCK_FREE; v <= UNCACHED; v++)
+        printf("  %16s", variant_names[v]);
+    printf("\n");
+
+    for(c = 0; c < (int)(sizeof(thread_counts) / sizeof(thread_counts[0])); c++)
+    {
+        threads = thread_counts[c];
+        printf("%7d ", threads);
+        for(v = LOCK_FREE; v <= UNCACHED; v++)
+        {
+            t0 = seconds();
+            for(i = 0; i < threads; i++)
+            {
+                workers[i].variant = (variant_t)v;
+                workers[i].seed = 1u + i;
+                workers[i].lookups = LOOKUPS / threads;
+                workers[i].sum = 0;
+                pthread_create(&workers[i].thread, NULL, run, &workers[i]);
+            }
+            for(i = 0; i < threads; i++)
+            {
+                pthread_join(workers[i].thread, NULL);
+                sum += workers[i].sum;
+            }
+            t = seconds() - t0;
+            printf("  %16.1f", (double)workers[0].lookups * threads / t * 1e-6);
+        }
+        printf("\n");
+    }
+
+    // Keep the results alive
+    printf("(checksum %ld)\n", sum);
+    return 0;
+}